@@ -39,6 +39,9 @@
 # DEPLOY_BASE
 # Optional. Target folder for "make deploy". Default is "../deploy" plus project name ($$TARGET_NAME).
 #
+# LITTLEXPC_TRACE
+# Optional. Set this to "true" to compile span tracing and a menu item to write a Chrome trace JSON file.
+#
 # ATOOLS_QUIET
 # Optional. Set this to "true" to avoid qmake messages.
 #
@@ -80,6 +83,7 @@ GIT_PATH=$$(ATOOLS_GIT_PATH)
 XPSDK_BASE=$$(XPSDK_BASE)
 DEPLOY_BASE=$$(DEPLOY_BASE)
 QUIET=$$(ATOOLS_QUIET)
+TRACE=$$(LITTLEXPC_TRACE)
 
 # =======================================================================
 # Fill defaults for unset
@@ -152,6 +156,8 @@ DEFINES += QT_NO_CAST_FROM_BYTEARRAY
 DEFINES += QT_NO_CAST_TO_ASCII
 DEFINES += XPLM302=1 XPLM301=1 XPLM300=1 XPLM210=1 XPLM200=1 APL=0 IBM=0 LIN=1
 
+isEqual(TRACE, "true") : DEFINES += LITTLEXPC_TRACE
+
 # Compiling the DLL but not using it
 DEFINES += LITTLEXPCONNECT_LIBRARY
 
@@ -184,6 +190,7 @@ message(ATOOLS_INC_PATH: $$ATOOLS_INC_PATH)
 message(ATOOLS_LIB_PATH: $$ATOOLS_LIB_PATH)
 message(ATOOLS_NO_QT5COMPAT: $$ATOOLS_NO_QT5COMPAT)
 message(DEPLOY_BASE: $$DEPLOY_BASE)
+message(LITTLEXPC_TRACE: $$TRACE)
 message(DEFINES: $$DEFINES)
 message(INCLUDEPATH: $$INCLUDEPATH)
 message(LIBS: $$LIBS)
@@ -204,8 +211,24 @@ message(-----------------------------------)
 SOURCES += \
   src/main.cpp \
   src/xpconnect/aircraftfileloader.cpp \
+  src/xpconnect/aitraffictable.cpp \
+  src/xpconnect/asynclog.cpp \
   src/xpconnect/dataref.cpp \
+  src/xpconnect/datarefcapture.cpp \
+  src/xpconnect/deadreckoning.cpp \
+  src/xpconnect/flightloopscheduler.cpp \
+  src/xpconnect/framegovernor.cpp \
+  src/xpconnect/localprojection.cpp \
+  src/xpconnect/metadatasegment.cpp \
+  src/xpconnect/perfcounters.cpp \
+  src/xpconnect/perfdatarefs.cpp \
   src/xpconnect/sharedmemorywriter.cpp \
+  src/xpconnect/stringpool.cpp \
+  src/xpconnect/tcasconversion.cpp \
+  src/xpconnect/tracer.cpp \
+  src/xpconnect/trafficfilter.cpp \
+  src/xpconnect/trafficgeometry.cpp \
+  src/xpconnect/userstream.cpp \
   src/xpconnect/xpconnect.cpp \
   src/xpconnect/xpdatarefs.cpp \
   src/xpconnect/xplog.cpp \
@@ -214,8 +237,24 @@ SOURCES += \
 HEADERS += \
   src/littlexpconnect_global.h \
   src/xpconnect/aircraftfileloader.h \
+  src/xpconnect/aitraffictable.h \
+  src/xpconnect/asynclog.h \
   src/xpconnect/dataref.h \
+  src/xpconnect/datarefcapture.h \
+  src/xpconnect/deadreckoning.h \
+  src/xpconnect/flightloopscheduler.h \
+  src/xpconnect/framegovernor.h \
+  src/xpconnect/localprojection.h \
+  src/xpconnect/metadatasegment.h \
+  src/xpconnect/perfcounters.h \
+  src/xpconnect/perfdatarefs.h \
   src/xpconnect/sharedmemorywriter.h \
+  src/xpconnect/stringpool.h \
+  src/xpconnect/tcasconversion.h \
+  src/xpconnect/tracer.h \
+  src/xpconnect/trafficfilter.h \
+  src/xpconnect/trafficgeometry.h \
+  src/xpconnect/userstream.h \
   src/xpconnect/xpconnect.h \
   src/xpconnect/xpdatarefs.h \
   src/xpconnect/xplog.h \
@@ -19,12 +19,17 @@
 #include "littlexpconnect_global.h"
 
 #include "gui/consoleapplication.h"
+#include "xpconnect/asynclog.h"
+#include "xpconnect/flightloopscheduler.h"
+#include "xpconnect/framegovernor.h"
 #include "xpconnect/xplog.h"
 #include "logging/logginghandler.h"
 #include "logging/loggingutil.h"
 #include "settings/settings.h"
 #include "util/version.h"
+#include "xpconnect/perfdatarefs.h"
 #include "xpconnect/sharedmemorywriter.h"
+#include "xpconnect/tracer.h"
 #include "xpconnect/xpmenu.h"
 
 extern "C" {
@@ -44,6 +49,12 @@ extern "C" {
 #include <QWaitCondition>
 #include <QDir>
 #include <QStringBuilder>
+#include <QElapsedTimer>
+
+// Sent by X-Plane 12.04 and later when plugins add datarefs - not defined in older SDK headers
+#ifndef XPLM_MSG_DATAREFS_ADDED
+#define XPLM_MSG_DATAREFS_ADDED 114
+#endif
 
 /*
  * This file contains the C functions needed by the XPLM API.
@@ -62,8 +73,18 @@ static const QLatin1String SETTINGS_OPTIONS_VERBOSE("Options/Verbose");
 
 float flightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
                          void *inRefcon);
+float rediscoverCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
+                         void *inRefcon);
+float userStreamCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
+                         void *inRefcon);
 void checkPath();
 
+/* Interval for looking up datarefs which were not found on initialization */
+static const float REDISCOVER_INTERVAL_SEC = 10.f;
+
+/* Interval for checking the menu if the user aircraft stream is disabled */
+static const float USER_STREAM_IDLE_INTERVAL_SEC = 1.f;
+
 /* Application object for event queue in server thread */
 static atools::gui::ConsoleApplication *app = nullptr;
 
@@ -74,10 +95,34 @@ static bool verbose = false;
 static SharedMemoryWriter *thread = nullptr;
 static XpMenu *menu = nullptr;
 
+// Publishes performance counters as datarefs
+static xpc::PerfDataRefs *perfDataRefs = nullptr;
+
+// Reduces work if plugin needs too much of the frame time
+static xpc::FrameGovernor *governor = nullptr;
+
+// Fetch flight loop running after the flight model and its phase locked scheduler
+static XPLMFlightLoopID flightLoopId = nullptr;
+static xpc::FlightLoopScheduler *scheduler = nullptr;
+
+// Publishes user aircraft on every frame if enabled
+static XPLMFlightLoopID userStreamLoopId = nullptr;
+
+// Logs system information in background on startup
+static QThread *diagnosticsThread = nullptr;
+
+/* Log duration of a startup phase and restart timer */
+static void logStartupPhase(const char *phase, QElapsedTimer& timer)
+{
+  qInfo() << "LittleXpconnect" << "Startup phase" << phase << "took" << timer.nsecsElapsed() / 1000L << "us";
+  timer.restart();
+}
+
 /* Called on simulator startup */
 PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
 {
-  qDebug() << Q_FUNC_INFO << "Little Xpconnect";
+  QElapsedTimer timer;
+  timer.start();
 
   // Register atools types so we can stream them
   atools::fs::sc::registerMetaTypes();
@@ -99,9 +144,23 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
 
   // Initialize logging and force logfiles into the system or user temp directory
   LoggingHandler::initializeForTemp(Settings::getOverloadedPath(QStringLiteral(":/littlexpconnect/resources/config/logging.cfg")));
+
+  // Write log files in background to avoid blocking the simulator
+  xpc::asynclog::install();
+  qDebug() << Q_FUNC_INFO << "Little Xpconnect";
+  logStartupPhase("application and logging", timer);
+
   Settings::logMessages();
-  LoggingUtil::logSystemInformation();
-  LoggingUtil::logStandardPaths();
+
+  // System information is only needed for diagnostics - collect it in background
+  diagnosticsThread = QThread::create([]() {
+    QElapsedTimer diagnosticsTimer;
+    diagnosticsTimer.start();
+    LoggingUtil::logSystemInformation();
+    LoggingUtil::logStandardPaths();
+    logStartupPhase("diagnostics (background)", diagnosticsTimer);
+  });
+  diagnosticsThread->start(QThread::LowPriority);
 
   // Pass plugin information to X-Plane
   QString info = QStringLiteral("%1 %2").arg(QCoreApplication::applicationName()).arg(QCoreApplication::applicationVersion());
@@ -124,6 +183,7 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
   Settings& settings = Settings::instance();
   settings.remove(QStringLiteral("Options/FetchRate")); // Delete obsolete key in any case
   verbose = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_VERBOSE, false).toBool();
+  logStartupPhase("settings", timer);
 
   // Always successfull
   return 1;
@@ -133,6 +193,16 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
 PLUGIN_API void XPluginStop(void)
 {
   qDebug() << Q_FUNC_INFO << "Little Xpconnect";
+
+  if(diagnosticsThread != nullptr)
+  {
+    diagnosticsThread->wait();
+    delete diagnosticsThread;
+    diagnosticsThread = nullptr;
+  }
+
+  // Write remaining messages
+  xpc::asynclog::uninstall();
 }
 
 /* Enable plugin - can be called more than once during a simulator session */
@@ -140,20 +210,47 @@ PLUGIN_API int XPluginEnable(void)
 {
   qDebug() << Q_FUNC_INFO << "Little Xpconnect";
 
-  // Start the backgound writer
+  QElapsedTimer timer;
+  timer.start();
+
+  // Start the backgound writer - creates shared memory in thread context and
+  // initializes datarefs on first fetch
   thread = new SharedMemoryWriter(verbose);
   thread->start();
+  logStartupPhase("writer thread", timer);
+
+  perfDataRefs = new xpc::PerfDataRefs(thread->getPerfCounters());
+  governor = new xpc::FrameGovernor;
+  scheduler = new xpc::FlightLoopScheduler(thread->getPerfCounters());
+
+  // Create callback running after the flight model to get the latest values - first call in five seconds
+  XPLMCreateFlightLoop_t flightLoopParams;
+  flightLoopParams.structSize = sizeof(flightLoopParams);
+  flightLoopParams.phase = xplm_FlightLoop_Phase_AfterFlightModel;
+  flightLoopParams.callbackFunc = flightLoopCallback;
+  flightLoopParams.refcon = nullptr;
+  flightLoopId = XPLMCreateFlightLoop(&flightLoopParams);
+  XPLMScheduleFlightLoop(flightLoopId, 5.f, 1);
 
-  // Register callback into method - first call in five seconds
-  XPLMRegisterFlightLoopCallback(flightLoopCallback, 5.f, nullptr);
+  // Same phase as fetch callback - rescheduled for every frame if enabled
+  flightLoopParams.callbackFunc = userStreamCallback;
+  userStreamLoopId = XPLMCreateFlightLoop(&flightLoopParams);
+  XPLMScheduleFlightLoop(userStreamLoopId, 5.f, 1);
+
+  // Separate low rate callback to find datarefs registered later by other plugins
+  XPLMRegisterFlightLoopCallback(rediscoverCallback, REDISCOVER_INTERVAL_SEC, nullptr);
+
+  logStartupPhase("datarefs and callbacks", timer);
 
   // Check installation path and print a warning to Log.txt if invalid
   checkPath();
+  logStartupPhase("path check", timer);
 
   // Create menu structure and load values from settings
   menu = new XpMenu();
   menu->restoreState();
   menu->addMenu(QStringLiteral("Little Xpconnect"));
+  logStartupPhase("menu", timer);
   return 1;
 }
 
@@ -165,11 +262,29 @@ PLUGIN_API void XPluginDisable()
   menu->saveState();
   delete menu;
   menu = nullptr;
+
   // Unregister call back
-  XPLMUnregisterFlightLoopCallback(flightLoopCallback, nullptr);
+  XPLMDestroyFlightLoop(flightLoopId);
+  flightLoopId = nullptr;
+  XPLMDestroyFlightLoop(userStreamLoopId);
+  userStreamLoopId = nullptr;
+  XPLMUnregisterFlightLoopCallback(rediscoverCallback, nullptr);
+
+  delete governor;
+  governor = nullptr;
+  delete scheduler;
+  scheduler = nullptr;
+
+  // Remove datarefs before counters are deleted with the thread
+  delete perfDataRefs;
+  perfDataRefs = nullptr;
 
   qDebug() << Q_FUNC_INFO << "Little Xpconnect" << "Terminating thread";
   thread->terminateThread();
+
+  // Save statistics for all pipeline stages in machine-readable form
+  thread->getPerfCounters()->writeReport(QDir::temp().filePath(QStringLiteral("little_xpconnect_perf.json")));
+
   delete thread;
   thread = nullptr;
   qDebug() << Q_FUNC_INFO << "Little Xpconnect" << "Terminating thread done";
@@ -179,22 +294,72 @@ PLUGIN_API void XPluginDisable()
 PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, long inMessage, void *inParam)
 {
   Q_UNUSED(inFromWho)
-  Q_UNUSED(inMessage)
   Q_UNUSED(inParam)
+
+  if(thread == nullptr)
+    return;
+
+  // Array sizes of datarefs are cached - check again for changes after loading user or AI aircraft
+  if(inMessage == XPLM_MSG_PLANE_LOADED)
+    thread->planeLoaded();
+
+  // Traffic plugins might have added datarefs - look for missing ones in the next frame
+  if(inMessage == XPLM_MSG_PLANE_LOADED || inMessage == XPLM_MSG_AIRPLANE_COUNT_CHANGED || inMessage == XPLM_MSG_DATAREFS_ADDED)
+    XPLMSetFlightLoopCallbackInterval(rediscoverCallback, -1.f, 1, nullptr);
 }
 
 float flightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
+{
+  Q_UNUSED(inElapsedTimeSinceLastFlightLoop)
+  Q_UNUSED(inRefcon)
+
+  TRACE_SCOPE("flightLoopCallback");
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Copy data from datarefs and pass it over to the thread for writing into the shared memory
+  // Governor might stop loading new aircraft files if the plugin uses too much of the frame time
+  thread->fetchAndWriteData(menu->isFetchAi(), menu->isFetchAircraftInfo(), governor->isFetchAiInfo(), menu->isRecordDataRefs());
+
+  if(governor->update(timer.nsecsElapsed(), inElapsedSinceLastCall, inCounter))
+  {
+    thread->setAiUpdateInterval(governor->getAiUpdateInterval());
+    menu->setGovernorState(governor->getLevelText());
+  }
+
+  // Return float seconds or negative number of frames until next call - keeps an exact cadence
+  qint64 periodNs = static_cast<qint64>(static_cast<float>(menu->getFetchRateMs()) * governor->getIntervalFactor() * 1000000.f);
+  return scheduler->schedule(periodNs, inElapsedSinceLastCall, inCounter);
+}
+
+float userStreamCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
+{
+  Q_UNUSED(inElapsedSinceLastCall)
+  Q_UNUSED(inElapsedTimeSinceLastFlightLoop)
+  Q_UNUSED(inRefcon)
+
+  bool enabled = menu->isStreamUserAircraft();
+  thread->streamUserAircraft(enabled, inCounter);
+
+  // Next frame or check menu again later
+  return enabled ? -1.f : USER_STREAM_IDLE_INTERVAL_SEC;
+}
+
+float rediscoverCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
 {
   Q_UNUSED(inElapsedSinceLastCall)
   Q_UNUSED(inElapsedTimeSinceLastFlightLoop)
   Q_UNUSED(inCounter)
   Q_UNUSED(inRefcon)
 
-  // Copy data from datarefs and pass it over to the thread for writing into the shared memory
-  thread->fetchAndWriteData(menu->isFetchAi(), menu->isFetchAircraftInfo());
+  // Runs outside of the fetch callback - new refs are used in the next fetch
+  thread->rediscoverDataRefs();
+
+  // All plugins are enabled now - register own datarefs with editors
+  perfDataRefs->notifyEditors();
 
-  // Return float seconds until next call
-  return static_cast<float>(menu->getFetchRateMs()) / 1000.f;
+  return REDISCOVER_INTERVAL_SEC;
 }
 
 void checkPath()
@@ -17,16 +17,20 @@
 
 #include "xpconnect/aircraftfileloader.h"
 #include "xpconnect/dataref.h"
+#include "xpconnect/perfcounters.h"
+#include "xpconnect/stringpool.h"
+#include "xpconnect/tracer.h"
 #include "atools.h"
 
+#include <QElapsedTimer>
 #include <QFile>
 #include <QThreadPool>
 #include <QtConcurrent/QtConcurrent>
 
 namespace xpc {
 
-AircraftFileLoader::AircraftFileLoader(bool verboseLogging)
-  : verbose(verboseLogging)
+AircraftFileLoader::AircraftFileLoader(bool verboseLogging, PerfCounters *perfCounters)
+  : counters(perfCounters), verbose(verboseLogging)
 {
   aircraftFileCache = new QCache<QString, AircraftEntryType>;
 
@@ -52,6 +56,7 @@ AircraftFileLoader::~AircraftFileLoader()
 
 void AircraftFileLoader::loadKeysRunner(QString aircraftModelFilepath, QStringList keys)
 {
+  TRACE_SCOPE("loadKeysRunner");
   // Runs in separate thread
   if(verbose)
     qDebug() << Q_FUNC_INFO << "Entry" << aircraftModelFilepath;
@@ -61,7 +66,10 @@ void AircraftFileLoader::loadKeysRunner(QString aircraftModelFilepath, QStringLi
   QString aircraftModelKey = aircraftModelFilepath.toLower();
 
   // "acf/_is_airliner",  "acf/_is_general_aviation","acf/_callsign", "acf/_name", "acf/_descrip"
+  QElapsedTimer timer;
+  timer.start();
   readValuesFromAircraftFile(*keyValuePairs, aircraftModelFilepath, keys, verbose);
+  counters->addStage(STAGE_ACF_READ, timer.nsecsElapsed());
 
   {
     // Add to cache
@@ -74,16 +82,20 @@ void AircraftFileLoader::loadKeysRunner(QString aircraftModelFilepath, QStringLi
     QMutexLocker locker(aircraftFileKeysLoadingMutex);
     aircraftFileKeysLoading.remove(aircraftModelKey);
   }
+  counters->addLoaderQueued(-1);
 
   if(verbose)
     qDebug() << Q_FUNC_INFO << "Exit" << aircraftModelFilepath;
 }
 
-void AircraftFileLoader::loadAircraftFile(atools::fs::sc::SimConnectAircraft& aircraft, quint32 objId)
+bool AircraftFileLoader::loadAircraftFile(atools::fs::sc::SimConnectAircraft& aircraft, quint32 objId)
 {
   if(aircraftIdsNotFound.contains(objId))
+  {
     // File does not exist for this cached id
-    return;
+    counters->addLoaderCacheHit();
+    return true;
+  }
 
   QString aircraftModelFilepath = getAircraftModelFilepath(static_cast<int>(objId));
   QString aircraftModelKey = aircraftModelFilepath.toLower();
@@ -104,6 +116,12 @@ void AircraftFileLoader::loadAircraftFile(atools::fs::sc::SimConnectAircraft& ai
   }
 
   if(found)
+    counters->addLoaderCacheHit();
+  else
+    counters->addLoaderCacheMiss();
+
+  if(found)
+  {
     // Use cached and copied attributes from the acf file ======================================
     // Cessna_172SP_seaplane.acf:P acf/_descrip Cessna 172 SP Skyhawk - 180HP
     // Cessna_172SP_seaplane.acf:P acf/_name Cessna Skyhawk (Floats)
@@ -112,12 +130,17 @@ void AircraftFileLoader::loadAircraftFile(atools::fs::sc::SimConnectAircraft& ai
     // MD80.acf:P acf/_descrip MAD DOG
     // MD80.acf:P acf/_name MD-82
     fillAircraftValues(aircraft, &keyValuePairs);
+    return true;
+  }
   else
   {
     // Not in cache ... ============
     // Check if file is valid and exists - otherwise add objId to negative cache
     if(aircraftModelFilepath.isEmpty() || !QFile::exists(aircraftModelFilepath))
+    {
       aircraftIdsNotFound.insert(objId);
+      return true;
+    }
     else
     {
       // Not found in cache
@@ -128,12 +151,14 @@ void AircraftFileLoader::loadAircraftFile(atools::fs::sc::SimConnectAircraft& ai
       {
         // Remember key which is loading now - thread will remove this key on completion
         aircraftFileKeysLoading.insert(aircraftModelKey);
+        counters->addLoaderQueued(1);
 
         // Threadpool will wait until a free thread is available
         auto result = QtConcurrent::run(threadPool, &AircraftFileLoader::loadKeysRunner, this, aircraftModelFilepath, aircraftKeys);
       }
     }
   }
+  return false;
 }
 
 void AircraftFileLoader::readValuesFromAircraftFile(AircraftEntryType& keyValuePairs, const QString& filepath,
@@ -180,18 +205,24 @@ void AircraftFileLoader::readValuesFromAircraftFile(AircraftEntryType& keyValueP
     qWarning() << Q_FUNC_INFO << "Cannot open file" << filepath << "error" << file.errorString();
 }
 
+QString AircraftFileLoader::stringValue(const AircraftEntryType *keyValuePairs, const QString& key)
+{
+  QString value = keyValuePairs->value(key);
+  return stringPool != nullptr ? stringPool->intern(value) : value;
+}
+
 void AircraftFileLoader::fillAircraftValues(atools::fs::sc::SimConnectAircraft& aircraft, const AircraftEntryType *keyValuePairs)
 {
   if(aircraft.airplaneTitle.isEmpty())
-    aircraft.airplaneTitle = keyValuePairs->value(QStringLiteral("acf/_name"));
+    aircraft.airplaneTitle = stringValue(keyValuePairs, QStringLiteral("acf/_name"));
 
-  QString model = keyValuePairs->value(QStringLiteral("acf/_ICAO"));
+  QString model = stringValue(keyValuePairs, QStringLiteral("acf/_ICAO"));
   if(aircraft.airplaneModel.isEmpty())
     aircraft.airplaneModel = model; // C172
   else if(!model.isEmpty() && aircraft.airplaneModel != model && verbose)
     qWarning() << Q_FUNC_INFO << "Aircraft type mismatch" << aircraft.airplaneModel << model;
 
-  QString reg = keyValuePairs->value(QStringLiteral("acf/_tailnum"));
+  QString reg = stringValue(keyValuePairs, QStringLiteral("acf/_tailnum"));
   if(aircraft.airplaneReg.isEmpty())
     aircraft.airplaneReg = reg; // Registration N172SP
   else if(!reg.isEmpty() && aircraft.airplaneReg != reg && verbose)
@@ -25,6 +25,9 @@ class QMutex;
 
 namespace xpc {
 
+class PerfCounters;
+class StringPool;
+
 /*
  * Loads and caches required key entries from acf files to get information missing in the datarefs.
  * Read values from .acf file which are not available by the API.
@@ -35,14 +38,16 @@ class AircraftFileLoader :
   Q_OBJECT
 
 public:
-  AircraftFileLoader(bool verboseLogging);
+  /* Cache and queue statistics are written to perfCounters */
+  AircraftFileLoader(bool verboseLogging, PerfCounters *perfCounters);
   virtual ~AircraftFileLoader() override;
 
   AircraftFileLoader(const AircraftFileLoader& other) = delete;
   AircraftFileLoader& operator=(const AircraftFileLoader& other) = delete;
 
-  /* Load and cache required entries from acf file for given aircraft id. Result is stored in aircraft */
-  void loadAircraftFile(atools::fs::sc::SimConnectAircraft& aircraft, quint32 objId);
+  /* Load and cache required entries from acf file for given aircraft id. Result is stored in aircraft.
+   * Returns true if values were filled or if the file does not exist. False if the file is still loading. */
+  bool loadAircraftFile(atools::fs::sc::SimConnectAircraft& aircraft, quint32 objId);
 
   /* Set keys to read from files.
    * Keys minus prefix "P " like "acf/_name", "acf/_ICAO" */
@@ -56,7 +61,12 @@ public:
     return aircraftKeys;
   }
 
-private:
+  /* Pool to share title, model and registration strings with datarefs values. Not owned. Can be null. */
+  void setStringPool(StringPool *value)
+  {
+    stringPool = value;
+  }
+
   typedef QHash<QString, QString> AircraftEntryType;
 
   /* Read keys from acf file. Reading stops if all keys are found. Use rarely and cache values since
@@ -65,6 +75,11 @@ private:
   static void readValuesFromAircraftFile(AircraftEntryType& keyValuePairs, const QString& filepath,
                                          const QStringList& keys, bool verboseLogging);
 
+private:
+
+  /* Value for key from file. Shared instance from pool if set. */
+  QString stringValue(const AircraftEntryType *keyValuePairs, const QString& key);
+
   /* Fill and decode keys into aircraft */
   void fillAircraftValues(atools::fs::sc::SimConnectAircraft& aircraft, const AircraftEntryType *keyValuePairs);
 
@@ -86,6 +101,8 @@ private:
   QThreadPool *threadPool;
 
   QStringList aircraftKeys;
+  PerfCounters *counters;
+  StringPool *stringPool = nullptr;
   bool verbose = false;
 };
 
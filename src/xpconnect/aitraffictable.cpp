@@ -0,0 +1,146 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/aitraffictable.h"
+
+#include <algorithm>
+
+namespace xpc {
+
+/* Key of slots which were never used */
+static const quint64 NO_KEY = ~0ULL;
+
+/* Object ids for TCAS and multiplayer aircraft. Below are boats. */
+static const quint32 OBJECT_ID_MIN = 0x1000, OBJECT_ID_MAX = 0xfffff;
+
+void AiTrafficTable::reserveSlots(int size)
+{
+  if(size <= this->size())
+    return;
+
+  valid.resize(size, 0);
+  lastValid.resize(size, 0);
+  onGround.resize(size, 0);
+  aircraftFileLoaded.resize(size, 0);
+  keys.resize(size, NO_KEY);
+  objectIds.resize(size, 0);
+  transponderCodes.resize(size, -1);
+  for(QList<float> *list : {&lonX, &latY, &altitudeFt, &headingTrueDeg, &groundSpeedKts, &verticalSpeedFpm, &velocityEastMs,
+                            &velocityNorthMs, &velocityUpMs, &turnRateDegS})
+    list->resize(size, 0.f);
+  aircraft.resize(size);
+  rawModels.resize(size, 0L);
+  rawRegistrations.resize(size, 0L);
+}
+
+/* Copy elements into list reusing its memory */
+template<typename TYPE>
+static void copyList(const QList<TYPE>& from, QList<TYPE>& to)
+{
+  to.resize(from.size());
+  std::copy(from.cbegin(), from.cend(), to.begin());
+}
+
+void AiTrafficTable::copyValuesTo(AiTrafficTable& other) const
+{
+  copyList(valid, other.valid);
+  copyList(onGround, other.onGround);
+  copyList(transponderCodes, other.transponderCodes);
+  copyList(lonX, other.lonX);
+  copyList(latY, other.latY);
+  copyList(altitudeFt, other.altitudeFt);
+  copyList(headingTrueDeg, other.headingTrueDeg);
+  copyList(groundSpeedKts, other.groundSpeedKts);
+  copyList(verticalSpeedFpm, other.verticalSpeedFpm);
+  copyList(velocityEastMs, other.velocityEastMs);
+  copyList(velocityNorthMs, other.velocityNorthMs);
+  copyList(velocityUpMs, other.velocityUpMs);
+  copyList(turnRateDegS, other.turnRateDegS);
+  copyList(objectIds, other.objectIds);
+  copyList(aircraft, other.aircraft);
+  other.simTimeSec = simTimeSec;
+  other.hasDeadReckoning = hasDeadReckoning;
+  other.numValid = numValid;
+}
+
+void AiTrafficTable::beginUpdate()
+{
+  lastValid = valid;
+  valid.fill(0);
+  numValid = 0;
+  events.clear();
+}
+
+bool AiTrafficTable::useSlot(int slot, quint64 key)
+{
+  if(!valid.at(slot))
+  {
+    valid[slot] = 1;
+    numValid++;
+  }
+
+  bool reset = keys.at(slot) != key;
+  if(reset)
+  {
+    // Another aircraft took the slot
+    if(lastValid.at(slot))
+      events.append({AI_REMOVED, keys.at(slot), objectIds.at(slot), slot});
+
+    keys[slot] = key;
+    objectIds[slot] = nextObjectId();
+    resetMetadata(slot);
+  }
+
+  if(reset || !lastValid.at(slot))
+    events.append({AI_ADDED, key, objectIds.at(slot), slot});
+
+  return reset;
+}
+
+void AiTrafficTable::resetMetadata(int slot)
+{
+  aircraft[slot] = atools::fs::sc::SimConnectAircraft();
+  rawModels[slot] = rawRegistrations[slot] = 0L;
+  aircraftFileLoaded[slot] = 0;
+}
+
+void AiTrafficTable::setUpdated(int slot)
+{
+  events.append({AI_UPDATED, keys.at(slot), objectIds.at(slot), slot});
+}
+
+void AiTrafficTable::endUpdate()
+{
+  for(int slot = 0; slot < size(); slot++)
+  {
+    if(lastValid.at(slot) && !valid.at(slot))
+      events.append({AI_REMOVED, keys.at(slot), objectIds.at(slot), slot});
+  }
+}
+
+quint32 AiTrafficTable::nextObjectId()
+{
+  // Skip ids still in use after wrapping around
+  do
+  {
+    lastObjectId = lastObjectId >= OBJECT_ID_MAX || lastObjectId < OBJECT_ID_MIN ? OBJECT_ID_MIN : lastObjectId + 1;
+  } while(objectIds.contains(lastObjectId));
+
+  return lastObjectId;
+}
+
+} // namespace xpc
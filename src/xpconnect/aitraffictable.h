@@ -0,0 +1,166 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_AITRAFFICTABLE_H
+#define LITTLEXPC_AITRAFFICTABLE_H
+
+#include "fs/sc/simconnectaircraft.h"
+
+#include <QList>
+
+namespace xpc {
+
+enum AiTrafficEventType
+{
+  AI_ADDED, /* Aircraft appeared or came back after missing in last update */
+  AI_UPDATED, /* Strings of aircraft have changed */
+  AI_REMOVED /* Aircraft is gone or slot was taken by another aircraft */
+};
+
+/* Change of an aircraft in the table */
+struct AiTrafficEvent
+{
+  AiTrafficEventType type;
+  quint64 key;
+  quint32 objectId;
+  int slot;
+};
+
+/*
+ * Structure of arrays table for TCAS and multiplayer AI aircraft. Index is the stable aircraft slot, i.e. the
+ * TCAS index or the multiplayer number, which is also used by the aircraft file loader.
+ *
+ * Values changing on every update are kept in one contiguous array per field and are overwritten in place.
+ * Strings and values loaded from aircraft files are kept in one SimConnectAircraft per slot which is reset
+ * only if another aircraft takes the slot.
+ *
+ * Aircraft are identified by a key which is the Mode S id combined with the slot for TCAS or the slot for multiplayer.
+ * The slot is part of the key since plugins might use the same Mode S id for several aircraft.
+ * Each key gets an object id which stays the same as long as the aircraft is present. Added, updated and removed
+ * aircraft are reported as events for each update.
+ *
+ * Filled by XpConnect in the main thread. The writer thread copies the values under the data lock using
+ * copyValuesTo() and converts the copy to SimConnectAircraft objects after releasing the lock.
+ */
+class AiTrafficTable
+{
+public:
+  AiTrafficTable()
+  {
+  }
+
+  AiTrafficTable(const AiTrafficTable& other) = delete;
+  AiTrafficTable& operator=(const AiTrafficTable& other) = delete;
+
+  /* Grow all arrays to the given number of slots. Keeps content and validity of existing slots. */
+  void reserveSlots(int size);
+
+  /* Mark all slots as unused and clear events. Keeps content to detect reused slots. */
+  void beginUpdate();
+
+  /* Mark slot as used by the aircraft with the given key. Clears the slot and assigns a new object id if the key
+   * differs from the last one. Returns true if the slot was reset. */
+  bool useSlot(int slot, quint64 key);
+
+  /* Reset strings and aircraft file values of slot to force decoding them again */
+  void resetMetadata(int slot);
+
+  /* Report changed strings for an aircraft which was not added in this update */
+  void setUpdated(int slot);
+
+  /* Add events for aircraft which were not used in this update */
+  void endUpdate();
+
+  /* Remove all aircraft and add events */
+  void clear()
+  {
+    beginUpdate();
+    endUpdate();
+  }
+
+  /* Copy values needed by XpConnect::materializeAiTraffic() into other which is usually owned by another thread.
+   * Copies elements instead of sharing the lists to avoid detaching them in the main thread on the next update.
+   * Keys, raw strings and events are not copied. */
+  void copyValuesTo(AiTrafficTable& other) const;
+
+  /* Events of last update */
+  const QList<AiTrafficEvent>& getEvents() const
+  {
+    return events;
+  }
+
+  /* Store raw string values of slot and return true if one has changed */
+  bool updateRaw(int slot, quint64 rawModel, quint64 rawRegistration)
+  {
+    bool changed = rawModels.at(slot) != rawModel || rawRegistrations.at(slot) != rawRegistration;
+    rawModels[slot] = rawModel;
+    rawRegistrations[slot] = rawRegistration;
+    return changed;
+  }
+
+  /* Number of slots */
+  int size() const
+  {
+    return static_cast<int>(valid.size());
+  }
+
+  /* Number of slots used in last update */
+  int getNumValid() const
+  {
+    return numValid;
+  }
+
+  /* Values updated every fetch. Transponder code is the raw dataref value or -1 if not available.
+   * Velocity values are only valid if hasDeadReckoning is set. */
+  QList<quint8> valid, onGround;
+  QList<int> transponderCodes;
+  QList<float> lonX, latY, altitudeFt, headingTrueDeg, groundSpeedKts, verticalSpeedFpm, velocityEastMs, velocityNorthMs,
+               velocityUpMs, turnRateDegS;
+
+  /* Key and object id of aircraft in slot. Set by useSlot(). */
+  QList<quint64> keys;
+  QList<quint32> objectIds;
+
+  /* Strings and aircraft file values */
+  QList<atools::fs::sc::SimConnectAircraft> aircraft;
+
+  /* Raw dataref values the strings were decoded from. Eight byte TCAS fields or hash of multiplayer tail number. */
+  QList<quint64> rawModels, rawRegistrations;
+
+  /* Values from aircraft file are in aircraft or file does not exist */
+  QList<quint8> aircraftFileLoaded;
+
+  /* Sim time of the last update and whether velocities are available from the TCAS interface */
+  double simTimeSec = 0.;
+  bool hasDeadReckoning = false;
+
+private:
+  /* Next unused object id */
+  quint32 nextObjectId();
+
+  int numValid = 0;
+  quint32 lastObjectId = 0;
+
+  /* Slots used in last update */
+  QList<quint8> lastValid;
+
+  QList<AiTrafficEvent> events;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_AITRAFFICTABLE_H
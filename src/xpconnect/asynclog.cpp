@@ -0,0 +1,303 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/asynclog.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#include <atomic>
+
+namespace xpc {
+namespace asynclog {
+
+namespace {
+
+/* Queue size. Has to be a power of two. */
+const quint64 QUEUE_SIZE = 1024;
+const quint64 QUEUE_MASK = QUEUE_SIZE - 1;
+
+/* Flush thread wakes up in this interval */
+const unsigned long FLUSH_INTERVAL_MS = 20;
+
+/* Pass only this number of warnings per source and window */
+const int RATE_LIMIT_COUNT = 10;
+const qint64 RATE_LIMIT_WINDOW_MS = 10000L;
+
+/* Copy of a message and its context. Context strings are literals and are not copied. */
+struct Message
+{
+  QtMsgType type = QtDebugMsg;
+  const char *file = nullptr, *function = nullptr, *category = nullptr;
+  int line = 0;
+  QString text;
+};
+
+/* Slot in the bounded multi producer single consumer queue. Sequence number tells if the slot is free or filled. */
+struct Cell
+{
+  std::atomic<quint64> sequence;
+  Message message;
+};
+
+/* Rate limiting state for one message source. Context of last suppressed message is kept for the summary. */
+struct RateLimit
+{
+  qint64 windowStartMs = 0L;
+  int count = 0, suppressed = 0;
+  QString lastText;
+  QtMsgType type = QtWarningMsg;
+  const char *file = nullptr, *function = nullptr, *category = nullptr;
+  int line = 0;
+};
+
+Cell cells[QUEUE_SIZE];
+std::atomic<quint64> enqueuePos = 0L;
+quint64 dequeuePos = 0L; /* Only used by consumer */
+std::atomic<quint64> dropped = 0L;
+
+std::atomic<bool> running = false, terminate = false;
+
+/* Number of producers between checking "running" and enqueueing. Awaited in uninstall(). */
+std::atomic<int> activeProducers = 0;
+QtMessageHandler previousHandler = nullptr;
+QThread *flushThread = nullptr;
+
+/* Serializes consumers, i.e. the flush thread and a fatal message. Never locked by producers. */
+QMutex consumerMutex;
+
+/* Used only by consumer */
+QHash<QByteArray, RateLimit> rateLimits;
+
+/* Push message into queue. Returns false if full. Lock-free for multiple producers. */
+bool enqueue(Message&& message)
+{
+  quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+  while(true)
+  {
+    Cell& cell = cells[pos & QUEUE_MASK];
+    qint64 diff = static_cast<qint64>(cell.sequence.load(std::memory_order_acquire)) - static_cast<qint64>(pos);
+
+    if(diff == 0)
+    {
+      // Slot is free - try to claim it
+      if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        cell.message = std::move(message);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if(diff < 0)
+      // Consumer did not free slot yet - queue full
+      return false;
+    else
+      // Other producer was faster
+      pos = enqueuePos.load(std::memory_order_relaxed);
+  }
+}
+
+/* Fetch message from queue. Returns false if empty. Single consumer. */
+bool dequeue(Message& message)
+{
+  Cell& cell = cells[dequeuePos & QUEUE_MASK];
+  if(cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+    return false;
+
+  message = std::move(cell.message);
+  cell.sequence.store(dequeuePos + QUEUE_SIZE, std::memory_order_release);
+  dequeuePos++;
+  return true;
+}
+
+void passOn(QtMsgType type, const char *file, int line, const char *function, const char *category, const QString& text)
+{
+  QMessageLogContext context(file, line, function, category);
+  previousHandler(type, context, text);
+}
+
+void passOn(const Message& message)
+{
+  passOn(message.type, message.file, message.line, message.function, message.category, message.text);
+}
+
+/* Write summary for suppressed messages if any */
+void passSummary(RateLimit& limit)
+{
+  if(limit.suppressed > 0)
+  {
+    passOn(limit.type, limit.file, limit.line, limit.function, limit.category,
+           QStringLiteral("Suppressed %1 repeated messages like \"%2\"").arg(limit.suppressed).arg(limit.lastText));
+    limit.suppressed = 0;
+    limit.lastText.clear();
+  }
+}
+
+/* Returns true if message should be logged. Summarizes suppressed messages when a window ends. */
+bool checkRateLimit(const Message& message, qint64 nowMs)
+{
+  if(message.type != QtWarningMsg && message.type != QtCriticalMsg)
+    return true;
+
+  // Group by source location if available (debug builds) or by text otherwise
+  QByteArray key = message.file != nullptr ? QByteArray(message.file) + ':' + QByteArray::number(message.line) : message.text.toUtf8();
+
+  RateLimit& limit = rateLimits[key];
+  if(nowMs - limit.windowStartMs > RATE_LIMIT_WINDOW_MS)
+  {
+    passSummary(limit);
+    limit.windowStartMs = nowMs;
+    limit.count = 0;
+  }
+
+  if(++limit.count > RATE_LIMIT_COUNT)
+  {
+    limit.suppressed++;
+    limit.lastText = message.text;
+    limit.type = message.type;
+    limit.file = message.file;
+    limit.line = message.line;
+    limit.function = message.function;
+    limit.category = message.category;
+    return false;
+  }
+  return true;
+}
+
+/* Write summaries for sources which went quiet and remove their state. Writes all summaries if all is true. */
+void flushRateLimits(qint64 nowMs, bool all)
+{
+  for(auto it = rateLimits.begin(); it != rateLimits.end();)
+  {
+    if(all || nowMs - it->windowStartMs > RATE_LIMIT_WINDOW_MS)
+    {
+      passSummary(*it);
+      it = rateLimits.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+/* Pass all queued messages to previous handler. Writes all pending summaries if final is true. */
+void flush(bool final = false)
+{
+  QMutexLocker locker(&consumerMutex);
+  qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+  Message message;
+  while(dequeue(message))
+  {
+    if(checkRateLimit(message, nowMs))
+      passOn(message);
+  }
+
+  flushRateLimits(nowMs, final);
+
+  quint64 numDropped = dropped.exchange(0L, std::memory_order_relaxed);
+  if(numDropped > 0)
+    passOn(QtWarningMsg, nullptr, 0, nullptr, "default", QStringLiteral("Log queue full. Dropped %1 messages").arg(numDropped));
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& text)
+{
+  // Register before checking the flag - uninstall() waits until all registered producers are done
+  activeProducers.fetch_add(1, std::memory_order_seq_cst);
+
+  if(!running.load(std::memory_order_seq_cst))
+  {
+    activeProducers.fetch_sub(1, std::memory_order_release);
+    previousHandler(type, context, text);
+    return;
+  }
+
+  if(type == QtFatalMsg)
+  {
+    // Program will abort - write all pending messages in this thread to keep order
+    running.store(false, std::memory_order_seq_cst);
+    activeProducers.fetch_sub(1, std::memory_order_release);
+    flush(true /* final */);
+    previousHandler(type, context, text);
+    return;
+  }
+
+  Message message;
+  message.type = type;
+  message.file = context.file;
+  message.line = context.line;
+  message.function = context.function;
+  message.category = context.category;
+  message.text = text;
+
+  if(!enqueue(std::move(message)))
+    dropped.fetch_add(1L, std::memory_order_relaxed);
+
+  activeProducers.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace
+
+void install()
+{
+  if(flushThread != nullptr)
+    return;
+
+  for(quint64 i = 0; i < QUEUE_SIZE; i++)
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+  enqueuePos.store(0L, std::memory_order_relaxed);
+  dequeuePos = 0L;
+  dropped.store(0L, std::memory_order_relaxed);
+  terminate.store(false, std::memory_order_relaxed);
+
+  flushThread = QThread::create([]() {
+    while(!terminate.load(std::memory_order_acquire))
+    {
+      flush();
+      QThread::msleep(FLUSH_INTERVAL_MS);
+    }
+  });
+  flushThread->setObjectName(QStringLiteral("LittleXpconnect Log"));
+  flushThread->start(QThread::LowPriority);
+
+  previousHandler = qInstallMessageHandler(messageHandler);
+  running.store(true, std::memory_order_release);
+}
+
+void uninstall()
+{
+  if(flushThread == nullptr)
+    return;
+
+  // Log directly from now on
+  running.store(false, std::memory_order_seq_cst);
+  terminate.store(true, std::memory_order_release);
+  flushThread->wait();
+  delete flushThread;
+  flushThread = nullptr;
+
+  // Wait for producers which saw the flag still set and write what they queued including pending summaries
+  while(activeProducers.load(std::memory_order_acquire) > 0)
+    QThread::yieldCurrentThread();
+  flush(true /* final */);
+
+  qInstallMessageHandler(previousHandler);
+  rateLimits.clear();
+}
+
+} // namespace asynclog
+} // namespace xpc
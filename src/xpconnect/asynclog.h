@@ -0,0 +1,45 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_ASYNCLOG_H
+#define LITTLEXPC_ASYNCLOG_H
+
+namespace xpc {
+
+/*
+ * Moves Qt logging off the calling thread. Installs a message handler which pushes messages into
+ * a bounded lock-free queue. A background thread passes them on to the previously installed
+ * handler, i.e. the atools LoggingHandler writing to console and log file.
+ *
+ * Callers never block. Messages are dropped and counted if the queue is full.
+ * Repeated warnings from the same source are rate limited in the background thread.
+ * Fatal messages are passed on synchronously after flushing the queue.
+ *
+ * Does not affect xplog which has to call XPLMDebugString in the main thread.
+ */
+namespace asynclog {
+
+/* Install handler and start flush thread. Call after LoggingHandler is initialized. */
+void install();
+
+/* Flush all queued messages, stop thread and restore the previous handler */
+void uninstall();
+
+} // namespace asynclog
+} // namespace xpc
+
+#endif // LITTLEXPC_ASYNCLOG_H
@@ -21,6 +21,9 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QVarLengthArray>
+
+#include <cstring>
 
 extern "C" {
 #include "XPLMPlanes.h"
@@ -52,36 +55,15 @@ void worldToLocal(double& x, double& y, double& z, const atools::geo::Pos& pos)
 }
 
 // ==========================================================================================
-DataRef::DataRef(DataRefPtrList& refs, const QString& dataRefName)
-{
-  init(refs, dataRefName);
-}
-
-DataRef::DataRef(const QString& dataRefName)
-{
-  init(dataRefName);
-}
-
-DataRef::DataRef()
-{
-}
-
-void DataRef::init(DataRefPtrList& refs, const QString& dataRefName)
-{
-  name = dataRefName;
-
-  // Add to array but do not find it yet (still invalid)
-  refs.append(this);
-}
-
-void DataRef::init(const QString& dataRefName)
+void DataRef::init(const char *dataRefName)
 {
-  name = dataRefName;
+  // Refer to static string without copying
+  name = QByteArray::fromRawData(dataRefName, static_cast<qsizetype>(strlen(dataRefName)));
 }
 
 bool DataRef::find(bool warnNotFound)
 {
-  dataRef = XPLMFindDataRef(name.toLatin1().constData());
+  dataRef = XPLMFindDataRef(name.constData());
   if(dataRef == nullptr)
   {
     if(warnNotFound)
@@ -94,65 +76,48 @@ bool DataRef::find(bool warnNotFound)
       qWarning() << Q_FUNC_INFO << name << "has unexpected type xplmType_Unknown";
   }
 
+  updateArraySize();
+
   return isValid();
 }
 
-QList<int> DataRef::valueIntArr() const
+bool DataRef::updateArraySize()
 {
-#ifdef DATAREF_VALIDATION
-  checkType(xplmType_IntArray);
-#endif
-  IntList retval;
+  int size = 0;
 
   if(dataRef != nullptr)
   {
-    // Get size first by calling with null pointer
-    int size = XPLMGetDatavi(dataRef, nullptr, 0, 0);
-    retval.resize(size);
-
-    // Get the array contents
-    XPLMGetDatavi(dataRef, retval.data(), 0, size);
+    // Get size by calling with null pointer
+    if(dataRefType & xplmType_IntArray)
+      size = XPLMGetDatavi(dataRef, nullptr, 0, 0);
+    else if(dataRefType & xplmType_FloatArray)
+      size = XPLMGetDatavf(dataRef, nullptr, 0, 0);
+    // Byte arrays are not cached - see sizeByteArr()
   }
 
+  bool changed = size != arraySize;
+  arraySize = size;
+  return changed;
+}
+
+QList<int> DataRef::valueIntArr() const
+{
+  IntList retval;
+  valueIntArr(retval);
   return retval;
 }
 
 QList<float> DataRef::valueFloatArr() const
 {
-#ifdef DATAREF_VALIDATION
-  checkType(xplmType_FloatArray);
-#endif
-
   FloatList retval;
-  if(dataRef != nullptr)
-  {
-    // Get size first by calling with null pointer
-    int size = XPLMGetDatavf(dataRef, nullptr, 0, 0);
-    retval.resize(size);
-
-    // Get the array contents
-    XPLMGetDatavf(dataRef, retval.data(), 0, size);
-  }
-
+  valueFloatArr(retval);
   return retval;
 }
 
 QByteArray DataRef::valueByteArr() const
 {
-#ifdef DATAREF_VALIDATION
-  checkType(xplmType_Data);
-#endif
-
   QByteArray retval;
-  if(dataRef != nullptr)
-  {
-    // Get size first by calling with null pointer
-    int size = XPLMGetDatab(dataRef, nullptr, 0, 0);
-    retval.resize(size);
-
-    // Get the array contents
-    XPLMGetDatab(dataRef, retval.data(), 0, size);
-  }
+  valueByteArr(retval);
   return retval;
 }
 
@@ -161,11 +126,7 @@ int DataRef::sizeIntArr() const
 #ifdef DATAREF_VALIDATION
   checkType(xplmType_IntArray);
 #endif
-
-  if(dataRef != nullptr)
-    return XPLMGetDatavi(dataRef, nullptr, 0, 0);
-  else
-    return 0;
+  return arraySize;
 }
 
 int DataRef::sizeFloatArr() const
@@ -173,11 +134,7 @@ int DataRef::sizeFloatArr() const
 #ifdef DATAREF_VALIDATION
   checkType(xplmType_FloatArray);
 #endif
-
-  if(dataRef != nullptr)
-    return XPLMGetDatavf(dataRef, nullptr, 0, 0);
-  else
-    return 0;
+  return arraySize;
 }
 
 int DataRef::sizeByteArr() const
@@ -185,11 +142,8 @@ int DataRef::sizeByteArr() const
 #ifdef DATAREF_VALIDATION
   checkType(xplmType_Data);
 #endif
-
-  if(dataRef != nullptr)
-    return XPLMGetDatab(dataRef, nullptr, 0, 0);
-  else
-    return 0;
+  // Get size by calling with null pointer
+  return dataRef != nullptr ? XPLMGetDatab(dataRef, nullptr, 0, 0) : 0;
 }
 
 int DataRef::valueIntArr(int index) const
@@ -219,7 +173,7 @@ float DataRef::valueFloatArr(int index) const
 int DataRef::valueByteArr(int index) const
 {
 #ifdef DATAREF_VALIDATION
-  checkType(xplmType_FloatArray);
+  checkType(xplmType_Data);
 #endif
 
   char retval = '\0';
@@ -234,11 +188,11 @@ void DataRef::valueIntArr(IntList& array) const
   checkType(xplmType_IntArray);
 #endif
 
-  if(dataRef != nullptr)
+  if(dataRef != nullptr && arraySize > 0)
   {
-    int size = XPLMGetDatavi(dataRef, nullptr, 0, 0);
-    array.resize(size);
-    XPLMGetDatavi(dataRef, array.data(), 0, size);
+    array.resize(arraySize);
+    // Truncate if simulator returns less than the cached size
+    array.resize(XPLMGetDatavi(dataRef, array.data(), 0, arraySize));
   }
   else
     array.clear();
@@ -250,11 +204,10 @@ void DataRef::valueFloatArr(FloatList& array) const
   checkType(xplmType_FloatArray);
 #endif
 
-  if(dataRef != nullptr)
+  if(dataRef != nullptr && arraySize > 0)
   {
-    int size = XPLMGetDatavf(dataRef, nullptr, 0, 0);
-    array.resize(size);
-    XPLMGetDatavf(dataRef, array.data(), 0, size);
+    array.resize(arraySize);
+    array.resize(XPLMGetDatavf(dataRef, array.data(), 0, arraySize));
   }
   else
     array.clear();
@@ -262,16 +215,59 @@ void DataRef::valueFloatArr(FloatList& array) const
 
 void DataRef::valueByteArr(QByteArray& bytes) const
 {
-  if(dataRef != nullptr)
+#ifdef DATAREF_VALIDATION
+  checkType(xplmType_Data);
+#endif
+
+  int size = sizeByteArr();
+  if(size > 0)
   {
-    int size = XPLMGetDatab(dataRef, nullptr, 0, 0);
     bytes.resize(size);
-    XPLMGetDatab(dataRef, bytes.data(), 0, size);
+    bytes.resize(XPLMGetDatab(dataRef, bytes.data(), 0, size));
   }
   else
     bytes.clear();
 }
 
+int DataRef::valueIntArr(std::span<int> values) const
+{
+#ifdef DATAREF_VALIDATION
+  checkType(xplmType_IntArray);
+#endif
+
+  int size = std::min(arraySize, static_cast<int>(values.size()));
+  if(dataRef != nullptr && size > 0)
+    return XPLMGetDatavi(dataRef, values.data(), 0, size);
+  else
+    return 0;
+}
+
+int DataRef::valueFloatArr(std::span<float> values) const
+{
+#ifdef DATAREF_VALIDATION
+  checkType(xplmType_FloatArray);
+#endif
+
+  int size = std::min(arraySize, static_cast<int>(values.size()));
+  if(dataRef != nullptr && size > 0)
+    return XPLMGetDatavf(dataRef, values.data(), 0, size);
+  else
+    return 0;
+}
+
+int DataRef::valueByteArr(std::span<char> bytes) const
+{
+#ifdef DATAREF_VALIDATION
+  checkType(xplmType_Data);
+#endif
+
+  // No size query needed - simulator copies up to the current length and returns the number of bytes
+  if(dataRef != nullptr && !bytes.empty())
+    return XPLMGetDatab(dataRef, bytes.data(), 0, static_cast<int>(bytes.size()));
+  else
+    return 0;
+}
+
 #ifdef DATAREF_VALIDATION
 void DataRef::checkType(int type) const
 {
@@ -283,18 +279,24 @@ void DataRef::checkType(int type) const
 
 int DataRef::valueIntArrSum() const
 {
+  // Avoid heap allocation for usual array sizes
+  QVarLengthArray<int, 64> values(arraySize);
+  int size = valueIntArr(std::span<int>(values.data(), static_cast<size_t>(values.size())));
+
   int sumValue = 0;
-  for(int val : valueIntArr())
-    sumValue += val;
+  for(int i = 0; i < size; i++)
+    sumValue += values.at(i);
   return sumValue;
 }
 
 float DataRef::valueFloatArrSum() const
 {
-  float sumValue = 0.f;
-  for(float val : valueFloatArr())
-    sumValue += val;
+  QVarLengthArray<float, 64> values(arraySize);
+  int size = valueFloatArr(std::span<float>(values.data(), static_cast<size_t>(values.size())));
 
+  float sumValue = 0.f;
+  for(int i = 0; i < size; i++)
+    sumValue += values.at(i);
   return sumValue;
 }
 
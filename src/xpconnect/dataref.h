@@ -21,6 +21,8 @@
 #include <QString>
 #include <QVariant>
 
+#include <span>
+
 extern "C" {
 #include "XPLMDataAccess.h"
 }
@@ -31,11 +33,8 @@ class Pos;
 }
 }
 
-class DataRef;
-
 typedef QList<float> FloatList;
 typedef QList<int> IntList;
-typedef QList<DataRef *> DataRefPtrList;
 
 /* Get full path to the acf file for the aircraft at the given index. 0 is the user aircraft. */
 QString getAircraftModelFilepath(int index);
@@ -52,25 +51,30 @@ void worldToLocal(double& x, double& y, double& z, const atools::geo::Pos& pos);
  * Hides the XPLM data ref accessor methods and provides methods for easier access than the C interface.
  * The class allows only reading of datarefs.
  * The accessor methods can optionally check if the type is valid (define DATAREF_VALIDATION).
+ *
+ * Sizes of int and float arrays are fetched once in find() and cached since they are fixed for a simulator session.
+ * Call updateArraySize() to re-validate the size, for example after an aircraft was loaded.
+ * Sizes of byte arrays are not cached since plugin provided refs like the multiplayer tail numbers can change
+ * their length at any time.
  */
 class DataRef
 {
 public:
+  DataRef()
+  {
+  }
+
   /*
    * Initializes a dataref but does not call the find method yet.
    * DataRef is not valid yet after construction.
    *
-   * @param refs Object adds itself to the list when constructed.
    * @param name Path/name of the dataref like "sim/aircraft/view/acf_tailnum".
+   * Has to be a string with static storage since it is not copied.
    */
-  DataRef(DataRefPtrList& refs, const QString& dataRefName);
-  DataRef(const QString& dataRefName);
-  DataRef();
+  void init(const char *dataRefName);
 
-  void init(DataRefPtrList& refs, const QString& dataRefName);
-  void init(const QString& dataRefName);
-
-  void setName(const QString& dataRefName)
+  /* Set name which is copied. Use for generated names. */
+  void setName(const QByteArray& dataRefName)
   {
     name = dataRefName;
   }
@@ -81,6 +85,9 @@ public:
    */
   bool find(bool warnNotFound = true);
 
+  /* Query the array size again from the simulator for int and float array types. Returns true if size has changed. */
+  bool updateArraySize();
+
   /* returns true if ref was found. */
   bool isValid() const
   {
@@ -130,7 +137,7 @@ public:
   int valueIntArrSum() const;
   float valueFloatArrSum() const;
 
-  /* Get arrays. The length of the array is checked beforeretrieving the values.*/
+  /* Get arrays. The cached length of the array is used to retrieve the values.*/
   IntList valueIntArr() const;
   FloatList valueFloatArr() const;
   QByteArray valueByteArr() const;
@@ -138,7 +145,14 @@ public:
   void valueFloatArr(FloatList& array) const;
   void valueByteArr(QByteArray& bytes) const;
 
-  /* Get array length */
+  /* Copy array into caller owned buffer without allocation. Copies up to the cached array length or the buffer size.
+   * Byte arrays are copied up to their current length or the buffer size.
+   * Returns number of values copied. */
+  int valueIntArr(std::span<int> values) const;
+  int valueFloatArr(std::span<float> values) const;
+  int valueByteArr(std::span<char> bytes) const;
+
+  /* Get cached array length. Returns 0 for invalid refs or non-array types. Byte array length is always queried. */
   int sizeIntArr() const;
   int sizeFloatArr() const;
   int sizeByteArr() const;
@@ -159,8 +173,8 @@ public:
     return dataRefType;
   }
 
-  /* Name of the dataref as passed to the constructor */
-  const QString& getName() const
+  /* Name of the dataref as passed to init() or setName() */
+  const QByteArray& getName() const
   {
     return name;
   }
@@ -173,7 +187,12 @@ private:
 
   XPLMDataRef dataRef = nullptr;
   XPLMDataTypeID dataRefType = 0;
-  QString name;
+
+  /* Cached array length as fetched in find() or updateArraySize(). Always 0 for byte arrays. */
+  int arraySize = 0;
+
+  /* Latin1 name - avoids conversion when calling find() */
+  QByteArray name;
 };
 
 #endif // LITTLEXPC_DATAREF_H
@@ -0,0 +1,257 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/datarefcapture.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <type_traits>
+
+namespace xpc {
+
+namespace {
+
+/* Write a key frame with all values every n frames */
+const quint64 KEY_FRAME_INTERVAL = 100L;
+
+/* Drop frames if the writer thread does not keep up */
+const qsizetype MAX_PENDING_BYTES = 16 * 1024 * 1024;
+
+template<typename TYPE>
+void append(QByteArray& bytes, TYPE value)
+{
+  TYPE le = qToLittleEndian(value);
+  bytes.append(reinterpret_cast<const char *>(&le), sizeof(TYPE));
+}
+
+template<typename TYPE>
+void readArray(const DataRefEntry& entry, QByteArray& value, int size)
+{
+  value.resize(size * static_cast<qsizetype>(sizeof(TYPE)));
+  std::span<TYPE> span(reinterpret_cast<TYPE *>(value.data()), static_cast<size_t>(size));
+
+  int num;
+  if constexpr(std::is_same_v<TYPE, int>)
+    num = entry.dataRef->valueIntArr(span);
+  else
+    num = entry.dataRef->valueFloatArr(span);
+  value.resize(num * static_cast<qsizetype>(sizeof(TYPE)));
+}
+
+} // namespace
+
+// =====================================================================================
+DataRefRecorder::DataRefRecorder()
+{
+}
+
+DataRefRecorder::~DataRefRecorder()
+{
+  // Writer thread is finished - close file here if not done already
+  stop();
+  flush();
+}
+
+void DataRefRecorder::start(const QString& filename, const QList<DataRefEntry>& dataRefEntries)
+{
+  stop();
+
+  entries = dataRefEntries;
+  lastValues.clear();
+  lastValues.resize(entries.size());
+
+  QByteArray header(CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE);
+  append<quint32>(header, static_cast<quint32>(entries.size()));
+  for(const DataRefEntry& entry : std::as_const(entries))
+  {
+    const QByteArray& name = entry.dataRef->getName();
+    append<quint32>(header, static_cast<quint32>(entry.type));
+    append<quint16>(header, static_cast<quint16>(name.size()));
+    header.append(name);
+  }
+
+  {
+    // File is opened by the writer thread
+    QMutexLocker locker(&pendingMutex);
+    pending.append({Command::OPEN, filename, header, 0L});
+    pendingBytes += header.size();
+  }
+
+  frameCount = 0L;
+  forceKeyFrame = true;
+  timer.start();
+  recording = true;
+
+  qInfo() << Q_FUNC_INFO << "Recording" << entries.size() << "datarefs to" << filename;
+}
+
+void DataRefRecorder::stop()
+{
+  if(!recording)
+    return;
+
+  recording = false;
+  entries.clear();
+  lastValues.clear();
+
+  // File is closed by the writer thread
+  QMutexLocker locker(&pendingMutex);
+  pending.append({Command::CLOSE, QString(), QByteArray(), frameCount});
+}
+
+void DataRefRecorder::recordFrame()
+{
+  if(!recording)
+    return;
+
+  bool keyFrame = forceKeyFrame || frameCount % KEY_FRAME_INTERVAL == 0;
+  forceKeyFrame = false;
+
+  frame.clear();
+  append<quint32>(frame, 0); // Size - filled in later
+  append<quint64>(frame, static_cast<quint64>(timer.nsecsElapsed()));
+  append<quint32>(frame, 0); // Number of values - filled in later
+  append<quint8>(frame, keyFrame ? 1 : 0);
+
+  quint32 numValues = 0;
+  for(int i = 0; i < entries.size(); i++)
+  {
+    readValue(entries.at(i), value);
+
+    QByteArray& last = lastValues[i];
+    if(keyFrame || value != last)
+    {
+      append<quint16>(frame, static_cast<quint16>(i));
+      append<quint32>(frame, static_cast<quint32>(value.size()));
+      frame.append(value);
+      last = value;
+      numValues++;
+    }
+  }
+
+  qToLittleEndian<quint32>(static_cast<quint32>(frame.size()), frame.data());
+  qToLittleEndian<quint32>(numValues, frame.data() + 4 + 8);
+
+  QMutexLocker locker(&pendingMutex);
+  if(pendingBytes + frame.size() > MAX_PENDING_BYTES)
+  {
+    // Writer does not keep up - drop frame and continue with a key frame to keep file consistent
+    qWarning() << Q_FUNC_INFO << "Dropping capture frame" << frameCount;
+    forceKeyFrame = true;
+  }
+  else
+  {
+    // Collect frames in one write command
+    if(pending.isEmpty() || pending.constLast().type != Command::WRITE)
+      pending.append({Command::WRITE, QString(), QByteArray(), 0L});
+    pending.last().bytes.append(frame);
+    pendingBytes += frame.size();
+  }
+  frameCount++;
+}
+
+void DataRefRecorder::flush()
+{
+  QList<Command> commands;
+  {
+    QMutexLocker locker(&pendingMutex);
+    if(pending.isEmpty())
+      return;
+    commands.swap(pending);
+    pendingBytes = 0;
+  }
+
+  for(const Command& command : std::as_const(commands))
+  {
+    switch(command.type)
+    {
+      case Command::OPEN:
+        closeFile(0L);
+        file = new QFile(command.filename);
+        if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+          // Frames are dropped until the next file is opened
+          qWarning() << Q_FUNC_INFO << "Cannot open" << command.filename << file->errorString();
+          delete file;
+          file = nullptr;
+          break;
+        }
+        [[fallthrough]];
+
+      case Command::WRITE:
+        if(file != nullptr && file->write(command.bytes) != command.bytes.size())
+          qWarning() << Q_FUNC_INFO << "Error writing" << file->fileName() << file->errorString();
+        break;
+
+      case Command::CLOSE:
+        closeFile(command.frames);
+        break;
+    }
+  }
+}
+
+void DataRefRecorder::closeFile(quint64 frames)
+{
+  if(file != nullptr)
+  {
+    qInfo() << Q_FUNC_INFO << "Recorded" << frames << "frames," << file->size() << "bytes to" << file->fileName();
+    file->close();
+    delete file;
+    file = nullptr;
+  }
+}
+
+void DataRefRecorder::readValue(const DataRefEntry& entry, QByteArray& value)
+{
+  switch(entry.type)
+  {
+    case xplmType_Int:
+      value.resize(sizeof(int));
+      qToLittleEndian<qint32>(entry.dataRef->valueInt(), value.data());
+      break;
+
+    case xplmType_Float:
+      value.resize(sizeof(float));
+      qToLittleEndian<float>(entry.dataRef->valueFloat(), value.data());
+      break;
+
+    case xplmType_Double:
+      value.resize(sizeof(double));
+      qToLittleEndian<double>(entry.dataRef->valueDouble(), value.data());
+      break;
+
+    case xplmType_IntArray:
+      readArray<int>(entry, value, entry.dataRef->sizeIntArr());
+      break;
+
+    case xplmType_FloatArray:
+      readArray<float>(entry, value, entry.dataRef->sizeFloatArr());
+      break;
+
+    case xplmType_Data:
+      value.resize(entry.dataRef->sizeByteArr());
+      value.resize(entry.dataRef->valueByteArr(std::span<char>(value.data(), static_cast<size_t>(value.size()))));
+      break;
+
+    default:
+      value.clear();
+  }
+}
+
+} // namespace xpc
@@ -0,0 +1,139 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_DATAREFCAPTURE_H
+#define LITTLEXPC_DATAREFCAPTURE_H
+
+#include "xpconnect/xpdatarefs.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+class QFile;
+
+namespace xpc {
+
+/*
+ * Capture file format. All numbers are little endian.
+ *
+ * Header:
+ *   char[8] magic "LXCREC01"
+ *   quint32 number of datarefs
+ *   per dataref: quint32 XPLMDataTypeID, quint16 name length, Latin1 name
+ *
+ * Frame, one per call of DataRefRecorder::recordFrame():
+ *   quint32 size of frame in bytes including this field
+ *   quint64 nanoseconds since start of recording
+ *   quint32 number of values
+ *   quint8 1 if key frame containing all values, 0 if frame contains only changed values
+ *   per value: quint16 dataref index, quint32 size in bytes, raw value
+ *
+ * Values are stored as returned by XPLM: int and float 4 bytes, double 8 bytes and arrays with
+ * the number of elements read. Array elements are in native byte order which is little endian on all
+ * supported platforms.
+ */
+static const char CAPTURE_MAGIC[] = "LXCREC01";
+static const int CAPTURE_MAGIC_SIZE = 8;
+
+/* Size of frame header: size, timestamp, number of values and key frame flag */
+static const qsizetype CAPTURE_FRAME_HEADER_SIZE = 4 + 8 + 4 + 1;
+
+/* Size of value header: index and size */
+static const qsizetype CAPTURE_VALUE_HEADER_SIZE = 2 + 4;
+
+/*
+ * Records all dataref values read by XpDataRefs into an append-only capture file.
+ * Only values which have changed since the last frame are written. A key frame with all values
+ * is written periodically to allow seeking.
+ *
+ * start(), stop() and recordFrame() run in the main thread and only queue commands and frames.
+ * flush() does all file I/O including opening and closing and is called from the shared memory writer thread.
+ *
+ * See the tests for a reader and a replay driver.
+ */
+class DataRefRecorder
+{
+public:
+  DataRefRecorder();
+  ~DataRefRecorder();
+
+  DataRefRecorder(const DataRefRecorder& other) = delete;
+  DataRefRecorder& operator=(const DataRefRecorder& other) = delete;
+
+  /* Starts recording into a new file which is opened on next flush(). Stops a running recording.
+   * Datarefs in entries have to stay valid until stop() is called. Main thread. */
+  void start(const QString& filename, const QList<DataRefEntry>& dataRefEntries);
+
+  /* Stops recording. File is closed on next flush(). Main thread. */
+  void stop();
+
+  bool isRecording() const
+  {
+    return recording;
+  }
+
+  /* Read all datarefs and add a frame with the changed values. Main thread. */
+  void recordFrame();
+
+  /* Open and close files and write buffered frames as queued. Writer thread. */
+  void flush();
+
+private:
+  /* File operation queued by the main thread */
+  struct Command
+  {
+    enum Type
+    {
+      OPEN, /* Close current file, open new one and write header in bytes */
+      WRITE, /* Write frames in bytes */
+      CLOSE /* Close current file */
+    };
+
+    Type type;
+    QString filename;
+    QByteArray bytes;
+    quint64 frames;
+  };
+
+  /* Read raw value of dataref into buffer */
+  static void readValue(const DataRefEntry& entry, QByteArray& value);
+
+  /* Close current file. Writer thread. */
+  void closeFile(quint64 frames);
+
+  QList<DataRefEntry> entries;
+
+  /* Values of last frame for delta compression and buffer for reading */
+  QList<QByteArray> lastValues;
+  QByteArray value, frame;
+
+  /* Commands and frames not processed yet and their total size. Guarded by pendingMutex. */
+  QList<Command> pending;
+  qsizetype pendingBytes = 0;
+  QMutex pendingMutex;
+
+  /* Writer thread only */
+  QFile *file = nullptr;
+
+  QElapsedTimer timer;
+  quint64 frameCount = 0L;
+  bool recording = false, forceKeyFrame = false;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_DATAREFCAPTURE_H
@@ -0,0 +1,101 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/deadreckoning.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace xpc {
+
+/* Mean earth radius */
+static const double EARTH_RADIUS_METER = 6371000.;
+
+/* Turn rates below this are extrapolated as straight line to avoid division by almost zero */
+static const double MIN_TURN_RATE_RAD_S = 1.e-5;
+
+static constexpr double toRad(double deg)
+{
+  return deg * std::numbers::pi / 180.;
+}
+
+static constexpr double toDeg(double rad)
+{
+  return rad * 180. / std::numbers::pi;
+}
+
+DeadReckoningState extrapolate(const DeadReckoningState& state, double seconds)
+{
+  DeadReckoningState result(state);
+  result.simTimeSec = state.simTimeSec + seconds;
+
+  double vEast = state.velocityEastMs, vNorth = state.velocityNorthMs;
+  double turnRad = toRad(state.turnRateDegS);
+  double east, north;
+
+  if(std::abs(turnRad) < MIN_TURN_RATE_RAD_S)
+  {
+    east = vEast * seconds;
+    north = vNorth * seconds;
+  }
+  else
+  {
+    // Integrate velocity rotating clockwise with constant rate - heading is measured clockwise from north
+    double angle = turnRad * seconds;
+    double sinA = std::sin(angle), cosA = std::cos(angle);
+    east = (vEast * sinA + vNorth * (1. - cosA)) / turnRad;
+    north = (vNorth * sinA - vEast * (1. - cosA)) / turnRad;
+
+    result.velocityEastMs = static_cast<float>(vEast * cosA + vNorth * sinA);
+    result.velocityNorthMs = static_cast<float>(vNorth * cosA - vEast * sinA);
+  }
+
+  result.latDeg = state.latDeg + toDeg(north / EARTH_RADIUS_METER);
+  result.lonDeg = state.lonDeg + toDeg(east / (EARTH_RADIUS_METER * std::max(std::cos(toRad(state.latDeg)), 1.e-6)));
+  result.altMeter = state.altMeter + state.velocityUpMs * seconds;
+
+  // Crossing a pole continues on the opposite meridian - north and east directions are reversed there
+  if(result.latDeg > 90. || result.latDeg < -90.)
+  {
+    result.latDeg = (result.latDeg > 0. ? 180. : -180.) - result.latDeg;
+    result.lonDeg += 180.;
+    result.velocityEastMs = -result.velocityEastMs;
+    result.velocityNorthMs = -result.velocityNorthMs;
+  }
+
+  // Normalize longitude after crossing the anti-meridian
+  result.lonDeg = std::remainder(result.lonDeg, 360.);
+
+  return result;
+}
+
+double distanceMeter(const DeadReckoningState& state1, const DeadReckoningState& state2)
+{
+  double lonDiff = state2.lonDeg - state1.lonDeg;
+  if(lonDiff > 180.)
+    lonDiff -= 360.;
+  else if(lonDiff < -180.)
+    lonDiff += 360.;
+
+  double north = toRad(state2.latDeg - state1.latDeg) * EARTH_RADIUS_METER;
+  double east = toRad(lonDiff) * EARTH_RADIUS_METER * std::cos(toRad((state1.latDeg + state2.latDeg) / 2.));
+  double up = state2.altMeter - state1.altMeter;
+  return std::sqrt(north * north + east * east + up * up);
+}
+
+} // namespace xpc
@@ -0,0 +1,66 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_DEADRECKONING_H
+#define LITTLEXPC_DEADRECKONING_H
+
+#include <QtGlobal>
+
+namespace xpc {
+
+/*
+ * Property ids added to the properties of the user and AI aircraft to allow clients to extrapolate
+ * positions between updates. Range is chosen well above the ids used by atools.
+ * All values are float except PROP_XPC_SIM_TIME_SEC which is double.
+ */
+enum DeadReckoningProp
+{
+  PROP_XPC_VELOCITY_EAST_MS = 0x5800, /* Velocity in meter per second in the local tangent plane */
+  PROP_XPC_VELOCITY_NORTH_MS,
+  PROP_XPC_VELOCITY_UP_MS,
+  PROP_XPC_TURN_RATE_DEG_S, /* Rate of heading change. Positive is a right turn. */
+  PROP_XPC_SIM_TIME_SEC /* Simulator running time of the sample in seconds */
+};
+
+/* Kinematic state of one aircraft as needed for dead reckoning */
+struct DeadReckoningState
+{
+  double latDeg = 0., lonDeg = 0., altMeter = 0.;
+  float velocityEastMs = 0.f, velocityNorthMs = 0.f, velocityUpMs = 0.f, turnRateDegS = 0.f;
+  double simTimeSec = 0.;
+};
+
+/*
+ * Reference extrapolator for clients. Moves the state by the given time assuming constant speed,
+ * vertical speed and turn rate. Velocity is rotated according to the turn.
+ * Uses a spherical earth which is sufficient for the short intervals between updates.
+ * Longitude is normalized to -180 to 180 and crossing a pole continues on the opposite meridian.
+ */
+DeadReckoningState extrapolate(const DeadReckoningState& state, double seconds);
+
+/* Extrapolate to the given simulator time */
+inline DeadReckoningState extrapolateTo(const DeadReckoningState& state, double simTimeSec)
+{
+  return extrapolate(state, simTimeSec - state.simTimeSec);
+}
+
+/* Distance between two states in meter including altitude. Only accurate for short distances. */
+double distanceMeter(const DeadReckoningState& state1, const DeadReckoningState& state2);
+
+} // namespace xpc
+
+#endif // LITTLEXPC_DEADRECKONING_H
@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/flightloopscheduler.h"
+
+#include "xpconnect/perfcounters.h"
+
+namespace xpc {
+
+/* Weight of a new value in the frame period moving average */
+static const float FRAME_AVERAGE_FACTOR = 0.1f;
+
+FlightLoopScheduler::FlightLoopScheduler(PerfCounters *perfCounters)
+  : counters(perfCounters)
+{
+}
+
+float FlightLoopScheduler::schedule(qint64 periodNs, float elapsedSinceLastCallSec, int flightLoopCounter)
+{
+  qint64 nowNs = PerfCounters::monotonicNs();
+
+  // Update frame period from number of frames since last call
+  int frames = flightLoopCounter - lastCounter;
+  if(lastCounter != -1 && frames > 0 && elapsedSinceLastCallSec > 0.f)
+    framePeriodSec += (elapsedSinceLastCallSec / static_cast<float>(frames) - framePeriodSec) * FRAME_AVERAGE_FACTOR;
+  lastCounter = flightLoopCounter;
+
+  if(nextTargetNs == 0L || periodNs != lastPeriodNs)
+  {
+    // First call or period changed in menu or by governor - start new phase
+    nextTargetNs = nowNs;
+    lastPeriodNs = periodNs;
+  }
+  else if(lastCallNs > 0L)
+    counters->addSchedulePeriod(nowNs - lastCallNs, periodNs);
+  lastCallNs = nowNs;
+
+  // Advance by exact periods to avoid drift
+  nextTargetNs += periodNs;
+  if(nextTargetNs <= nowNs)
+    // Fell behind by more than one period - skip missed periods but keep phase
+    nextTargetNs += ((nowNs - nextTargetNs) / periodNs + 1) * periodNs;
+
+  // Callback is called on the first frame after the interval - aim half a frame early to hit the closest frame
+  float remainingSec = static_cast<float>(nextTargetNs - nowNs) / 1.e9f - framePeriodSec / 2.f;
+
+  // Negative value means number of frames
+  return remainingSec < framePeriodSec ? -1.f : remainingSec;
+}
+
+} // namespace xpc
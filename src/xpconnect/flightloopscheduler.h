@@ -0,0 +1,64 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_FLIGHTLOOPSCHEDULER_H
+#define LITTLEXPC_FLIGHTLOOPSCHEDULER_H
+
+#include <QtGlobal>
+
+namespace xpc {
+
+class PerfCounters;
+
+/*
+ * Phase locked scheduling for the fetch flight loop.
+ *
+ * X-Plane calls a flight loop on the first frame after the requested interval. Returning the plain
+ * fetch interval lets the error of each call add up and the period drifts and beats against the frame rate.
+ * This class keeps an absolute target time advanced by exact periods and returns the remaining time
+ * to the next target minus half a frame. This way the callback fires on the frame closest to the target.
+ * Returns -1 (next frame) if the target is less than one frame away.
+ *
+ * Achieved period and jitter are recorded in PerfCounters.
+ *
+ * Run in main thread only.
+ */
+class FlightLoopScheduler
+{
+public:
+  explicit FlightLoopScheduler(PerfCounters *perfCounters);
+
+  FlightLoopScheduler(const FlightLoopScheduler& other) = delete;
+  FlightLoopScheduler& operator=(const FlightLoopScheduler& other) = delete;
+
+  /* Call once in each flight loop callback with the desired period. Parameters are as passed into the
+   * callback. Returns the value to be returned by the callback. */
+  float schedule(qint64 periodNs, float elapsedSinceLastCallSec, int flightLoopCounter);
+
+private:
+  PerfCounters *counters;
+
+  qint64 nextTargetNs = 0L, lastCallNs = 0L, lastPeriodNs = 0L;
+  int lastCounter = -1;
+
+  /* Moving average of the simulator frame period */
+  float framePeriodSec = 1.f / 30.f;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_FLIGHTLOOPSCHEDULER_H
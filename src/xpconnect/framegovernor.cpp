@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/framegovernor.h"
+
+#include "settings/settings.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace lxc {
+/* key names for atools::settings */
+static const QLatin1String SETTINGS_OPTIONS_FRAME_GOVERNOR("Options/FrameGovernor");
+static const QLatin1String SETTINGS_OPTIONS_FRAME_BUDGET_PERCENT("Options/FrameBudgetPercent");
+}
+
+namespace xpc {
+
+/* Weight of a new value in the moving average */
+static const float LOAD_AVERAGE_FACTOR = 0.2f;
+
+/* Number of consecutive callbacks over budget before degrading one level */
+static const int DEGRADE_COUNT = 5;
+
+/* Number of consecutive callbacks below half of the budget before recovering one level */
+static const int RECOVER_COUNT = 50;
+
+FrameGovernor::FrameGovernor()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  enabled = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_FRAME_GOVERNOR, true).toBool();
+  budgetPercent = std::max(settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_FRAME_BUDGET_PERCENT, 5.).toFloat(), 0.1f);
+  qInfo() << Q_FUNC_INFO << "enabled" << enabled << "budget percent" << budgetPercent;
+}
+
+bool FrameGovernor::update(qint64 costNs, float elapsedSinceLastCallSec, int flightLoopCounter)
+{
+  int frames = flightLoopCounter - lastCounter;
+  bool firstCall = lastCounter == -1;
+  lastCounter = flightLoopCounter;
+
+  if(!enabled || firstCall || frames <= 0 || elapsedSinceLastCallSec <= 0.f)
+    return false;
+
+  // Average frame period since last call - the callback cost falls into one of these frames
+  float framePeriodNs = elapsedSinceLastCallSec / static_cast<float>(frames) * 1.e9f;
+  float percent = static_cast<float>(costNs) / framePeriodNs * 100.f;
+  loadPercent += (percent - loadPercent) * LOAD_AVERAGE_FACTOR;
+
+  GovernorLevel oldLevel = level;
+  if(loadPercent > budgetPercent)
+  {
+    underBudgetCount = 0;
+    if(++overBudgetCount >= DEGRADE_COUNT && level < GOVERNOR_MAX)
+    {
+      level = static_cast<GovernorLevel>(level + 1);
+      overBudgetCount = 0;
+    }
+  }
+  else if(loadPercent < budgetPercent / 2.f)
+  {
+    overBudgetCount = 0;
+    if(++underBudgetCount >= RECOVER_COUNT && level > GOVERNOR_NORMAL)
+    {
+      level = static_cast<GovernorLevel>(level - 1);
+      underBudgetCount = 0;
+    }
+  }
+  else
+    overBudgetCount = underBudgetCount = 0;
+
+  if(level != oldLevel)
+  {
+    qInfo() << Q_FUNC_INFO << "Frame governor changed to" << getLevelText() << "load percent" << loadPercent
+            << "budget percent" << budgetPercent << "frame period ms" << framePeriodNs / 1.e6f;
+    return true;
+  }
+  return false;
+}
+
+QString FrameGovernor::getLevelText() const
+{
+  switch(level)
+  {
+    case GOVERNOR_NORMAL:
+      return QStringLiteral("Normal");
+
+    case GOVERNOR_NO_AI_INFO:
+      return QStringLiteral("No AI Aircraft Information");
+
+    case GOVERNOR_AI_HALF_RATE:
+      return QStringLiteral("Reduced AI Rate");
+
+    case GOVERNOR_STRETCHED:
+      return QStringLiteral("Reduced Fetch Rate");
+  }
+  return QString();
+}
+
+} // namespace xpc
@@ -0,0 +1,98 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_FRAMEGOVERNOR_H
+#define LITTLEXPC_FRAMEGOVERNOR_H
+
+#include <QtGlobal>
+
+class QString;
+
+namespace xpc {
+
+/* Degradation levels. Each level includes the ones before. */
+enum GovernorLevel
+{
+  GOVERNOR_NORMAL,
+  GOVERNOR_NO_AI_INFO, /* Do not load aircraft files for AI */
+  GOVERNOR_AI_HALF_RATE, /* Update AI only every second fetch */
+  GOVERNOR_STRETCHED, /* Double the fetch interval */
+  GOVERNOR_MAX = GOVERNOR_STRETCHED
+};
+
+/*
+ * Watches the cost of the flight loop callback relative to the simulator frame period and degrades
+ * plugin work step by step if the cost exceeds the configured share of a frame. Recovers one level at a
+ * time once there is enough headroom again.
+ *
+ * Frame period is calculated from the flight loop counter and the elapsed time between callbacks.
+ *
+ * Run in main thread only.
+ */
+class FrameGovernor
+{
+public:
+  /* Reads budget and enabled state from settings */
+  FrameGovernor();
+
+  FrameGovernor(const FrameGovernor& other) = delete;
+  FrameGovernor& operator=(const FrameGovernor& other) = delete;
+
+  /* Add cost of one callback. Parameters are as passed into the flight loop callback.
+   * Returns true if the level has changed. */
+  bool update(qint64 costNs, float elapsedSinceLastCallSec, int flightLoopCounter);
+
+  GovernorLevel getLevel() const
+  {
+    return level;
+  }
+
+  bool isFetchAiInfo() const
+  {
+    return level < GOVERNOR_NO_AI_INFO;
+  }
+
+  /* Fetch AI every n-th update */
+  int getAiUpdateInterval() const
+  {
+    return level >= GOVERNOR_AI_HALF_RATE ? 2 : 1;
+  }
+
+  /* Multiply fetch interval with this */
+  float getIntervalFactor() const
+  {
+    return level >= GOVERNOR_STRETCHED ? 2.f : 1.f;
+  }
+
+  /* Text for menu and log */
+  QString getLevelText() const;
+
+private:
+  GovernorLevel level = GOVERNOR_NORMAL;
+
+  /* Share of frame time in percent allowed for the callback */
+  float budgetPercent = 5.f;
+  bool enabled = true;
+
+  /* Moving average of cost relative to frame period in percent */
+  float loadPercent = 0.f;
+  int lastCounter = -1, overBudgetCount = 0, underBudgetCount = 0;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_FRAMEGOVERNOR_H
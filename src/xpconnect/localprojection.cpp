@@ -0,0 +1,179 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/localprojection.h"
+
+#include "geo/pos.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+extern "C" {
+#include "XPLMGraphics.h"
+}
+
+namespace xpc {
+
+/* Earth radius of X-Plane used if the radius cannot be derived from XPLMLocalToWorld() */
+static const double EARTH_RADIUS_METER = 6378145.;
+
+/* Radius derived from XPLMLocalToWorld() is only accepted within these limits */
+static const double MIN_EARTH_RADIUS_METER = 6300000., MAX_EARTH_RADIUS_METER = 6400000.;
+
+/* Distance of the point east of the origin used to derive the earth radius */
+static const double RADIUS_PROBE_METER = 10000.;
+
+/* Ranges tested on refresh from largest to smallest */
+static const std::array<double, 7> TEST_RANGES_METER = {LocalProjection::MAX_RANGE_METER, 50000., 20000., 10000., 5000., 2000., 1000.};
+
+static constexpr double toRad(double deg)
+{
+  return deg * std::numbers::pi / 180.;
+}
+
+static constexpr double toDeg(double rad)
+{
+  return rad * 180. / std::numbers::pi;
+}
+
+/* Distance between two positions in meter using a local approximation which is sufficient for small distances */
+static double distanceMeter(double latY1, double lonX1, double alt1, double latY2, double lonX2, double alt2)
+{
+  double lonDiff = std::remainder(lonX2 - lonX1, 360.);
+  double north = toRad(latY2 - latY1) * EARTH_RADIUS_METER;
+  double east = toRad(lonDiff) * EARTH_RADIUS_METER * std::cos(toRad(latY1));
+  return std::sqrt(north * north + east * east + (alt2 - alt1) * (alt2 - alt1));
+}
+
+/* Unit vector in earth centered coordinates */
+static std::array<double, 3> unitVector(double latY, double lonX)
+{
+  double latRad = toRad(latY), lonRad = toRad(lonX);
+  return {std::cos(latRad) * std::cos(lonRad), std::cos(latRad) * std::sin(lonRad), std::sin(latRad)};
+}
+
+LocalProjection::LocalProjection(bool verboseLogging)
+  : verbose(verboseLogging), earthRadiusMeter(EARTH_RADIUS_METER)
+{
+}
+
+void LocalProjection::update(float latRef, float lonRef)
+{
+  if(initialized && latRef == lastLatRef && lonRef == lastLonRef)
+    return;
+
+  initialized = true;
+  lastLatRef = latRef;
+  lastLonRef = lonRef;
+
+  // Get origin from X-Plane instead of using the reference values to include altitude
+  double latY, lonX;
+  XPLMLocalToWorld(0., 0., 0., &latY, &lonX, &originAltMeter);
+
+  double latRad = toRad(latY), lonRad = toRad(lonX);
+  double sinLat = std::sin(latRad), cosLat = std::cos(latRad), sinLon = std::sin(lonRad), cosLon = std::cos(lonRad);
+  up = {cosLat * cosLon, cosLat * sinLon, sinLat};
+  east = {-sinLon, cosLon, 0.};
+  north = {-sinLat * cosLon, -sinLat * sinLon, cosLat};
+
+  // Derive radius from the angle between origin and a point on the tangent plane east of it
+  double probeLatY, probeLonX, probeAlt;
+  XPLMLocalToWorld(RADIUS_PROBE_METER, 0., 0., &probeLatY, &probeLonX, &probeAlt);
+  std::array<double, 3> probe = unitVector(probeLatY, probeLonX);
+  std::array<double, 3> cross = {up[1] * probe[2] - up[2] * probe[1], up[2] * probe[0] - up[0] * probe[2],
+                                 up[0] * probe[1] - up[1] * probe[0]};
+  double angle = std::atan2(std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]),
+                            up[0] * probe[0] + up[1] * probe[1] + up[2] * probe[2]);
+  double radius = angle > 0. ? RADIUS_PROBE_METER / std::tan(angle) - originAltMeter : 0.;
+  if(radius >= MIN_EARTH_RADIUS_METER && radius <= MAX_EARTH_RADIUS_METER)
+    earthRadiusMeter = radius;
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Unexpected earth radius" << radius << "using" << EARTH_RADIUS_METER;
+    earthRadiusMeter = EARTH_RADIUS_METER;
+  }
+
+  // Find largest range where all test points on the circle and above are within error
+  validRangeMeter = 0.;
+  for(double range : TEST_RANGES_METER)
+  {
+    double maxError = 0.;
+    for(int i = 0; i < 8; i++)
+    {
+      double angle = i * std::numbers::pi / 4.;
+      double x = range * std::sin(angle), z = range * std::cos(angle);
+      maxError = std::max({maxError, errorMeter(x, 0., z), errorMeter(x, 10000., z)});
+    }
+
+    if(maxError < MAX_ERROR_METER)
+    {
+      validRangeMeter = range;
+      break;
+    }
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Local origin moved. Reference" << latRef << lonRef << "origin" << latY << lonX << originAltMeter
+             << "earth radius" << earthRadiusMeter << "valid range meter" << validRangeMeter;
+}
+
+void LocalProjection::project(double x, double y, double z, double& latY, double& lonX, double& alt) const
+{
+  // z points south
+  double upMeter = earthRadiusMeter + originAltMeter + y;
+  double vx = upMeter * up[0] + x * east[0] - z * north[0];
+  double vy = upMeter * up[1] + x * east[1] - z * north[1];
+  double vz = upMeter * up[2] + x * east[2] - z * north[2];
+
+  double radius = std::sqrt(vx * vx + vy * vy + vz * vz);
+  latY = toDeg(std::asin(vz / radius));
+  lonX = toDeg(std::atan2(vy, vx));
+  alt = radius - earthRadiusMeter;
+}
+
+atools::geo::Pos LocalProjection::localToWorld(double x, double y, double z)
+{
+  double latY, lonX, alt;
+  if(x * x + z * z <= validRangeMeter * validRangeMeter)
+    project(x, y, z, latY, lonX, alt);
+  else
+  {
+    XPLMLocalToWorld(x, y, z, &latY, &lonX, &alt);
+    numFallback++;
+  }
+  return atools::geo::Pos(lonX, latY, alt);
+}
+
+void LocalProjection::localToWorld(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                                   std::span<atools::geo::Pos> positions)
+{
+  for(size_t i = 0; i < positions.size(); i++)
+    positions[i] = localToWorld(x[i], y[i], z[i]);
+}
+
+double LocalProjection::errorMeter(double x, double y, double z) const
+{
+  double latY, lonX, alt, latYXp, lonXXp, altXp;
+  project(x, y, z, latY, lonX, alt);
+  XPLMLocalToWorld(x, y, z, &latYXp, &lonXXp, &altXp);
+  return distanceMeter(latY, lonX, alt, latYXp, lonXXp, altXp);
+}
+
+} // namespace xpc
@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_LOCALPROJECTION_H
+#define LITTLEXPC_LOCALPROJECTION_H
+
+#include <array>
+#include <span>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+}
+
+namespace xpc {
+
+/*
+ * Converts local OpenGL coordinates to world coordinates without calling XPLMLocalToWorld() for each object.
+ *
+ * The local coordinate system is treated as a plane tangent to a spherical earth at the origin with x pointing east,
+ * y up and z south. The origin, the axes and the earth radius used by X-Plane are calculated once whenever X-Plane
+ * moves the origin which is detected by a change of the reference latitude or longitude.
+ *
+ * The range around the origin where the calculation is used is validated against XPLMLocalToWorld() on
+ * refresh. It is the largest tested range where the error is below MAX_ERROR_METER. Points outside of this range
+ * are converted using XPLMLocalToWorld().
+ *
+ * Run in main thread only.
+ */
+class LocalProjection
+{
+public:
+  /* Maximum allowed difference between calculation and XPLMLocalToWorld() */
+  static constexpr double MAX_ERROR_METER = 2.;
+
+  /* Largest range around the origin which is validated */
+  static constexpr double MAX_RANGE_METER = 100000.;
+
+  explicit LocalProjection(bool verboseLogging);
+
+  LocalProjection(const LocalProjection& other) = delete;
+  LocalProjection& operator=(const LocalProjection& other) = delete;
+
+  /* Recalculates origin, axes and validated range if the reference coordinates have changed.
+   * Call once per update before converting. */
+  void update(float latRef, float lonRef);
+
+  /* Convert local coordinates in meter to position with altitude in meter */
+  atools::geo::Pos localToWorld(double x, double y, double z);
+
+  /* Convert arrays of local coordinates. Only the number of positions is converted. Other spans have to be at least as long. */
+  void localToWorld(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                    std::span<atools::geo::Pos> positions);
+
+  /* Distance in meter between calculation and XPLMLocalToWorld() for a local point. Used for validation on refresh. */
+  double errorMeter(double x, double y, double z) const;
+
+  /* Radius around origin where the calculation is used. Zero if only XPLMLocalToWorld() is used. */
+  double getValidRangeMeter() const
+  {
+    return validRangeMeter;
+  }
+
+  /* Earth radius derived from XPLMLocalToWorld() on last refresh */
+  double getEarthRadiusMeter() const
+  {
+    return earthRadiusMeter;
+  }
+
+  /* Number of conversions done using XPLMLocalToWorld() since start */
+  int getNumFallback() const
+  {
+    return numFallback;
+  }
+
+private:
+  /* Calculate world coordinates in degrees and meter */
+  void project(double x, double y, double z, double& latY, double& lonX, double& alt) const;
+
+  bool verbose = false, initialized = false;
+  float lastLatRef = 0.f, lastLonRef = 0.f;
+  double originAltMeter = 0., validRangeMeter = 0., earthRadiusMeter;
+  int numFallback = 0;
+
+  /* Unit vectors of local axes in earth centered coordinates */
+  std::array<double, 3> up, east, north;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_LOCALPROJECTION_H
@@ -0,0 +1,218 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/metadatasegment.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "settings/settings.h"
+
+#include <QDataStream>
+#include <QDebug>
+
+#include <atomic>
+#include <cstring>
+
+namespace lxc {
+/* key names for atools::settings */
+static const QLatin1String SETTINGS_OPTIONS_METADATA_SEGMENT("Options/MetadataSegment");
+static const QLatin1String SETTINGS_OPTIONS_METADATA_BLANK_STRINGS("Options/MetadataBlankStrings");
+}
+
+namespace xpc {
+
+MetadataSegment *MetadataSegment::createFromSettings(bool verboseLogging)
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  bool enabled = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_METADATA_SEGMENT, true).toBool();
+  bool blank = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_METADATA_BLANK_STRINGS, false).toBool();
+
+  if(enabled)
+  {
+    qInfo() << Q_FUNC_INFO << "Metadata segment enabled. Blank strings" << blank;
+    return new MetadataSegment(verboseLogging, blank);
+  }
+  return nullptr;
+}
+
+MetadataSegment::MetadataSegment(bool verboseLogging, bool blankStringsParam)
+  : verbose(verboseLogging), blankStrings(blankStringsParam)
+{
+  sharedMemory.setKey(METADATA_SEGMENT_KEY);
+}
+
+MetadataSegment::~MetadataSegment()
+{
+  close();
+}
+
+bool MetadataSegment::open()
+{
+  if(isOpen())
+    return true;
+
+  if(!sharedMemory.create(METADATA_SEGMENT_SIZE, QSharedMemory::ReadWrite))
+  {
+    // Left over from a crashed session or a client created it already
+    if(!sharedMemory.attach(QSharedMemory::ReadWrite))
+    {
+      qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot create or attach" << sharedMemory.key()
+                 << sharedMemory.errorString();
+      return false;
+    }
+
+    if(sharedMemory.size() < METADATA_SEGMENT_SIZE)
+    {
+      qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Segment too small" << sharedMemory.size() << "<" << METADATA_SEGMENT_SIZE;
+      sharedMemory.detach();
+      return false;
+    }
+  }
+
+  // Lock once to initialize - table is only written without lock
+  if(!sharedMemory.lock())
+  {
+    qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot lock" << sharedMemory.key() << sharedMemory.errorString();
+    sharedMemory.detach();
+    return false;
+  }
+
+  header = static_cast<Header *>(sharedMemory.data());
+  data = reinterpret_cast<char *>(header + 1);
+  std::memset(header, 0, sizeof(Header));
+  header->magic = METADATA_SEGMENT_MAGIC;
+  header->format = METADATA_SEGMENT_FORMAT;
+  header->version = version;
+  sharedMemory.unlock();
+
+  // Write full table on next update
+  entries.clear();
+
+  qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Opened" << sharedMemory.key() << "native" << sharedMemory.nativeKey();
+  return true;
+}
+
+void MetadataSegment::close()
+{
+  if(!isOpen())
+    return;
+
+  header = nullptr;
+  data = nullptr;
+  if(!sharedMemory.detach())
+    qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot detach" << sharedMemory.errorString();
+  else
+    qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Closed" << sharedMemory.key();
+}
+
+bool MetadataSegment::update(const atools::fs::sc::SimConnectData& simData)
+{
+  if(!isOpen())
+    return false;
+
+  generation++;
+  bool changed = false;
+  qsizetype numSeen = 0;
+
+  // Strings are implicitly shared - no allocation unless aircraft are added
+  const atools::fs::sc::SimConnectUserAircraft& user = simData.getUserAircraftConst();
+  if(user.isValid())
+  {
+    changed |= updateEntry(user.getObjectId(), {user.getAirplaneTitle(), user.getAirplaneModel(), user.getAirplaneRegistration(),
+                                                user.getAirplaneType(), generation});
+    numSeen++;
+  }
+
+  for(const atools::fs::sc::SimConnectAircraft& aircraft : simData.getAiAircraftConst())
+  {
+    changed |= updateEntry(aircraft.getObjectId(), {aircraft.getAirplaneTitle(), aircraft.getAirplaneModel(),
+                                                    aircraft.getAirplaneRegistration(), aircraft.getAirplaneType(), generation});
+    numSeen++;
+  }
+
+  // Remove aircraft which are gone - table cannot be larger than the number seen otherwise
+  if(numSeen != entries.size())
+  {
+    for(auto it = entries.begin(); it != entries.end();)
+    {
+      if(it->generation != generation)
+      {
+        it = entries.erase(it);
+        changed = true;
+      }
+      else
+        ++it;
+    }
+  }
+
+  if(changed)
+    write();
+  return changed;
+}
+
+bool MetadataSegment::updateEntry(quint32 objectId, Entry&& entry)
+{
+  auto it = entries.find(objectId);
+  if(it == entries.end())
+  {
+    entries.insert(objectId, std::move(entry));
+    return true;
+  }
+  else if(*it == entry)
+  {
+    it->generation = entry.generation;
+    return false;
+  }
+  else
+  {
+    *it = std::move(entry);
+    return true;
+  }
+}
+
+void MetadataSegment::write()
+{
+  QDataStream stream(&bytes, QIODevice::WriteOnly);
+  stream << static_cast<quint32>(entries.size());
+  for(auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    stream << it.key() << it->title << it->model << it->registration << it->type;
+
+  if(bytes.size() > METADATA_SEGMENT_SIZE - static_cast<qsizetype>(sizeof(Header)))
+  {
+    qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Table too large" << bytes.size() << "entries" << entries.size();
+    return;
+  }
+
+  // Sequence lock - odd value tells readers that the table is being changed
+  std::atomic_ref<quint32> sequence(header->sequence);
+  quint32 seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(data, bytes.constData(), static_cast<size_t>(bytes.size()));
+  header->size = static_cast<quint32>(bytes.size());
+  header->version = ++version;
+
+  sequence.store(seq + 2, std::memory_order_release);
+
+  publishedVersion.store(version, std::memory_order_relaxed);
+  publishedSize.store(static_cast<int>(entries.size()), std::memory_order_relaxed);
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Version" << version << "entries" << entries.size() << "bytes" << bytes.size();
+}
+
+} // namespace xpc
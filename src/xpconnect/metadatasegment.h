@@ -0,0 +1,158 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_METADATASEGMENT_H
+#define LITTLEXPC_METADATASEGMENT_H
+
+#include <QHash>
+#include <QSharedMemory>
+
+#include <atomic>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+namespace xpc {
+
+/* Key of the shared memory segment for aircraft metadata */
+static const QLatin1String METADATA_SEGMENT_KEY("LittleXpconnectMetadata");
+
+/* Header magic "LXMD" and format version */
+static const quint32 METADATA_SEGMENT_MAGIC = 0x4c584d44;
+static const quint32 METADATA_SEGMENT_FORMAT = 1;
+
+/* Size of the segment including header */
+static const qsizetype METADATA_SEGMENT_SIZE = 1024 * 1024;
+
+/*
+ * Publishes the strings of the user and all AI aircraft which rarely change into a separate shared memory segment.
+ * The table is only written if an aircraft appears, disappears or changes its strings. Clients can compare the
+ * version counter and read the table only if it has changed.
+ *
+ * Segment layout. Header in native byte order:
+ *   quint32 magic METADATA_SEGMENT_MAGIC
+ *   quint32 format METADATA_SEGMENT_FORMAT
+ *   quint32 sequence - odd while the table is written
+ *   quint32 version - incremented on each change of the table
+ *   quint32 size of table in bytes
+ * Table as written by QDataStream in big endian:
+ *   quint32 number of entries
+ *   for each entry: quint32 object id, QString title, model, registration and type
+ *
+ * Header and table are protected by a sequence lock like xpc::UserStream.
+ *
+ * Optionally blanks the strings in the main segment which reduces the size of each update.
+ * Only useful for clients which read this segment.
+ *
+ * Run in writer thread only except getVersion() and size().
+ */
+class MetadataSegment
+{
+public:
+  /* Returns a new segment if enabled in settings or null otherwise */
+  static MetadataSegment *createFromSettings(bool verboseLogging);
+
+  MetadataSegment(bool verboseLogging, bool blankStringsParam);
+  ~MetadataSegment();
+
+  MetadataSegment(const MetadataSegment& other) = delete;
+  MetadataSegment& operator=(const MetadataSegment& other) = delete;
+
+  /* Create or attach the segment. Returns false on error. */
+  bool open();
+
+  /* Detach from segment */
+  void close();
+
+  bool isOpen() const
+  {
+    return header != nullptr;
+  }
+
+  /* Compare strings of user and AI aircraft with the table and write the table if anything has changed.
+   * Returns true if written. */
+  bool update(const atools::fs::sc::SimConnectData& data);
+
+  /* Strings are to be removed from the main segment */
+  bool isBlankStrings() const
+  {
+    return blankStrings && isOpen();
+  }
+
+  /* Table version which was last written. Can be called from any thread. */
+  quint32 getVersion() const
+  {
+    return publishedVersion.load(std::memory_order_relaxed);
+  }
+
+  /* Number of aircraft in table as last written. Can be called from any thread. */
+  int size() const
+  {
+    return publishedSize.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Header
+  {
+    quint32 magic, format, sequence, version, size;
+  };
+
+  struct Entry
+  {
+    QString title, model, registration, type;
+
+    /* Last update where the aircraft was present */
+    quint32 generation = 0;
+
+    bool operator==(const Entry& other) const
+    {
+      return title == other.title && model == other.model && registration == other.registration && type == other.type;
+    }
+  };
+
+  /* Update or insert entry and return true if changed */
+  bool updateEntry(quint32 objectId, Entry&& entry);
+
+  /* Serialize table and copy into segment */
+  void write();
+
+  QSharedMemory sharedMemory;
+  Header *header = nullptr;
+  char *data = nullptr;
+
+  /* Key is object id */
+  QHash<quint32, Entry> entries;
+
+  /* Buffer for the serialized table - reused */
+  QByteArray bytes;
+
+  quint32 version = 0, generation = 0;
+  bool verbose = false, blankStrings = false;
+
+  /* Copies of version and table size for other threads */
+  std::atomic<quint32> publishedVersion = 0;
+  std::atomic<int> publishedSize = 0;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_METADATASEGMENT_H
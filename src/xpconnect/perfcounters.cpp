@@ -0,0 +1,260 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/perfcounters.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace xpc {
+
+/* Weight of a new value in the moving average - roughly the last 20 values */
+static const float AVERAGE_FACTOR = 0.05f;
+
+/* Names used in JSON report. Order has to match PerfStage. */
+static const char *STAGE_NAMES[STAGE_COUNT] = {"fetch", "serialize", "write", "acf_read", "user_stream"};
+
+/* Names used in JSON report. Order has to match LatencyStage. */
+static const char *LATENCY_NAMES[LATENCY_COUNT] = {"capture_to_publish", "publish_to_serialized", "serialized_to_written",
+                                                   "capture_to_written"};
+
+/* Percentiles in JSON report */
+static const double PERCENTILES[] = {50., 90., 99.};
+
+void PerfCounters::addFetchTimeNs(qint64 nanoseconds)
+{
+  updateTime(nanoseconds, &fetchTimeLastMs, fetchTimeAvgMs, &fetchTimeMaxMs);
+  addStage(STAGE_FETCH, nanoseconds);
+}
+
+void PerfCounters::addSerializeTimeNs(qint64 nanoseconds, qint64 bytes)
+{
+  updateTime(nanoseconds, &serializeTimeLastMs, serializeTimeAvgMs, nullptr);
+  addStage(STAGE_SERIALIZE, nanoseconds, bytes);
+}
+
+void PerfCounters::addUserStreamTimeNs(qint64 nanoseconds, qint64 bytes)
+{
+  updateTime(nanoseconds, nullptr, userStreamTimeAvgMs, &userStreamTimeMaxMs);
+  addStage(STAGE_USER_STREAM, nanoseconds, bytes);
+  if(nanoseconds > USER_STREAM_BUDGET_NS)
+    userStreamOverBudget.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfCounters::addDeadReckoningError(double meter)
+{
+  updateValue(static_cast<float>(meter), nullptr, deadReckoningErrorAvgMeter, &deadReckoningErrorMaxMeter);
+}
+
+void PerfCounters::addSchedulePeriod(qint64 periodNs, qint64 targetPeriodNs)
+{
+  updateTime(periodNs, nullptr, schedulePeriodAvgMs, nullptr);
+  updateTime(std::abs(periodNs - targetPeriodNs), nullptr, scheduleJitterAvgMs, &scheduleJitterMaxMs);
+}
+
+void PerfCounters::addBytesWritten(qint64 bytes)
+{
+  bytesWrittenLast.store(bytes, std::memory_order_relaxed);
+  bytesWrittenTotal.fetch_add(bytes, std::memory_order_relaxed);
+  if(bytes > peakBytesWritten.load(std::memory_order_relaxed))
+    peakBytesWritten.store(bytes, std::memory_order_relaxed);
+}
+
+void PerfCounters::addStage(PerfStage stage, qint64 nanoseconds, qint64 bytes)
+{
+  Stage& s = stages[stage];
+  quint64 ns = static_cast<quint64>(std::max(nanoseconds, 0LL));
+  s.count.fetch_add(1, std::memory_order_relaxed);
+  s.totalNs.fetch_add(ns, std::memory_order_relaxed);
+  s.totalBytes.fetch_add(static_cast<quint64>(std::max(bytes, 0LL)), std::memory_order_relaxed);
+  updateMax(s.maxNs, ns);
+}
+
+void PerfCounters::addLatency(const LatencyTimestamps& timestamps)
+{
+  const qint64 intervals[LATENCY_COUNT] =
+  {
+    timestamps.publishNs - timestamps.captureNs,
+    timestamps.serializedNs - timestamps.publishNs,
+    timestamps.writtenNs - timestamps.serializedNs,
+    timestamps.writtenNs - timestamps.captureNs
+  };
+
+  for(int i = 0; i < LATENCY_COUNT; i++)
+  {
+    Latency& latency = latencies[i];
+    quint64 ns = static_cast<quint64>(std::max(intervals[i], 0LL));
+
+    // Bucket index is four times the binary logarithm of the microseconds
+    double us = static_cast<double>(ns) / 1000.;
+    int bucket = us > 1. ? static_cast<int>(std::ceil(std::log2(us) * 4.)) : 0;
+    bucket = std::clamp(bucket, 0, NUM_LATENCY_BUCKETS - 1);
+
+    // Single writer thread
+    latency.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    latency.count.fetch_add(1, std::memory_order_relaxed);
+    if(ns > latency.maxNs.load(std::memory_order_relaxed))
+      latency.maxNs.store(ns, std::memory_order_relaxed);
+  }
+}
+
+qint64 PerfCounters::getLatencyPercentileNs(LatencyStage stage, double percentile) const
+{
+  const Latency& latency = latencies[stage];
+  quint64 count = latency.count.load(std::memory_order_relaxed);
+  if(count == 0)
+    return 0L;
+
+  quint64 rank = static_cast<quint64>(std::ceil(static_cast<double>(count) * percentile / 100.));
+  quint64 sum = 0L;
+  for(int i = 0; i < NUM_LATENCY_BUCKETS; i++)
+  {
+    sum += latency.buckets[i].load(std::memory_order_relaxed);
+    if(sum >= rank)
+      // Return upper bound of bucket but not more than the maximum
+      return std::min(static_cast<qint64>(std::exp2(i / 4.) * 1000.),
+                      static_cast<qint64>(latency.maxNs.load(std::memory_order_relaxed)));
+  }
+  return static_cast<qint64>(latency.maxNs.load(std::memory_order_relaxed));
+}
+
+qint64 PerfCounters::monotonicNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QByteArray PerfCounters::toJson(bool compact) const
+{
+  QJsonArray stageArr;
+  for(int i = 0; i < STAGE_COUNT; i++)
+  {
+    const Stage& s = stages[i];
+    quint64 count = s.count.load(std::memory_order_relaxed);
+    double countDiv = count > 0 ? static_cast<double>(count) : 1.;
+
+    QJsonObject obj;
+    obj.insert(QStringLiteral("name"), QLatin1String(STAGE_NAMES[i]));
+    obj.insert(QStringLiteral("count"), static_cast<qint64>(count));
+    obj.insert(QStringLiteral("ns_per_op"), static_cast<double>(s.totalNs.load(std::memory_order_relaxed)) / countDiv);
+    obj.insert(QStringLiteral("max_ns"), static_cast<qint64>(s.maxNs.load(std::memory_order_relaxed)));
+    obj.insert(QStringLiteral("bytes_per_op"), static_cast<double>(s.totalBytes.load(std::memory_order_relaxed)) / countDiv);
+    stageArr.append(obj);
+  }
+
+  QJsonArray latencyArr;
+  for(int i = 0; i < LATENCY_COUNT; i++)
+  {
+    LatencyStage stage = static_cast<LatencyStage>(i);
+    QJsonObject obj;
+    obj.insert(QStringLiteral("name"), QLatin1String(LATENCY_NAMES[i]));
+    obj.insert(QStringLiteral("count"), static_cast<qint64>(latencies[i].count.load(std::memory_order_relaxed)));
+    for(double percentile : PERCENTILES)
+      obj.insert(QStringLiteral("p%1_ns").arg(percentile), getLatencyPercentileNs(stage, percentile));
+    obj.insert(QStringLiteral("max_ns"), static_cast<qint64>(latencies[i].maxNs.load(std::memory_order_relaxed)));
+    latencyArr.append(obj);
+  }
+
+  QJsonObject root;
+  root.insert(QStringLiteral("version"), QCoreApplication::applicationVersion());
+  root.insert(QStringLiteral("stages"), stageArr);
+  root.insert(QStringLiteral("latency"), latencyArr);
+  root.insert(QStringLiteral("frames_dropped"), getFramesDropped());
+  root.insert(QStringLiteral("acf_cache_hit_ratio"), static_cast<double>(getLoaderCacheHitRatio()));
+
+  QJsonObject schedule;
+  schedule.insert(QStringLiteral("period_avg_ms"), static_cast<double>(getSchedulePeriodAvgMs()));
+  schedule.insert(QStringLiteral("jitter_avg_ms"), static_cast<double>(getScheduleJitterAvgMs()));
+  schedule.insert(QStringLiteral("jitter_max_ms"), static_cast<double>(scheduleJitterMaxMs.load(std::memory_order_relaxed)));
+  root.insert(QStringLiteral("schedule"), schedule);
+
+  QJsonObject aiEvents;
+  aiEvents.insert(QStringLiteral("added"), static_cast<qint64>(aiAdded.load(std::memory_order_relaxed)));
+  aiEvents.insert(QStringLiteral("updated"), static_cast<qint64>(aiUpdated.load(std::memory_order_relaxed)));
+  aiEvents.insert(QStringLiteral("removed"), static_cast<qint64>(aiRemoved.load(std::memory_order_relaxed)));
+  root.insert(QStringLiteral("ai_events"), aiEvents);
+
+  QJsonObject deadReckoning;
+  deadReckoning.insert(QStringLiteral("error_avg_m"), static_cast<double>(getDeadReckoningErrorAvgMeter()));
+  deadReckoning.insert(QStringLiteral("error_max_m"), static_cast<double>(deadReckoningErrorMaxMeter.load(std::memory_order_relaxed)));
+  root.insert(QStringLiteral("dead_reckoning"), deadReckoning);
+
+  QJsonObject userStream;
+  userStream.insert(QStringLiteral("budget_ns"), USER_STREAM_BUDGET_NS);
+  userStream.insert(QStringLiteral("time_avg_ms"), static_cast<double>(getUserStreamTimeAvgMs()));
+  userStream.insert(QStringLiteral("time_max_ms"), static_cast<double>(getUserStreamTimeMaxMs()));
+  userStream.insert(QStringLiteral("over_budget"), getUserStreamOverBudget());
+  root.insert(QStringLiteral("user_stream"), userStream);
+
+  // High-water marks to find scaling limits
+  root.insert(QStringLiteral("peak_ai_count"), getPeakAiCount());
+  root.insert(QStringLiteral("peak_bytes_written"), getPeakBytesWritten());
+  root.insert(QStringLiteral("peak_loader_queue"), getPeakLoaderQueueDepth());
+
+  return QJsonDocument(root).toJson(compact ? QJsonDocument::Compact : QJsonDocument::Indented);
+}
+
+bool PerfCounters::writeReport(const QString& filename) const
+{
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    file.write(toJson(false /* compact */));
+    file.close();
+    qInfo() << Q_FUNC_INFO << "Wrote performance report to" << filename;
+    return true;
+  }
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+}
+
+float PerfCounters::getLoaderCacheHitRatio() const
+{
+  quint64 hits = loaderCacheHits.load(std::memory_order_relaxed);
+  quint64 total = hits + loaderCacheMisses.load(std::memory_order_relaxed);
+  return total > 0 ? static_cast<float>(static_cast<double>(hits) / static_cast<double>(total)) : 0.f;
+}
+
+void PerfCounters::updateTime(qint64 nanoseconds, std::atomic<float> *last, std::atomic<float>& avg, std::atomic<float> *max)
+{
+  updateValue(static_cast<float>(nanoseconds) / 1000000.f, last, avg, max);
+}
+
+void PerfCounters::updateValue(float value, std::atomic<float> *last, std::atomic<float>& avg, std::atomic<float> *max)
+{
+  if(last != nullptr)
+    last->store(value, std::memory_order_relaxed);
+
+  // Only one writer per value - no need for compare and exchange
+  float average = avg.load(std::memory_order_relaxed);
+  avg.store(average < 0.0001f ? value : average + (value - average) * AVERAGE_FACTOR, std::memory_order_relaxed);
+
+  if(max != nullptr && value > max->load(std::memory_order_relaxed))
+    max->store(value, std::memory_order_relaxed);
+}
+
+} // namespace xpc
@@ -0,0 +1,299 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_PERFCOUNTERS_H
+#define LITTLEXPC_PERFCOUNTERS_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+class QByteArray;
+class QString;
+
+namespace xpc {
+
+/* Stages of the fetch, serialize and publish pipeline for per operation statistics */
+enum PerfStage
+{
+  STAGE_FETCH, /* XpConnect::fillSimConnectData() */
+  STAGE_SERIALIZE, /* SimConnectData::write() */
+  STAGE_WRITE, /* SharedMemoryWriter::writeData() including lock */
+  STAGE_ACF_READ, /* AircraftFileLoader::readValuesFromAircraftFile() */
+  STAGE_USER_STREAM, /* Fill and publish the per frame user aircraft record */
+  STAGE_COUNT
+};
+
+/* Time allowed to fill and publish the user aircraft stream record on each frame */
+static const qint64 USER_STREAM_BUDGET_NS = 10000L;
+
+/* Latency intervals between the timestamps of one update */
+enum LatencyStage
+{
+  LATENCY_FETCH, /* Capture to publish - filling data in the flight loop */
+  LATENCY_HANDOFF, /* Publish to serialized - thread wake up and serialization */
+  LATENCY_WRITE, /* Serialized to written - shared memory lock and copy */
+  LATENCY_TOTAL, /* Capture to written */
+  LATENCY_COUNT
+};
+
+/*
+ * Monotonic timestamps of one update in nanoseconds as returned by PerfCounters::monotonicNs().
+ * Appended as a trailer to the shared memory segment after the data.
+ */
+struct LatencyTimestamps
+{
+  qint64 captureNs = 0L, /* Start of fetch in flight loop */
+         publishNs = 0L, /* Data filled and handed over to writer thread */
+         serializedNs = 0L, /* Data serialized in writer thread */
+         writtenNs = 0L; /* Shared memory locked and data copied */
+};
+
+/*
+ * Performance counters of the plugin. Updated from main, writer and aircraft file loader threads and read
+ * by the dataref accessors in PerfDataRefs.
+ * Each time value is written by one thread only. All values use relaxed atomics since they are
+ * statistics only.
+ */
+class PerfCounters
+{
+public:
+  PerfCounters()
+  {
+  }
+
+  PerfCounters(const PerfCounters& other) = delete;
+  PerfCounters& operator=(const PerfCounters& other) = delete;
+
+  /* Time needed to fill SimConnectData from datarefs. Main thread. */
+  void addFetchTimeNs(qint64 nanoseconds);
+
+  /* Time needed to serialize SimConnectData and size of result. Writer thread. */
+  void addSerializeTimeNs(qint64 nanoseconds, qint64 bytes);
+
+  /* Time needed to fill and publish the user aircraft stream record. Counts frames over budget. Main thread. */
+  void addUserStreamTimeNs(qint64 nanoseconds, qint64 bytes);
+
+  /* Distance between the user position extrapolated from the last update and the actual position. Main thread. */
+  void addDeadReckoningError(double meter);
+
+  /* Bytes written to shared memory. Writer thread. */
+  void addBytesWritten(qint64 bytes);
+
+  /* Add one operation of a pipeline stage with duration and number of bytes produced.
+   * Any thread. STAGE_ACF_READ is updated concurrently by the loader threads. */
+  void addStage(PerfStage stage, qint64 nanoseconds, qint64 bytes = 0L);
+
+  /* Add latency intervals of one update. Writer thread. */
+  void addLatency(const LatencyTimestamps& timestamps);
+
+  /* Latency percentile from 0 to 100 in nanoseconds. Resolution is about 19 percent of the value. */
+  qint64 getLatencyPercentileNs(LatencyStage stage, double percentile) const;
+
+  /* Nanoseconds from a monotonic system wide clock which can be compared across processes on the same machine */
+  static qint64 monotonicNs();
+
+  /* Statistics for all stages as JSON with ns/op and bytes/op. Any thread. */
+  QByteArray toJson(bool compact) const;
+
+  /* Write JSON statistics to file. Returns false on error. */
+  bool writeReport(const QString& filename) const;
+
+  /* Achieved time between two fetch callbacks and desired period. Main thread. */
+  void addSchedulePeriod(qint64 periodNs, qint64 targetPeriodNs);
+
+  /* Update was dropped since writer thread was busy. Main thread. */
+  void addFrameDropped()
+  {
+    framesDropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* Number of AI aircraft and boats in last update. Main thread. */
+  void setAiCount(int count)
+  {
+    aiCount.store(count, std::memory_order_relaxed);
+    if(count > peakAiCount.load(std::memory_order_relaxed))
+      peakAiCount.store(count, std::memory_order_relaxed);
+  }
+
+  /* Number of AI aircraft added, updated and removed in last update. Main thread. */
+  void addAiTrafficEvents(int added, int updated, int removed)
+  {
+    aiAdded.fetch_add(static_cast<quint64>(added), std::memory_order_relaxed);
+    aiUpdated.fetch_add(static_cast<quint64>(updated), std::memory_order_relaxed);
+    aiRemoved.fetch_add(static_cast<quint64>(removed), std::memory_order_relaxed);
+  }
+
+  /* Aircraft file loader statistics. Change queue depth by delta. Any thread. */
+  void addLoaderQueued(int delta)
+  {
+    updateMax(peakLoaderQueueDepth, loaderQueueDepth.fetch_add(delta, std::memory_order_relaxed) + delta);
+  }
+
+  void addLoaderCacheHit()
+  {
+    loaderCacheHits.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void addLoaderCacheMiss()
+  {
+    loaderCacheMisses.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  float getFetchTimeLastMs() const
+  {
+    return fetchTimeLastMs.load(std::memory_order_relaxed);
+  }
+
+  float getFetchTimeAvgMs() const
+  {
+    return fetchTimeAvgMs.load(std::memory_order_relaxed);
+  }
+
+  float getFetchTimeMaxMs() const
+  {
+    return fetchTimeMaxMs.load(std::memory_order_relaxed);
+  }
+
+  float getSerializeTimeLastMs() const
+  {
+    return serializeTimeLastMs.load(std::memory_order_relaxed);
+  }
+
+  float getSerializeTimeAvgMs() const
+  {
+    return serializeTimeAvgMs.load(std::memory_order_relaxed);
+  }
+
+  int getBytesWrittenLast() const
+  {
+    return static_cast<int>(bytesWrittenLast.load(std::memory_order_relaxed));
+  }
+
+  double getBytesWrittenTotal() const
+  {
+    return static_cast<double>(bytesWrittenTotal.load(std::memory_order_relaxed));
+  }
+
+  int getFramesDropped() const
+  {
+    return framesDropped.load(std::memory_order_relaxed);
+  }
+
+  int getAiCount() const
+  {
+    return aiCount.load(std::memory_order_relaxed);
+  }
+
+  int getLoaderQueueDepth() const
+  {
+    return loaderQueueDepth.load(std::memory_order_relaxed);
+  }
+
+  /* High-water marks since start */
+  int getPeakAiCount() const
+  {
+    return peakAiCount.load(std::memory_order_relaxed);
+  }
+
+  int getPeakBytesWritten() const
+  {
+    return static_cast<int>(peakBytesWritten.load(std::memory_order_relaxed));
+  }
+
+  int getPeakLoaderQueueDepth() const
+  {
+    return peakLoaderQueueDepth.load(std::memory_order_relaxed);
+  }
+
+  float getSchedulePeriodAvgMs() const
+  {
+    return schedulePeriodAvgMs.load(std::memory_order_relaxed);
+  }
+
+  float getUserStreamTimeAvgMs() const
+  {
+    return userStreamTimeAvgMs.load(std::memory_order_relaxed);
+  }
+
+  float getUserStreamTimeMaxMs() const
+  {
+    return userStreamTimeMaxMs.load(std::memory_order_relaxed);
+  }
+
+  int getUserStreamOverBudget() const
+  {
+    return userStreamOverBudget.load(std::memory_order_relaxed);
+  }
+
+  float getDeadReckoningErrorAvgMeter() const
+  {
+    return deadReckoningErrorAvgMeter.load(std::memory_order_relaxed);
+  }
+
+  /* Average absolute deviation from the desired period */
+  float getScheduleJitterAvgMs() const
+  {
+    return scheduleJitterAvgMs.load(std::memory_order_relaxed);
+  }
+
+  /* Ratio of cache hits to all lookups from 0 to 1 */
+  float getLoaderCacheHitRatio() const;
+
+private:
+  /* Accumulated values for one pipeline stage */
+  struct Stage
+  {
+    std::atomic<quint64> count = 0L, totalNs = 0L, maxNs = 0L, totalBytes = 0L;
+  };
+
+  /* Logarithmic histogram of latency values. Bucket i counts values up to 2^(i/4) microseconds. */
+  static const int NUM_LATENCY_BUCKETS = 100;
+  struct Latency
+  {
+    std::atomic<quint64> count = 0L, maxNs = 0L;
+    std::atomic<quint32> buckets[NUM_LATENCY_BUCKETS] = {};
+  };
+
+  /* Raise maximum to value. Safe for concurrent writers. */
+  template<typename TYPE>
+  static void updateMax(std::atomic<TYPE>& max, TYPE value)
+  {
+    TYPE current = max.load(std::memory_order_relaxed);
+    while(value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /* Update last, exponential moving average and maximum values. Last and max can be null. */
+  static void updateTime(qint64 nanoseconds, std::atomic<float> *last, std::atomic<float>& avg, std::atomic<float> *max);
+  static void updateValue(float value, std::atomic<float> *last, std::atomic<float>& avg, std::atomic<float> *max);
+
+  std::atomic<float> fetchTimeLastMs = 0.f, fetchTimeAvgMs = 0.f, fetchTimeMaxMs = 0.f, serializeTimeLastMs = 0.f,
+                     serializeTimeAvgMs = 0.f, schedulePeriodAvgMs = 0.f, scheduleJitterAvgMs = 0.f,
+                     scheduleJitterMaxMs = 0.f, userStreamTimeAvgMs = 0.f, userStreamTimeMaxMs = 0.f,
+                     deadReckoningErrorAvgMeter = 0.f, deadReckoningErrorMaxMeter = 0.f;
+  std::atomic<qint64> bytesWrittenLast = 0L, bytesWrittenTotal = 0L, peakBytesWritten = 0L;
+  std::atomic<int> framesDropped = 0, userStreamOverBudget = 0, aiCount = 0, loaderQueueDepth = 0, peakAiCount = 0, peakLoaderQueueDepth = 0;
+  std::atomic<quint64> loaderCacheHits = 0L, loaderCacheMisses = 0L, aiAdded = 0L, aiUpdated = 0L, aiRemoved = 0L;
+  Stage stages[STAGE_COUNT];
+  Latency latencies[LATENCY_COUNT];
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_PERFCOUNTERS_H
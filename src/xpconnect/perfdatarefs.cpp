@@ -0,0 +1,137 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/perfdatarefs.h"
+
+#include "xpconnect/perfcounters.h"
+
+#include <QDebug>
+
+extern "C" {
+#include "XPLMPlugin.h"
+}
+
+namespace xpc {
+
+namespace {
+
+/* Message id to register datarefs with DataRefEditor and DataRefTool */
+const int MSG_ADD_DATAREF = 0x01000000;
+
+/* Converts refcon back to counters */
+inline const PerfCounters *counters(void *refcon)
+{
+  return static_cast<const PerfCounters *>(refcon);
+}
+
+/* Describes one published counter. Only one of the accessors is set depending on type. */
+struct PerfDataRef
+{
+  const char *name;
+  XPLMDataTypeID type;
+  XPLMGetDatai_f intAccessor;
+  XPLMGetDataf_f floatAccessor;
+  XPLMGetDatad_f doubleAccessor;
+};
+
+/* *INDENT-OFF* */
+const PerfDataRef PERF_DATAREFS[] =
+{
+  {"littlexpconnect/perf/fetch_time_last_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getFetchTimeLastMs();}, nullptr},
+  {"littlexpconnect/perf/fetch_time_avg_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getFetchTimeAvgMs();}, nullptr},
+  {"littlexpconnect/perf/fetch_time_max_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getFetchTimeMaxMs();}, nullptr},
+  {"littlexpconnect/perf/serialize_time_last_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getSerializeTimeLastMs();}, nullptr},
+  {"littlexpconnect/perf/serialize_time_avg_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getSerializeTimeAvgMs();}, nullptr},
+  {"littlexpconnect/perf/schedule_period_avg_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getSchedulePeriodAvgMs();}, nullptr},
+  {"littlexpconnect/perf/schedule_jitter_avg_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getScheduleJitterAvgMs();}, nullptr},
+  {"littlexpconnect/perf/user_stream_time_avg_ms", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getUserStreamTimeAvgMs();}, nullptr},
+  {"littlexpconnect/perf/user_stream_over_budget", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getUserStreamOverBudget();}, nullptr, nullptr},
+  {"littlexpconnect/perf/dead_reckoning_error_avg_m", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getDeadReckoningErrorAvgMeter();}, nullptr},
+  {"littlexpconnect/perf/bytes_written_last", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getBytesWrittenLast();}, nullptr, nullptr},
+  {"littlexpconnect/perf/bytes_written_total", xplmType_Double, nullptr, nullptr,
+   [](void *refcon) -> double {return counters(refcon)->getBytesWrittenTotal();}},
+  {"littlexpconnect/perf/frames_dropped", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getFramesDropped();}, nullptr, nullptr},
+  {"littlexpconnect/perf/ai_count", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getAiCount();}, nullptr, nullptr},
+  {"littlexpconnect/perf/acf_loader_queue", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getLoaderQueueDepth();}, nullptr, nullptr},
+  {"littlexpconnect/perf/acf_cache_hit_ratio", xplmType_Float, nullptr,
+   [](void *refcon) -> float {return counters(refcon)->getLoaderCacheHitRatio();}, nullptr},
+  {"littlexpconnect/perf/peak_ai_count", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getPeakAiCount();}, nullptr, nullptr},
+  {"littlexpconnect/perf/peak_bytes_written", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getPeakBytesWritten();}, nullptr, nullptr},
+  {"littlexpconnect/perf/peak_acf_loader_queue", xplmType_Int,
+   [](void *refcon) -> int {return counters(refcon)->getPeakLoaderQueueDepth();}, nullptr, nullptr},
+};
+/* *INDENT-ON* */
+
+} // namespace
+
+PerfDataRefs::PerfDataRefs(const PerfCounters *perfCounters)
+{
+  void *refcon = const_cast<PerfCounters *>(perfCounters);
+
+  for(const PerfDataRef& ref : PERF_DATAREFS)
+  {
+    XPLMDataRef dataRef = XPLMRegisterDataAccessor(ref.name, ref.type, 0 /* read only */,
+                                                   ref.intAccessor, nullptr, ref.floatAccessor, nullptr,
+                                                   ref.doubleAccessor, nullptr,
+                                                   nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                                   refcon, nullptr);
+    if(dataRef != nullptr)
+      dataRefs.append(dataRef);
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot register dataref" << ref.name;
+  }
+}
+
+PerfDataRefs::~PerfDataRefs()
+{
+  for(XPLMDataRef dataRef : std::as_const(dataRefs))
+    XPLMUnregisterDataAccessor(dataRef);
+}
+
+void PerfDataRefs::notifyEditors()
+{
+  if(editorsNotified)
+    return;
+
+  editorsNotified = true;
+
+  // DataRefTool uses the same signature as DataRefEditor
+  XPLMPluginID editorId = XPLMFindPluginBySignature("xplanesdk.examples.DataRefEditor");
+  if(editorId != XPLM_NO_PLUGIN_ID)
+  {
+    for(const PerfDataRef& ref : PERF_DATAREFS)
+      XPLMSendMessageToPlugin(editorId, MSG_ADD_DATAREF, const_cast<char *>(ref.name));
+  }
+}
+
+} // namespace xpc
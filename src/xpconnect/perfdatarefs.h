@@ -0,0 +1,59 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_PERFDATAREFS_H
+#define LITTLEXPC_PERFDATAREFS_H
+
+#include <QList>
+
+extern "C" {
+#include "XPLMDataAccess.h"
+}
+
+namespace xpc {
+
+class PerfCounters;
+
+/*
+ * Publishes the values of PerfCounters as read-only datarefs "littlexpconnect/perf/..." to allow
+ * monitoring plugin cost in DataRefTool or other plugins.
+ * Run in main thread only.
+ */
+class PerfDataRefs
+{
+public:
+  /* Registers all datarefs. Counters have to stay valid until this object is deleted. */
+  PerfDataRefs(const PerfCounters *perfCounters);
+
+  /* Unregisters all datarefs */
+  ~PerfDataRefs();
+
+  PerfDataRefs(const PerfDataRefs& other) = delete;
+  PerfDataRefs& operator=(const PerfDataRefs& other) = delete;
+
+  /* Tell DataRefEditor and DataRefTool about the datarefs. Does this only once.
+   * Call after all plugins are enabled, i.e. from a flight loop callback. */
+  void notifyEditors();
+
+private:
+  QList<XPLMDataRef> dataRefs;
+  bool editorsNotified = false;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_PERFDATAREFS_H
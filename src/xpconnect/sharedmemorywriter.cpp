@@ -17,95 +17,202 @@
 
 #include "xpconnect/sharedmemorywriter.h"
 
+#include "xpconnect/tracer.h"
 #include "xpconnect/xpconnect.h"
 #include "fs/sc/xpconnecthandler.h"
+#include "settings/settings.h"
 
 #include <QBuffer>
 #include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+namespace lxc {
+/* key names for atools::settings */
+static const QLatin1String SETTINGS_OPTIONS_TRAFFIC_GEOMETRY("Options/TrafficGeometry");
+}
 
 SharedMemoryWriter::SharedMemoryWriter(bool verboseLogging)
   : verbose(verboseLogging)
 {
   qDebug() << Q_FUNC_INFO;
-  xpConnect = new xpc::XpConnect(verbose);
-  xpConnect->initDataRefs();
+  setObjectName(QStringLiteral("LittleXpconnect Writer"));
+  // Datarefs are initialized on first fetch to keep plugin enable short
+  xpConnect = new xpc::XpConnect(verbose, &perfCounters);
+
+  addTrafficGeometry = atools::settings::Settings::instance().
+                       getAndStoreValue(lxc::SETTINGS_OPTIONS_TRAFFIC_GEOMETRY, false).toBool();
+  metadataSegment = xpc::MetadataSegment::createFromSettings(verbose);
 }
 
 SharedMemoryWriter::~SharedMemoryWriter()
 {
   qDebug() << Q_FUNC_INFO;
+  recorder.stop();
   delete xpConnect;
+  delete metadataSegment;
 }
 
-void SharedMemoryWriter::fetchAndWriteData(bool fetchAi, bool fetchAiAircraftInfo)
+void SharedMemoryWriter::fetchAndWriteData(bool fetchAi, bool fetchAiAircraftInfo, bool loadAiAircraftFiles, bool recordDataRefs)
 {
   bool foundData = false;
 
+  if(!xpConnect->isDataRefsInitialized())
+  {
+    // Deferred from constructor - other plugins are loaded now too
+    QElapsedTimer timer;
+    timer.start();
+    xpConnect->initDataRefs();
+    qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Startup phase datarefs took" << timer.nsecsElapsed() / 1000L << "us";
+  }
+
+  if(recordDataRefs != recorder.isRecording())
+  {
+    if(recordDataRefs)
+      startRecording();
+    else
+      recorder.stop();
+  }
+
+  // Capture values before fetching - independent of the writer lock to have no gaps in the recording
+  recorder.recordFrame();
+
+  // Lines for the verbose log - collected under the lock and printed afterwards
+  QStringList report;
+
   // Use "tryLock" to avoid blocking when other thread is already accessing - rather allow to drop updates than blocking
   if(dataMutex.tryLock(0))
   {
-    foundData = xpConnect->fillSimConnectData(data, fetchAi, fetchAiAircraftInfo);
+    QElapsedTimer timer;
+    timer.start();
+    qint64 captureNs = xpc::PerfCounters::monotonicNs();
+
+    foundData = xpConnect->fillSimConnectData(data, fetchAi, fetchAiAircraftInfo, loadAiAircraftFiles);
 
     if(!foundData)
+    {
       data = atools::fs::sc::EMPTY_SIMCONNECT_DATA;
+      xpConnect->clearAiTraffic();
+    }
 
-    dataMutex.unlock();
-  }
+    dataTimestamps.captureNs = captureNs;
+    dataTimestamps.publishNs = xpc::PerfCounters::monotonicNs();
 
-  if(foundData)
-  {
-    waitCondition.wakeAll();
+    perfCounters.addFetchTimeNs(timer.nsecsElapsed());
+    perfCounters.setAiCount(static_cast<int>(data.getAiAircraftConst().size()) + xpConnect->getNumAiTraffic());
 
-    if(verbose)
+    if(verbose && foundData)
     {
       qint64 now = QDateTime::currentSecsSinceEpoch();
       if(now > lastReport + 10)
       {
         lastReport = now;
-        const atools::fs::sc::SimConnectUserAircraft& userAircraft = data.getUserAircraftConst();
-
-        if(userAircraft.isValid())
-          qDebug() << Q_FUNC_INFO << "User id" << userAircraft.getObjectId()
-                   << "type" << userAircraft.getAirplaneType()
-                   << "model" << userAircraft.getAirplaneModel()
-                   << "reg" << userAircraft.getAirplaneRegistration()
-                   << userAircraft.getPosition();
-        else
-          qDebug() << Q_FUNC_INFO << "User not valid";
-
-        if(!data.getAiAircraftConst().isEmpty())
-        {
-          for(const atools::fs::sc::SimConnectAircraft& aircraft : data.getAiAircraftConst())
-          {
-            qDebug() << Q_FUNC_INFO << "AI id" << aircraft.getObjectId()
-                     << "type" << aircraft.getAirplaneType()
-                     << "model" << aircraft.getAirplaneModel()
-                     << "reg" << aircraft.getAirplaneRegistration()
-                     << aircraft.getPosition();
-          }
-        }
-        else
-          qDebug() << Q_FUNC_INFO << "AI list empty";
+        report = xpConnect->trafficReport(data);
       }
-    } // if(verbose)
+    }
+
+    dataMutex.unlock();
+  }
+  else
+    perfCounters.addFrameDropped();
+
+  if(foundData)
+  {
+    waitCondition.wakeAll();
+
+    if(!report.isEmpty())
+    {
+      for(const QString& line : std::as_const(report))
+        qDebug().noquote() << Q_FUNC_INFO << line;
+
+      if(metadataSegment != nullptr)
+        qDebug() << Q_FUNC_INFO << "Metadata version" << metadataSegment->getVersion() << "entries" << metadataSegment->size();
+
+      qDebug() << Q_FUNC_INFO << "Performance" << perfCounters.toJson(true /* compact */);
+    }
   } // if(foundData)
 }
 
+void SharedMemoryWriter::streamUserAircraft(bool enabled, int flightLoopCounter)
+{
+  if(!enabled)
+  {
+    userStream.close();
+    return;
+  }
+
+  if(!userStream.isOpen() && !userStream.open())
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // No locks and no serialization - only read a few datarefs and copy a fixed size record
+  xpc::UserStreamRecord record;
+  if(xpConnect->fillUserStreamRecord(record, flightLoopCounter))
+  {
+    userStream.write(record);
+    perfCounters.addUserStreamTimeNs(timer.nsecsElapsed(), sizeof(record));
+  }
+}
+
+void SharedMemoryWriter::setAiUpdateInterval(int interval)
+{
+  // Only used in fillSimConnectData() which also runs in the main thread - no lock needed
+  xpConnect->setAiUpdateInterval(interval);
+}
+
+void SharedMemoryWriter::planeLoaded()
+{
+  xpConnect->planeLoaded();
+}
+
+void SharedMemoryWriter::rediscoverDataRefs()
+{
+  // Recorder keeps pointers to the datarefs which are changed by rediscovery
+  if(xpConnect->rediscoverDataRefs() > 0 && recorder.isRecording())
+    startRecording();
+}
+
+void SharedMemoryWriter::startRecording()
+{
+  QString filename = QDir::temp().filePath(QStringLiteral("little_xpconnect_%1.lxcrec").
+                                           arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_hhmmss"))));
+  recorder.start(filename, xpConnect->getDataRefEntries());
+}
+
 void SharedMemoryWriter::terminateThread()
 {
+  // File is closed by the final flush in the thread
+  recorder.stop();
+
   terminate = true;
   waitCondition.wakeAll();
   wait();
 }
 
-void SharedMemoryWriter::writeData(const QByteArray& simDataBytes, bool terminated)
+void SharedMemoryWriter::buildSegment(QByteArray& segment, const QByteArray& simDataBytes, bool terminated,
+                                      const xpc::LatencyTimestamps& timestamps)
 {
-  QByteArray allBytes;
-  QDataStream stream(&allBytes, QIODevice::WriteOnly);
+  QDataStream stream(&segment, QIODevice::WriteOnly);
   stream << static_cast<quint32>(static_cast<quint32>(simDataBytes.size()) + sizeof(quint32) * 2);
   stream << static_cast<quint32>(terminated);
   stream.writeRawData(simDataBytes.constData(), static_cast<int>(simDataBytes.size()));
 
+  // Trailer - written timestamp is filled in once the lock is acquired
+  stream << LATENCY_TRAILER_MAGIC << timestamps.captureNs << timestamps.publishNs << timestamps.serializedNs << qint64(0L);
+}
+
+qint64 SharedMemoryWriter::writeData(QSharedMemory& sharedMemory, const QByteArray& simDataBytes, bool terminated,
+                                     xpc::LatencyTimestamps& timestamps)
+{
+  TRACE_SCOPE("writeData");
+  qint64 bytesWritten = 0L;
+
+  QByteArray allBytes;
+  buildSegment(allBytes, simDataBytes, terminated, timestamps);
+
   if(allBytes.size() > atools::fs::sc::SHARED_MEMORY_SIZE)
     qWarning() << "LittleXpconnect" << Q_FUNC_INFO
                << "Data too large" << allBytes.size() << ">" << atools::fs::sc::SHARED_MEMORY_SIZE;
@@ -113,20 +220,26 @@ void SharedMemoryWriter::writeData(const QByteArray& simDataBytes, bool terminat
   {
     if(sharedMemory.lock())
     {
+      timestamps.writtenNs = xpc::PerfCounters::monotonicNs();
+      qToBigEndian<qint64>(timestamps.writtenNs, allBytes.data() + allBytes.size() - sizeof(qint64));
       memcpy(sharedMemory.data(), allBytes.constData(), static_cast<size_t>(allBytes.size()));
       // qDebug() << "Lock ok size" << allBytes.size();
       sharedMemory.unlock();
+      bytesWritten = allBytes.size();
     }
     else
       qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot lock" << sharedMemory.key()
               << "native" << sharedMemory.nativeKey();
   }
+  return bytesWritten;
 }
 
 void SharedMemoryWriter::run()
 {
   qDebug() << "LittleXpconnect" << Q_FUNC_INFO;
 
+  QElapsedTimer startupTimer;
+  startupTimer.start();
   sharedMemory.setKey(atools::fs::sc::SHARED_MEMORY_KEY);
   if(!sharedMemory.create(atools::fs::sc::SHARED_MEMORY_SIZE, QSharedMemory::ReadWrite))
   {
@@ -142,6 +255,11 @@ void SharedMemoryWriter::run()
     qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Created" << sharedMemory.key()
             << "native" << sharedMemory.nativeKey();
 
+  if(metadataSegment != nullptr)
+    metadataSegment->open();
+
+  qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Startup phase shared memory took" << startupTimer.nsecsElapsed() / 1000L << "us";
+
   waitMutex.lock();
 
   while(true)
@@ -152,24 +270,78 @@ void SharedMemoryWriter::run()
     QBuffer buffer(&simDataBytes);
     buffer.open(QIODevice::WriteOnly);
 
+    xpc::LatencyTimestamps timestamps;
     {
+      // Only copy under the lock - the simulator thread drops its update if it cannot get the lock
       QMutexLocker locker(&dataMutex);
-      data.write(&buffer);
+      TRACE_SCOPE("data.copy");
+      writerData = data;
+      xpConnect->copyAiTraffic(writerAiTable);
+      writerUserStateValid = xpConnect->copyUserState(writerUserState);
+      timestamps = dataTimestamps;
+    }
+
+    {
+      TRACE_SCOPE("data.write");
+      QElapsedTimer timer;
+      timer.start();
+
+      // Create aircraft objects and calculate here instead of the flight loop to keep load off the simulator thread
+      xpc::XpConnect::materializeAiTraffic(writerAiTable, writerData);
+      if(addTrafficGeometry)
+        xpc::XpConnect::addTrafficGeometry(writerData, writerAiTable, writerUserStateValid ? &writerUserState : nullptr,
+                                           trafficGeometry);
+
+      // Publish strings only on change - main segment carries them too unless blanking is enabled
+      bool blank = false;
+      if(metadataSegment != nullptr)
+      {
+        metadataSegment->update(writerData);
+        blank = metadataSegment->isBlankStrings();
+      }
+
+      // Copy is replaced on next update - no need to restore strings
+      if(blank)
+        xpc::XpConnect::blankAircraftStrings(writerData);
+
+      writerData.write(&buffer);
+
+      perfCounters.addSerializeTimeNs(timer.nsecsElapsed(), simDataBytes.size());
     }
+    timestamps.serializedNs = xpc::PerfCounters::monotonicNs();
 
     buffer.close();
 
     if(terminate)
     {
-      writeData(simDataBytes, terminate);
+      writeData(sharedMemory, simDataBytes, terminate, timestamps);
       break;
     }
     else
-      writeData(simDataBytes, false);
+    {
+      QElapsedTimer timer;
+      timer.start();
+      qint64 bytesWritten = writeData(sharedMemory, simDataBytes, false, timestamps);
+      perfCounters.addStage(xpc::STAGE_WRITE, timer.nsecsElapsed(), bytesWritten);
+      perfCounters.addBytesWritten(bytesWritten);
+
+      // Data was not written if lock failed
+      if(bytesWritten > 0)
+        perfCounters.addLatency(timestamps);
+    }
+
+    // Write captured dataref frames outside of the main thread
+    recorder.flush();
   }
   waitMutex.unlock();
   qDebug() << "LittleXpconnect" << Q_FUNC_INFO << "terminate" << terminate;
 
+  // Write remaining frames and close capture file
+  recorder.flush();
+
+  if(metadataSegment != nullptr)
+    metadataSegment->close();
+
   if(!sharedMemory.detach())
     qWarning() << "Cannot detach" << sharedMemory.errorString() << "from" << sharedMemory.key()
                << "native" << sharedMemory.nativeKey();
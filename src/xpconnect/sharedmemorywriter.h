@@ -19,6 +19,13 @@
 #define SHAREDMEMORYWRITERTHREAD_H
 
 #include "fs/sc/simconnectdata.h"
+#include "xpconnect/aitraffictable.h"
+#include "xpconnect/datarefcapture.h"
+#include "xpconnect/deadreckoning.h"
+#include "xpconnect/metadatasegment.h"
+#include "xpconnect/perfcounters.h"
+#include "xpconnect/trafficgeometry.h"
+#include "xpconnect/userstream.h"
 
 #include <QMutex>
 #include <QSharedMemory>
@@ -28,6 +35,17 @@
 /*
  * Use a background thread to write the data to the shared memory to avoid simulator stutters due to
  * locking
+ *
+ * Shared memory layout. All values are big endian as written by QDataStream:
+ *   quint32 size of header and data
+ *   quint32 terminated flag
+ *   serialized SimConnectData
+ * followed by a latency trailer which is ignored by clients reading only the size given above:
+ *   quint32 magic 0x4c584c54 ("LXLT")
+ *   qint64 capture, publish, serialized and written timestamps as given by xpc::PerfCounters::monotonicNs()
+ * Clients can compute their own read latency by comparing the written timestamp with the same clock.
+ *
+ * Aircraft strings are also published in a separate segment. See xpc::MetadataSegment.
  */
 class SharedMemoryWriter :
   public QThread
@@ -40,22 +58,76 @@ public:
   SharedMemoryWriter& operator=(const SharedMemoryWriter& other) = delete;
 
   /* Fetch data from the datarefs (main thread context) and pass it over to the
-   * shared memory writer (context of "flightLoopCallback()") */
-  void fetchAndWriteData(bool fetchAi, bool fetchAiAircraftInfo);
+   * shared memory writer (context of "flightLoopCallback()").
+   * See XpConnect::fillSimConnectData() for fetchAiAircraftInfo and loadAiAircraftFiles.
+   * Starts or stops recording of all datarefs to a capture file depending on recordDataRefs. */
+  void fetchAndWriteData(bool fetchAi, bool fetchAiAircraftInfo, bool loadAiAircraftFiles, bool recordDataRefs);
+
+  /* Publish user aircraft position and attitude into the separate stream segment if enabled.
+   * Opens or closes the segment depending on enabled. Called on every frame in main thread context. */
+  void streamUserAircraft(bool enabled, int flightLoopCounter);
+
+  /* Update AI only every n-th fetch. Runs in main thread context. */
+  void setAiUpdateInterval(int interval);
+
+  /* Aircraft was loaded in simulator. Runs in main thread context. */
+  void planeLoaded();
+
+  /* Look for datarefs added later by other plugins. Runs in main thread context.
+   * Restarts a running recording with a new file if datarefs were found. */
+  void rediscoverDataRefs();
 
   /* Send termination signal and wait for terminated */
   void terminateThread();
 
+  /* Marks the latency trailer after the data in shared memory - "LXLT" */
+  static constexpr quint32 LATENCY_TRAILER_MAGIC = 0x4c584c54;
+
+  /* Size of magic and four timestamps */
+  static constexpr qsizetype LATENCY_TRAILER_SIZE = sizeof(quint32) + sizeof(qint64) * 4;
+
+  /* Build the full segment content with header, data and latency trailer as described above.
+   * The written timestamp in the trailer is zero. */
+  static void buildSegment(QByteArray& segment, const QByteArray& simDataBytes, bool terminated,
+                           const xpc::LatencyTimestamps& timestamps);
+
+  /* Build segment and copy it into the locked shared memory. Returns number of bytes written or 0 on error.
+   * Sets timestamps.writtenNs. */
+  static qint64 writeData(QSharedMemory& sharedMemory, const QByteArray& simDataBytes, bool terminated,
+                          xpc::LatencyTimestamps& timestamps);
+
+  /* Statistics updated by all threads */
+  const xpc::PerfCounters *getPerfCounters() const
+  {
+    return &perfCounters;
+  }
+
+  xpc::PerfCounters *getPerfCounters()
+  {
+    return &perfCounters;
+  }
+
 private:
   virtual void run() override;
-  void writeData(const QByteArray& simDataBytes, bool terminated);
+
+  /* Start recording to a new file in the temp folder */
+  void startRecording();
 
   bool terminate = false;
   atools::fs::sc::SimConnectData data;
 
+  /* Capture and publish times of "data". Also synchronized by dataMutex. */
+  xpc::LatencyTimestamps dataTimestamps;
+
   /* Syncronize SimConnectData "data" access */
   QMutex dataMutex;
 
+  /* Copies of data and traffic table taken under the lock. Extended and serialized in writer thread only. */
+  atools::fs::sc::SimConnectData writerData;
+  xpc::AiTrafficTable writerAiTable;
+  xpc::DeadReckoningState writerUserState;
+  bool writerUserStateValid = false;
+
   /* Wakes thread up once new data has arrived */
   QMutex waitMutex;
   QWaitCondition waitCondition;
@@ -65,6 +137,21 @@ private:
 
   xpc::XpConnect *xpConnect = nullptr;
 
+  xpc::PerfCounters perfCounters;
+
+  /* Dataref capture. Frames are recorded in main thread and written to file in this thread. */
+  xpc::DataRefRecorder recorder;
+
+  /* Calculates AI geometry relative to user in this thread if enabled in settings */
+  bool addTrafficGeometry = false;
+  xpc::TrafficGeometry trafficGeometry;
+
+  /* Aircraft strings published in a separate segment if enabled. Writer thread only. Null if disabled. */
+  xpc::MetadataSegment *metadataSegment = nullptr;
+
+  /* Per frame user aircraft stream. Main thread only and independent of the writer thread. */
+  xpc::UserStream userStream;
+
   // Logging - dump AI and user positions every ten seconds
   bool verbose = false;
   qint64 lastReport = 0L;
@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/stringpool.h"
+
+#include <QDebug>
+
+#include <cstring>
+
+namespace xpc {
+
+/* Limit for number of strings and fields to avoid growing without bounds in long sessions */
+static const int MAX_POOL_SIZE = 10000;
+
+QString StringPool::fromField(quint64 field)
+{
+  auto it = fields.constFind(field);
+  if(it != fields.constEnd())
+    return it.value();
+
+  clearIfFull();
+
+  char bytes[sizeof(field)];
+  std::memcpy(bytes, &field, sizeof(field));
+  QString str = intern(QString::fromUtf8(bytes, static_cast<qsizetype>(qstrnlen(bytes, sizeof(bytes)))));
+  fields.insert(field, str);
+  return str;
+}
+
+QString StringPool::intern(const QString& value)
+{
+  auto it = strings.constFind(value);
+  if(it != strings.constEnd())
+    return *it;
+
+  clearIfFull();
+  strings.insert(value);
+  return value;
+}
+
+void StringPool::clearIfFull()
+{
+  if(strings.size() >= MAX_POOL_SIZE || fields.size() >= MAX_POOL_SIZE)
+  {
+    qDebug() << Q_FUNC_INFO << "Clearing string pool" << strings.size() << fields.size();
+    strings.clear();
+    fields.clear();
+  }
+}
+
+} // namespace xpc
@@ -0,0 +1,67 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_STRINGPOOL_H
+#define LITTLEXPC_STRINGPOOL_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+namespace xpc {
+
+/*
+ * Keeps one shared instance of each string used for AI aircraft metadata. Returned strings are implicitly shared
+ * copies of the pool entries and do not allocate memory.
+ *
+ * Eight byte dataref fields like the TCAS ICAO type or flight id are looked up by their raw value and are decoded
+ * only once. The pool is cleared if it grows too large which does not affect strings already handed out.
+ *
+ * Run in main thread only.
+ */
+class StringPool
+{
+public:
+  StringPool()
+  {
+  }
+
+  StringPool(const StringPool& other) = delete;
+  StringPool& operator=(const StringPool& other) = delete;
+
+  /* String for an UTF-8 field of eight bytes which is terminated or padded by null bytes */
+  QString fromField(quint64 field);
+
+  /* Shared instance equal to value */
+  QString intern(const QString& value);
+
+  /* Number of strings in pool */
+  int size() const
+  {
+    return static_cast<int>(strings.size());
+  }
+
+private:
+  void clearIfFull();
+
+  QHash<quint64, QString> fields;
+  QSet<QString> strings;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_STRINGPOOL_H
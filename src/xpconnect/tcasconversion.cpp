@@ -0,0 +1,231 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/tcasconversion.h"
+
+#include "geo/calculations.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LITTLEXPC_TCAS_X86
+#include <immintrin.h>
+#endif
+
+namespace xpc {
+
+static TcasKernel selectedKernel = TCAS_KERNEL_SCALAR;
+
+/* Factors taken from the atools functions in initTcasConversion() so that all kernels use the same values.
+ * Multiplication is done in double precision like in atools. */
+static double meterToFeetFactor = 1. / 0.3048, feetToMeterFactor = 0.3048, meterPerSecToKnotsFactor = 3600. / 1852.;
+
+/* Value used by atools to mark invalid values which are not converted */
+static const float INVALID_VALUE = std::numeric_limits<float>::max();
+
+/* Reference implementation using the atools functions ======================================= */
+static void convertScalar(TcasArrays& arrays)
+{
+  for(int i = 0; i < TCAS_ARRAY_SIZE; i++)
+  {
+    arrays.altitudeFt[i] = atools::geo::meterToFeet(arrays.elevationMeter[i]);
+    arrays.groundSpeedKts[i] = atools::geo::meterPerSecToKnots(arrays.speedMs[i]);
+
+    // Total speed includes vertical component
+    float speedMs = arrays.speedMs[i];
+    float verticalMs = atools::geo::feetToMeter(arrays.verticalSpeedFpm[i]) / 60.f;
+    arrays.verticalSpeedMs[i] = verticalMs;
+    arrays.horizontalSpeedMs[i] = std::sqrt(std::max(speedMs * speedMs - verticalMs * verticalMs, 0.f));
+
+    arrays.hasPosition[i] = arrays.lonX[i] != 0.f || arrays.latY[i] != 0.f ? -1 : 0;
+  }
+}
+
+#ifdef LITTLEXPC_TCAS_X86
+
+/* SSE2 is always available on x86_64 ======================================= */
+
+/* Multiply four floats in double precision and round back. Invalid values are passed through. */
+static inline __m128 convertSse2(__m128 values, __m128d factor)
+{
+  __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(values), factor));
+  __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(values, values)), factor));
+  __m128 result = _mm_movelh_ps(lo, hi);
+  __m128 invalid = _mm_cmpeq_ps(values, _mm_set1_ps(INVALID_VALUE));
+  return _mm_or_ps(_mm_and_ps(invalid, values), _mm_andnot_ps(invalid, result));
+}
+
+static void convertSse2(TcasArrays& arrays)
+{
+  const __m128d meterToFeet = _mm_set1_pd(meterToFeetFactor), feetToMeter = _mm_set1_pd(feetToMeterFactor),
+                meterPerSecToKnots = _mm_set1_pd(meterPerSecToKnotsFactor);
+  const __m128 zero = _mm_setzero_ps(), sixty = _mm_set1_ps(60.f);
+
+  for(int i = 0; i < TCAS_ARRAY_SIZE; i += 4)
+  {
+    _mm_store_ps(&arrays.altitudeFt[i], convertSse2(_mm_load_ps(&arrays.elevationMeter[i]), meterToFeet));
+
+    __m128 speedMs = _mm_load_ps(&arrays.speedMs[i]);
+    _mm_store_ps(&arrays.groundSpeedKts[i], convertSse2(speedMs, meterPerSecToKnots));
+
+    __m128 verticalMs = _mm_div_ps(convertSse2(_mm_load_ps(&arrays.verticalSpeedFpm[i]), feetToMeter), sixty);
+    _mm_store_ps(&arrays.verticalSpeedMs[i], verticalMs);
+
+    // Zero as first argument to keep NaN and negative zero like std::max
+    __m128 squared = _mm_sub_ps(_mm_mul_ps(speedMs, speedMs), _mm_mul_ps(verticalMs, verticalMs));
+    _mm_store_ps(&arrays.horizontalSpeedMs[i], _mm_sqrt_ps(_mm_max_ps(zero, squared)));
+
+    __m128 hasPosition = _mm_or_ps(_mm_cmpneq_ps(_mm_load_ps(&arrays.lonX[i]), zero), _mm_cmpneq_ps(_mm_load_ps(&arrays.latY[i]), zero));
+    _mm_store_si128(reinterpret_cast<__m128i *>(&arrays.hasPosition[i]), _mm_castps_si128(hasPosition));
+  }
+}
+
+/* AVX2 is selected at runtime ======================================= */
+__attribute__((target("avx2")))
+static inline __m256 convertAvx2(__m256 values, __m256d factor)
+{
+  __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(values)), factor));
+  __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)), factor));
+  __m256 result = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+  return _mm256_blendv_ps(result, values, _mm256_cmp_ps(values, _mm256_set1_ps(INVALID_VALUE), _CMP_EQ_OQ));
+}
+
+__attribute__((target("avx2")))
+static void convertAvx2(TcasArrays& arrays)
+{
+  const __m256d meterToFeet = _mm256_set1_pd(meterToFeetFactor), feetToMeter = _mm256_set1_pd(feetToMeterFactor),
+                meterPerSecToKnots = _mm256_set1_pd(meterPerSecToKnotsFactor);
+  const __m256 zero = _mm256_setzero_ps(), sixty = _mm256_set1_ps(60.f);
+
+  for(int i = 0; i < TCAS_ARRAY_SIZE; i += 8)
+  {
+    _mm256_store_ps(&arrays.altitudeFt[i], convertAvx2(_mm256_load_ps(&arrays.elevationMeter[i]), meterToFeet));
+
+    __m256 speedMs = _mm256_load_ps(&arrays.speedMs[i]);
+    _mm256_store_ps(&arrays.groundSpeedKts[i], convertAvx2(speedMs, meterPerSecToKnots));
+
+    __m256 verticalMs = _mm256_div_ps(convertAvx2(_mm256_load_ps(&arrays.verticalSpeedFpm[i]), feetToMeter), sixty);
+    _mm256_store_ps(&arrays.verticalSpeedMs[i], verticalMs);
+
+    // No fused multiply add to get the same rounding as the scalar code
+    __m256 squared = _mm256_sub_ps(_mm256_mul_ps(speedMs, speedMs), _mm256_mul_ps(verticalMs, verticalMs));
+    _mm256_store_ps(&arrays.horizontalSpeedMs[i], _mm256_sqrt_ps(_mm256_max_ps(zero, squared)));
+
+    __m256 hasPosition = _mm256_or_ps(_mm256_cmp_ps(_mm256_load_ps(&arrays.lonX[i]), zero, _CMP_NEQ_UQ),
+                                      _mm256_cmp_ps(_mm256_load_ps(&arrays.latY[i]), zero, _CMP_NEQ_UQ));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(&arrays.hasPosition[i]), _mm256_castps_si256(hasPosition));
+  }
+}
+
+bool isTcasKernelSupported(TcasKernel kernel)
+{
+  __builtin_cpu_init();
+  switch(kernel)
+  {
+    case TCAS_KERNEL_SCALAR:
+    case TCAS_KERNEL_SSE2:
+      return true;
+
+    case TCAS_KERNEL_AVX2:
+      return __builtin_cpu_supports("avx2");
+  }
+  return false;
+}
+
+#else
+
+bool isTcasKernelSupported(TcasKernel kernel)
+{
+  return kernel == TCAS_KERNEL_SCALAR;
+}
+
+#endif
+
+void convertTcasArrays(TcasArrays& arrays, TcasKernel kernel)
+{
+  switch(kernel)
+  {
+#ifdef LITTLEXPC_TCAS_X86
+    case TCAS_KERNEL_AVX2:
+      convertAvx2(arrays);
+      break;
+
+    case TCAS_KERNEL_SSE2:
+      convertSse2(arrays);
+      break;
+#else
+    case TCAS_KERNEL_AVX2:
+    case TCAS_KERNEL_SSE2:
+#endif
+    case TCAS_KERNEL_SCALAR:
+      convertScalar(arrays);
+      break;
+  }
+}
+
+void convertTcasArrays(TcasArrays& arrays)
+{
+  convertTcasArrays(arrays, selectedKernel);
+}
+
+TcasKernel getTcasKernel()
+{
+  return selectedKernel;
+}
+
+const char *tcasKernelName(TcasKernel kernel)
+{
+  switch(kernel)
+  {
+    case TCAS_KERNEL_SCALAR:
+      return "scalar";
+
+    case TCAS_KERNEL_SSE2:
+      return "SSE2";
+
+    case TCAS_KERNEL_AVX2:
+      return "AVX2";
+  }
+  return "unknown";
+}
+
+void initTcasConversion()
+{
+  // Use the same factors as atools
+  meterToFeetFactor = static_cast<double>(atools::geo::meterToFeet(1.));
+  feetToMeterFactor = static_cast<double>(atools::geo::feetToMeter(1.));
+  meterPerSecToKnotsFactor = static_cast<double>(atools::geo::meterPerSecToKnots(1.));
+
+  // Kernels are checked against the scalar reference in the unit tests
+  selectedKernel = TCAS_KERNEL_SCALAR;
+  for(TcasKernel kernel : {TCAS_KERNEL_AVX2, TCAS_KERNEL_SSE2})
+  {
+    if(isTcasKernelSupported(kernel))
+    {
+      selectedKernel = kernel;
+      break;
+    }
+  }
+
+  qInfo() << Q_FUNC_INFO << "Using" << tcasKernelName(selectedKernel) << "TCAS conversion";
+}
+
+} // namespace xpc
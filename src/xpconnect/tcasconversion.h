@@ -0,0 +1,92 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TCASCONVERSION_H
+#define LITTLEXPC_TCASCONVERSION_H
+
+#include <QtGlobal>
+
+#include <array>
+#include <cstring>
+
+namespace xpc {
+
+/* Length of the TCAS dataref arrays including the user at index 0 */
+static const int TCAS_ARRAY_SIZE = 64;
+
+/*
+ * TCAS values fetched in bulk from the dataref arrays and converted in one pass.
+ * Arrays are aligned and have the full TCAS size which allows the kernels to process whole vectors
+ * without a remainder loop. Entries beyond size are converted too but have to be ignored.
+ */
+struct TcasArrays
+{
+  /* Inputs as fetched from datarefs */
+  alignas(32) std::array<float, TCAS_ARRAY_SIZE> lonX = {}, latY = {}, elevationMeter = {}, speedMs = {}, verticalSpeedFpm = {},
+                                                 headingTrueDeg = {};
+
+  /* Not converted */
+  alignas(32) std::array<int, TCAS_ARRAY_SIZE> modeSId = {};
+
+  /* Strings of eight bytes for each aircraft. Fetched only if needed. */
+  alignas(8) std::array<char, TCAS_ARRAY_SIZE * 8> icaoType = {}, flightId = {};
+
+  /* Outputs. Speed is split into horizontal and vertical component. */
+  alignas(32) std::array<float, TCAS_ARRAY_SIZE> altitudeFt = {}, groundSpeedKts = {}, horizontalSpeedMs = {}, verticalSpeedMs = {};
+
+  /* All bits set if coordinates are not zero. Check Pos::isValid() nonetheless. */
+  alignas(32) std::array<qint32, TCAS_ARRAY_SIZE> hasPosition = {};
+
+  /* Number of entries filled from datarefs */
+  int size = 0;
+
+  /* Raw string field at index from icaoType or flightId for comparison and lookup */
+  static quint64 field(const std::array<char, TCAS_ARRAY_SIZE * 8>& strings, int index)
+  {
+    quint64 value;
+    std::memcpy(&value, strings.data() + index * 8, sizeof(value));
+    return value;
+  }
+};
+
+enum TcasKernel
+{
+  TCAS_KERNEL_SCALAR,
+  TCAS_KERNEL_SSE2,
+  TCAS_KERNEL_AVX2
+};
+
+/* Takes the conversion factors from atools and selects the fastest kernel supported by the CPU.
+ * All kernels give results identical to the atools conversion functions. Call once on startup. */
+void initTcasConversion();
+
+/* True if the CPU supports the kernel. Scalar is always supported. */
+bool isTcasKernelSupported(TcasKernel kernel);
+
+/* Kernel selected in initTcasConversion() */
+TcasKernel getTcasKernel();
+const char *tcasKernelName(TcasKernel kernel);
+
+/* Convert values in arrays with the selected kernel */
+void convertTcasArrays(TcasArrays& arrays);
+
+/* Convert values in arrays with the given kernel which must be supported by the CPU */
+void convertTcasArrays(TcasArrays& arrays, TcasKernel kernel);
+
+} // namespace xpc
+
+#endif // LITTLEXPC_TCASCONVERSION_H
@@ -0,0 +1,143 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/tracer.h"
+
+#ifdef LITTLEXPC_TRACE
+
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace xpc {
+
+namespace {
+
+/* Number of spans per thread - about 1.5 MB for each thread */
+const quint64 BUFFER_SIZE = 65536;
+
+struct Span
+{
+  const char *name;
+  qint64 startNs, endNs;
+};
+
+/* Ring buffer for one thread. Written only by the owning thread. */
+struct ThreadBuffer
+{
+  int tid;
+  QByteArray threadName;
+  std::atomic<quint64> head = 0L; /* Total number of spans added */
+  Span spans[BUFFER_SIZE];
+};
+
+/* All buffers ever created. Buffers are never deleted since thread pool threads come and go
+ * and the dump might be running at the same time. */
+QMutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+
+ThreadBuffer *createBuffer()
+{
+  std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+  QString name = QThread::currentThread()->objectName();
+
+  QMutexLocker locker(&buffersMutex);
+  buffer->tid = static_cast<int>(buffers.size()) + 1;
+  buffer->threadName = name.isEmpty() ? QStringLiteral("Thread %1").arg(buffer->tid).toUtf8() : name.toUtf8();
+  buffers.push_back(std::move(buffer));
+  return buffers.back().get();
+}
+
+/* Buffer is created on first span in a thread. Only this involves a lock. */
+thread_local ThreadBuffer *threadBuffer = nullptr;
+
+} // namespace
+
+qint64 Tracer::nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::addSpan(const char *name, qint64 startNs, qint64 endNs)
+{
+  if(threadBuffer == nullptr)
+    threadBuffer = createBuffer();
+
+  quint64 head = threadBuffer->head.load(std::memory_order_relaxed);
+  threadBuffer->spans[head % BUFFER_SIZE] = {name, startNs, endNs};
+
+  // Publish span to the dumping thread
+  threadBuffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool Tracer::writeChromeTrace(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  QByteArray json("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  char line[256];
+  int numSpans = 0;
+  bool first = true;
+
+  QMutexLocker locker(&buffersMutex);
+  for(const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+  {
+    // Thread name metadata
+    std::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                  first ? "" : ",\n", buffer->tid, buffer->threadName.constData());
+    json.append(line);
+    first = false;
+
+    quint64 head = buffer->head.load(std::memory_order_acquire);
+    quint64 start = head > BUFFER_SIZE ? head - BUFFER_SIZE : 0L;
+    for(quint64 i = start; i < head; i++)
+    {
+      const Span& span = buffer->spans[i % BUFFER_SIZE];
+
+      // Complete event with timestamp and duration in microseconds
+      std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    span.name, buffer->tid, static_cast<double>(span.startNs) / 1000.,
+                    static_cast<double>(span.endNs - span.startNs) / 1000.);
+      json.append(line);
+      numSpans++;
+    }
+  }
+  locker.unlock();
+
+  json.append("\n]}\n");
+  file.write(json);
+  file.close();
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << numSpans << "spans to" << filename;
+  return true;
+}
+
+} // namespace xpc
+
+#endif // LITTLEXPC_TRACE
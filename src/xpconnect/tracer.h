@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TRACER_H
+#define LITTLEXPC_TRACER_H
+
+#include <QtGlobal>
+
+/*
+ * Scoped span tracing which can be exported as Chrome trace JSON and loaded into
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Compiled out completely unless LITTLEXPC_TRACE is defined. Set environment variable
+ * LITTLEXPC_TRACE to "true" when running qmake to enable it.
+ *
+ * Usage: TRACE_SCOPE("name"); at the start of a block. Name has to be a string literal.
+ */
+#ifdef LITTLEXPC_TRACE
+
+#define TRACE_CONCAT_INTERNAL(a, b) a ## b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INTERNAL(a, b)
+#define TRACE_SCOPE(name) xpc::TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+class QString;
+
+namespace xpc {
+
+/*
+ * Collects spans in per-thread ring buffers. Recording a span does not lock or allocate.
+ * Each thread writes only to its own buffer. Oldest spans are overwritten if a buffer is full.
+ */
+class Tracer
+{
+public:
+  /* Record a finished span for the calling thread */
+  static void addSpan(const char *name, qint64 startNs, qint64 endNs);
+
+  /* Write spans of all threads as Chrome trace JSON. Can be called from any thread.
+   * Spans which are overwritten while writing might appear garbled. Returns false on error. */
+  static bool writeChromeTrace(const QString& filename);
+
+  /* Monotonic time used for spans */
+  static qint64 nowNs();
+};
+
+/* Records a span from construction to destruction */
+class TraceScope
+{
+public:
+  explicit TraceScope(const char *spanName)
+    : name(spanName), startNs(Tracer::nowNs())
+  {
+  }
+
+  ~TraceScope()
+  {
+    Tracer::addSpan(name, startNs, Tracer::nowNs());
+  }
+
+  TraceScope(const TraceScope& other) = delete;
+  TraceScope& operator=(const TraceScope& other) = delete;
+
+private:
+  const char *name;
+  qint64 startNs;
+};
+
+} // namespace xpc
+
+#else
+
+#define TRACE_SCOPE(name)
+
+#endif // LITTLEXPC_TRACE
+
+#endif // LITTLEXPC_TRACER_H
@@ -0,0 +1,123 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/trafficfilter.h"
+
+#include "geo/calculations.h"
+#include "settings/settings.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lxc {
+/* key names for atools::settings */
+static const QLatin1String SETTINGS_OPTIONS_TRAFFIC_RADIUS_NM("Options/TrafficRadiusNm");
+static const QLatin1String SETTINGS_OPTIONS_TRAFFIC_MAX_COUNT("Options/TrafficMaxCount");
+}
+
+namespace xpc {
+
+/* Bonus for aircraft which were included in the last update */
+static const float HYSTERESIS_FACTOR = 1.1f;
+
+TrafficFilter *TrafficFilter::createFromSettings()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  float radiusNm = std::max(settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_TRAFFIC_RADIUS_NM, 0.).toFloat(), 0.f);
+  int maxCount = std::max(settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_TRAFFIC_MAX_COUNT, 0).toInt(), 0);
+
+  if(radiusNm > 0.f || maxCount > 0)
+  {
+    qInfo() << Q_FUNC_INFO << "Traffic filter enabled. Radius NM" << radiusNm << "max count" << maxCount;
+    return new TrafficFilter(radiusNm, maxCount);
+  }
+  return nullptr;
+}
+
+TrafficFilter::TrafficFilter(float radiusNmParam, int maxCountParam)
+  : radiusNm(radiusNmParam), maxCount(maxCountParam)
+{
+}
+
+void TrafficFilter::filter(const atools::geo::Pos& center, QList<TrafficCandidate>& candidates)
+{
+  int numCandidates = static_cast<int>(candidates.size());
+
+  // Prefilter with a box in degrees which is larger than the circle - one minute of latitude is one NM
+  float maxRadiusNm = radiusNm * HYSTERESIS_FACTOR;
+  float latRangeDeg = maxRadiusNm / 60.f;
+  float lonRangeDeg = latRangeDeg / std::max(std::cos(atools::geo::toRadians(center.getLatY())), 0.01f);
+
+  // Fill distance and hysteresis flag before removing - predicates must not change elements
+  for(TrafficCandidate& candidate : candidates)
+  {
+    candidate.included = std::binary_search(included.constBegin(), included.constEnd(), candidate.key);
+
+    if(radiusNm > 0.f)
+    {
+      float lonDiff = std::abs(candidate.position.getLonX() - center.getLonX());
+      lonDiff = std::min(lonDiff, 360.f - lonDiff);
+      if(std::abs(candidate.position.getLatY() - center.getLatY()) > latRangeDeg || lonDiff > lonRangeDeg)
+      {
+        // Outside of box - skip exact calculation
+        candidate.distanceNm = std::numeric_limits<float>::max();
+        continue;
+      }
+    }
+    candidate.distanceNm = atools::geo::meterToNm(center.distanceMeterTo(candidate.position));
+  }
+
+  if(radiusNm > 0.f)
+  {
+    auto outside = [this, maxRadiusNm](const TrafficCandidate& candidate) -> bool {
+      return candidate.distanceNm > (candidate.included ? maxRadiusNm : radiusNm);
+    };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), outside), candidates.end());
+  }
+
+  if(maxCount > 0 && candidates.size() > maxCount)
+  {
+    // Rank included ones closer to keep them
+    auto rank = [](const TrafficCandidate& candidate) -> float {
+      return candidate.included ? candidate.distanceNm / HYSTERESIS_FACTOR : candidate.distanceNm;
+    };
+
+    std::nth_element(candidates.begin(), candidates.begin() + maxCount, candidates.end(),
+                     [&rank](const TrafficCandidate& c1, const TrafficCandidate& c2) {
+      return rank(c1) < rank(c2);
+    });
+    candidates.resize(maxCount);
+
+    // Restore slot order to keep ids stable
+    std::sort(candidates.begin(), candidates.end(), [](const TrafficCandidate& c1, const TrafficCandidate& c2) {
+      return c1.index < c2.index;
+    });
+  }
+
+  // Capacity is kept by clear()
+  included.clear();
+  for(const TrafficCandidate& candidate : std::as_const(candidates))
+    included.append(candidate.key);
+  std::sort(included.begin(), included.end());
+
+  numRemoved = numCandidates - static_cast<int>(candidates.size());
+}
+
+} // namespace xpc
@@ -0,0 +1,81 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TRAFFICFILTER_H
+#define LITTLEXPC_TRAFFICFILTER_H
+
+#include "geo/pos.h"
+
+#include <QList>
+
+namespace xpc {
+
+/* AI aircraft to be checked by the filter */
+struct TrafficCandidate
+{
+  quint64 key; /* Identifies the aircraft across updates for hysteresis */
+  int index; /* Slot index in datarefs */
+  atools::geo::Pos position;
+  float distanceNm = 0.f; /* Filled by filter */
+  bool included = false; /* Filled by filter - passed in last update */
+};
+
+/*
+ * Limits AI traffic to aircraft within a radius around the user and to the nearest number of aircraft.
+ * Applied before aircraft files are loaded to limit loader work and payload size.
+ *
+ * An equirectangular check removes far away aircraft cheaply before the great circle distance is
+ * calculated for the remaining ones. Aircraft which passed the filter in the last update get a bonus of ten
+ * percent on radius and ranking to avoid flicker at the boundary.
+ *
+ * Disabled by default. Enabled by setting "Options/TrafficRadiusNm" or "Options/TrafficMaxCount" in
+ * the configuration file to a value larger than zero.
+ *
+ * Run in main thread only.
+ */
+class TrafficFilter
+{
+public:
+  /* Returns a new filter if enabled in settings or null otherwise */
+  static TrafficFilter *createFromSettings();
+
+  /* Radius or count are ignored if zero */
+  TrafficFilter(float radiusNm, int maxCount);
+
+  TrafficFilter(const TrafficFilter& other) = delete;
+  TrafficFilter& operator=(const TrafficFilter& other) = delete;
+
+  /* Remove candidates outside of radius and keep only the nearest. Remaining candidates are in original order. */
+  void filter(const atools::geo::Pos& center, QList<TrafficCandidate>& candidates);
+
+  /* Number of aircraft removed in last call */
+  int getNumRemoved() const
+  {
+    return numRemoved;
+  }
+
+private:
+  float radiusNm;
+  int maxCount, numRemoved = 0;
+
+  /* Sorted keys of aircraft which passed the filter in last call. Reused to avoid allocations. */
+  QList<quint64> included;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_TRAFFICFILTER_H
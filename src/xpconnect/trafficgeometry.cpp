@@ -0,0 +1,109 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/trafficgeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace xpc {
+
+/* Mean earth radius */
+static const double EARTH_RADIUS_NM = 3440.065;
+
+/* Avoid division by zero for aircraft at the same position or with the same velocity */
+static const double MIN_DISTANCE_NM = 1.e-6;
+static const double MIN_SPEED_SQ_KTS = 1.e-6;
+
+static constexpr double toRad(double deg)
+{
+  return deg * std::numbers::pi / 180.;
+}
+
+void TrafficGeometry::clear(int size)
+{
+  for(QList<double> *list : {&latRad, &lonRad})
+  {
+    list->clear();
+    list->reserve(size);
+  }
+  for(QList<float> *list : {&altFt, &velocityEastKts, &velocityNorthKts})
+  {
+    list->clear();
+    list->reserve(size);
+  }
+}
+
+void TrafficGeometry::append(const TrafficKinematics& aircraft)
+{
+  latRad.append(toRad(aircraft.latDeg));
+  lonRad.append(toRad(aircraft.lonDeg));
+  altFt.append(aircraft.altFt);
+  velocityEastKts.append(aircraft.velocityEastKts);
+  velocityNorthKts.append(aircraft.velocityNorthKts);
+}
+
+void TrafficGeometry::calculate(const TrafficKinematics& user)
+{
+  int num = size();
+  for(QList<float> *list : {&distanceNm, &bearingDegTrue, &relAltitudeFt, &closureKts, &cpaTimeSec, &cpaDistanceNm})
+    list->resize(num);
+
+  const double lat0 = toRad(user.latDeg), lon0 = toRad(user.lonDeg);
+  const double sinLat0 = std::sin(lat0), cosLat0 = std::cos(lat0);
+
+  // Raw pointers avoid detach checks of QList in the loop
+  const double *lat = latRad.constData(), *lon = lonRad.constData();
+  const float *alt = altFt.constData(), *velEast = velocityEastKts.constData(), *velNorth = velocityNorthKts.constData();
+  float *dist = distanceNm.data(), *bearing = bearingDegTrue.data(), *relAlt = relAltitudeFt.data(), *closure = closureKts.data(),
+        *cpaTime = cpaTimeSec.data(), *cpaDist = cpaDistanceNm.data();
+
+  for(int i = 0; i < num; i++)
+  {
+    double sinLat = std::sin(lat[i]), cosLat = std::cos(lat[i]);
+    double dLat = lat[i] - lat0;
+    double dLon = std::remainder(lon[i] - lon0, 2. * std::numbers::pi);
+    double sinDLon = std::sin(dLon), cosDLon = std::cos(dLon);
+
+    // Haversine distance and initial course
+    double sinHalfLat = std::sin(dLat / 2.), sinHalfLon = std::sin(dLon / 2.);
+    double a = sinHalfLat * sinHalfLat + cosLat0 * cosLat * sinHalfLon * sinHalfLon;
+    dist[i] = static_cast<float>(2. * std::asin(std::sqrt(std::min(a, 1.))) * EARTH_RADIUS_NM);
+
+    double course = std::atan2(sinDLon * cosLat, cosLat0 * sinLat - sinLat0 * cosLat * cosDLon) * 180. / std::numbers::pi;
+    bearing[i] = static_cast<float>(course < 0. ? course + 360. : course);
+
+    relAlt[i] = alt[i] - user.altFt;
+
+    // Relative position and velocity in local plane - NM and knots
+    double east = dLon * cosLat0 * EARTH_RADIUS_NM, north = dLat * EARTH_RADIUS_NM;
+    double velE = velEast[i] - user.velocityEastKts, velN = velNorth[i] - user.velocityNorthKts;
+    double posDotVel = east * velE + north * velN;
+    double velSq = velE * velE + velN * velN;
+
+    closure[i] = static_cast<float>(-posDotVel / std::max(std::sqrt(east * east + north * north), MIN_DISTANCE_NM));
+
+    // Closest point of approach is now if aircraft are moving apart
+    double cpaHours = velSq > MIN_SPEED_SQ_KTS ? std::max(-posDotVel / velSq, 0.) : 0.;
+    double cpaEast = east + velE * cpaHours, cpaNorth = north + velN * cpaHours;
+    cpaTime[i] = static_cast<float>(cpaHours * 3600.);
+    cpaDist[i] = static_cast<float>(std::sqrt(cpaEast * cpaEast + cpaNorth * cpaNorth));
+  }
+}
+
+} // namespace xpc
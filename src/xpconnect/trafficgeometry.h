@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TRAFFICGEOMETRY_H
+#define LITTLEXPC_TRAFFICGEOMETRY_H
+
+#include <QList>
+
+namespace xpc {
+
+/*
+ * Property ids added to AI aircraft if enabled. Values are float and relative to the user aircraft.
+ * Continues the range of DeadReckoningProp.
+ */
+enum TrafficGeometryProp
+{
+  PROP_XPC_REL_DISTANCE_NM = 0x5810, /* Great circle distance */
+  PROP_XPC_REL_BEARING_DEG_TRUE, /* Initial great circle course from user to AI */
+  PROP_XPC_REL_ALTITUDE_FT, /* Positive if AI is above user */
+  PROP_XPC_REL_CLOSURE_KTS, /* Horizontal closure rate. Positive if approaching. */
+  PROP_XPC_REL_CPA_TIME_SEC, /* Time to horizontal closest point of approach. Zero if diverging. */
+  PROP_XPC_REL_CPA_DISTANCE_NM /* Horizontal distance at closest point of approach */
+};
+
+/* Position and velocity of one aircraft */
+struct TrafficKinematics
+{
+  double latDeg, lonDeg;
+  float altFt, velocityEastKts, velocityNorthKts;
+};
+
+/*
+ * Calculates geometry of all AI aircraft relative to the user aircraft.
+ *
+ * Input and output values are kept in contiguous arrays per field and the calculation runs in one plain loop
+ * over these arrays. Closure rate and closest point of approach are calculated in a local tangent plane around
+ * the user which is sufficient for the usual traffic ranges.
+ *
+ * There are no SIMD kernels like for the TCAS conversion since the great circle needs sin, cos, asin and atan2
+ * which have no SSE2 or AVX2 instructions. Approximations would not match the results of atools.
+ *
+ * Velocities are east and north components in knots. The callers pass the dead reckoning velocity vectors
+ * for user and AI so both use the same reference.
+ *
+ * Used in writer thread only.
+ */
+class TrafficGeometry
+{
+public:
+  TrafficGeometry()
+  {
+  }
+
+  TrafficGeometry(const TrafficGeometry& other) = delete;
+  TrafficGeometry& operator=(const TrafficGeometry& other) = delete;
+
+  /* Clear inputs and reserve space */
+  void clear(int size);
+
+  /* Add one AI aircraft. Index of result is the order of calls. */
+  void append(const TrafficKinematics& aircraft);
+
+  /* Fill result arrays for all aircraft */
+  void calculate(const TrafficKinematics& user);
+
+  int size() const
+  {
+    return static_cast<int>(latRad.size());
+  }
+
+  /* Results indexed like append() calls */
+  QList<float> distanceNm, bearingDegTrue, relAltitudeFt, closureKts, cpaTimeSec, cpaDistanceNm;
+
+private:
+  /* Inputs */
+  QList<double> latRad, lonRad;
+  QList<float> altFt, velocityEastKts, velocityNorthKts;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_TRAFFICGEOMETRY_H
@@ -0,0 +1,110 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xpconnect/userstream.h"
+
+#include <QDebug>
+
+#include <atomic>
+#include <cstring>
+
+namespace xpc {
+
+UserStream::UserStream(const QString& key)
+{
+  sharedMemory.setKey(key);
+}
+
+UserStream::~UserStream()
+{
+  close();
+}
+
+bool UserStream::open()
+{
+  if(isOpen())
+    return true;
+
+  const qsizetype size = sizeof(Header) + sizeof(UserStreamRecord);
+  if(!sharedMemory.create(size, QSharedMemory::ReadWrite))
+  {
+    // Left over from a crashed session or a client created it already
+    if(!sharedMemory.attach(QSharedMemory::ReadWrite))
+    {
+      qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot create or attach" << sharedMemory.key()
+                 << sharedMemory.errorString();
+      return false;
+    }
+
+    if(sharedMemory.size() < size)
+    {
+      qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Segment too small" << sharedMemory.size() << "<" << size;
+      sharedMemory.detach();
+      return false;
+    }
+  }
+
+  // Lock once to initialize - record is only written without lock
+  if(!sharedMemory.lock())
+  {
+    qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot lock" << sharedMemory.key() << sharedMemory.errorString();
+    sharedMemory.detach();
+    return false;
+  }
+
+  header = static_cast<Header *>(sharedMemory.data());
+  data = reinterpret_cast<UserStreamRecord *>(header + 1);
+  std::memset(sharedMemory.data(), 0, static_cast<size_t>(size));
+  header->magic = USER_STREAM_MAGIC;
+  header->version = USER_STREAM_VERSION;
+  header->size = sizeof(UserStreamRecord);
+  sharedMemory.unlock();
+
+  qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Opened" << sharedMemory.key() << "native" << sharedMemory.nativeKey();
+  return true;
+}
+
+void UserStream::close()
+{
+  if(!isOpen())
+    return;
+
+  header = nullptr;
+  data = nullptr;
+  if(!sharedMemory.detach())
+    qWarning() << "LittleXpconnect" << Q_FUNC_INFO << "Cannot detach" << sharedMemory.errorString();
+  else
+    qInfo() << "LittleXpconnect" << Q_FUNC_INFO << "Closed" << sharedMemory.key();
+}
+
+void UserStream::write(const UserStreamRecord& record)
+{
+  if(!isOpen())
+    return;
+
+  // Sequence lock - odd value tells readers that the record is being changed
+  std::atomic_ref<quint32> sequence(header->sequence);
+  quint32 seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(data, &record, sizeof(UserStreamRecord));
+
+  sequence.store(seq + 2, std::memory_order_release);
+}
+
+} // namespace xpc
@@ -0,0 +1,110 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_USERSTREAM_H
+#define LITTLEXPC_USERSTREAM_H
+
+#include <QSharedMemory>
+
+#include <type_traits>
+
+namespace xpc {
+
+/* Key of the shared memory segment for the user aircraft stream */
+static const QLatin1String USER_STREAM_KEY("LittleXpconnectUserStream");
+
+/* Header magic "LXUS" and format version */
+static const quint32 USER_STREAM_MAGIC = 0x4c585553;
+static const quint32 USER_STREAM_VERSION = 1;
+
+/* Flags in UserStreamRecord::flags */
+enum UserStreamFlag : quint32
+{
+  USER_STREAM_ON_GROUND = 0x01,
+  USER_STREAM_PAUSED = 0x02,
+  USER_STREAM_REPLAY = 0x04
+};
+
+/* Position and attitude of the user aircraft for one frame. Native byte order. */
+struct UserStreamRecord
+{
+  qint64 timestampNs; /* Capture time as given by xpc::PerfCounters::monotonicNs() */
+  quint64 frame; /* Flight loop counter */
+  double latitudeDeg, longitudeDeg, altitudeMeter;
+  float aglMeter, headingTrueDeg, headingMagDeg, trackTrueDeg, pitchDeg, rollDeg;
+  float groundSpeedMs, trueAirspeedMs, indicatedSpeedKts, verticalSpeedFpm;
+  quint32 flags; /* UserStreamFlag */
+};
+
+static_assert(std::is_trivially_copyable_v<UserStreamRecord> && std::is_standard_layout_v<UserStreamRecord>);
+
+/*
+ * Publishes the user aircraft on every frame into a small separate shared memory segment.
+ * Avoids the cost of QDataStream and the shared memory lock of the main segment.
+ *
+ * Segment layout in native byte order:
+ *   quint32 magic USER_STREAM_MAGIC
+ *   quint32 version USER_STREAM_VERSION
+ *   quint32 sequence - odd while the record is written
+ *   quint32 size of record
+ *   UserStreamRecord
+ *
+ * The record is protected by a sequence lock. Readers do not lock the segment and retry instead:
+ *   s1 = sequence (acquire); if odd retry
+ *   copy record
+ *   acquire fence; s2 = sequence; if s1 != s2 retry
+ *
+ * Run in main thread only.
+ */
+class UserStream
+{
+public:
+  /* Other keys than USER_STREAM_KEY are used by tests and benchmarks */
+  explicit UserStream(const QString& key = USER_STREAM_KEY);
+  ~UserStream();
+
+  UserStream(const UserStream& other) = delete;
+  UserStream& operator=(const UserStream& other) = delete;
+
+  /* Create or attach the segment. Returns false on error. */
+  bool open();
+
+  /* Detach from segment */
+  void close();
+
+  bool isOpen() const
+  {
+    return header != nullptr;
+  }
+
+  /* Publish record. Does not block. */
+  void write(const UserStreamRecord& record);
+
+private:
+  struct Header
+  {
+    quint32 magic, version, sequence, size;
+  };
+
+  QSharedMemory sharedMemory;
+  Header *header = nullptr;
+  UserStreamRecord *data = nullptr;
+};
+
+} // namespace xpc
+
+#endif // LITTLEXPC_USERSTREAM_H
@@ -18,6 +18,12 @@
 #include "xpconnect/xpconnect.h"
 #include "xpconnect/dataref.h"
 #include "xpconnect/xpdatarefs.h"
+#include "xpconnect/perfcounters.h"
+#include "xpconnect/tcasconversion.h"
+#include "xpconnect/trafficfilter.h"
+#include "xpconnect/trafficgeometry.h"
+#include "xpconnect/tracer.h"
+#include "xpconnect/userstream.h"
 
 #include "aircraftfileloader.h"
 #include "fs/sc/simconnectdata.h"
@@ -28,6 +34,10 @@
 
 #include <QCoreApplication>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 using atools::geo::kgToLbs;
 using atools::geo::meterToFeet;
 using atools::geo::meterToNm;
@@ -36,13 +46,86 @@ using atools::geo::Pos;
 
 namespace xpc {
 
-XpConnect::XpConnect(bool verboseLogging)
-  : verbose(verboseLogging)
+/* Conversions and flags which differ between simulator versions. Specialized per version to avoid
+ * branching in the fetch routine. The datarefs used for each version are defined in the XpDataRefs descriptor table.
+ * Add new version specific values here without touching the other versions. */
+template<XpVersion VERSION>
+struct XpVersionTraits;
+
+template<>
+struct XpVersionTraits<XP11>
+{
+  static constexpr auto SIM_FLAG = atools::fs::sc::SIM_XPLANE11;
+
+  /* "sim/cockpit2/gauges/indicators/wind_speed_kts" is knots */
+  static float windSpeedKts(const XpDataRefs& refs)
+  {
+    return refs.windSpeed.valueFloat();
+  }
+
+  /* "sim/cockpit2/gauges/indicators/wind_heading_deg_mag" is magnetic */
+  static float windDirectionDegT(const XpDataRefs& refs, float magVarDeg)
+  {
+    return atools::geo::normalizeCourse(refs.windDirectionDeg.valueFloat() + magVarDeg);
+  }
+
+  /* "sim/weather/visibility_reported_m" is meter */
+  static float visibilityMeter(const XpDataRefs& refs)
+  {
+    return refs.ambientVisibility.valueFloat();
+  }
+
+};
+
+template<>
+struct XpVersionTraits<XP12>
+{
+  static constexpr auto SIM_FLAG = atools::fs::sc::SIM_XPLANE12;
+
+  /* "sim/weather/aircraft/wind_now_speed_msc" is m/s */
+  static float windSpeedKts(const XpDataRefs& refs)
+  {
+    return atools::geo::meterPerSecToKnots(refs.windSpeed.valueFloat());
+  }
+
+  /* "sim/weather/aircraft/wind_now_direction_degt" is true */
+  static float windDirectionDegT(const XpDataRefs& refs, float)
+  {
+    return refs.windDirectionDeg.valueFloat();
+  }
+
+  /* "sim/weather/aircraft/visibility_reported_sm" */
+  static float visibilityMeter(const XpDataRefs& refs)
+  {
+    return atools::geo::nmToMeter(refs.ambientVisibility.valueFloat());
+  }
+
+};
+
+/* Maximum time between two updates for the dead reckoning check. Longer gaps are usually caused by pause or loading. */
+static const double DEAD_RECKONING_MAX_INTERVAL_SEC = 5.;
+
+/* Add extrapolation values to aircraft properties */
+static void addDeadReckoningProps(atools::fs::sc::SimConnectAircraft& aircraft, float velocityEastMs, float velocityNorthMs,
+                                  float velocityUpMs, float turnRateDegS, double simTimeSec)
+{
+  aircraft.properties.addProp(atools::util::Prop(PROP_XPC_VELOCITY_EAST_MS, velocityEastMs));
+  aircraft.properties.addProp(atools::util::Prop(PROP_XPC_VELOCITY_NORTH_MS, velocityNorthMs));
+  aircraft.properties.addProp(atools::util::Prop(PROP_XPC_VELOCITY_UP_MS, velocityUpMs));
+  aircraft.properties.addProp(atools::util::Prop(PROP_XPC_TURN_RATE_DEG_S, turnRateDegS));
+  aircraft.properties.addProp(atools::util::Prop(PROP_XPC_SIM_TIME_SEC, simTimeSec));
+}
+
+XpConnect::XpConnect(bool verboseLogging, PerfCounters *perfCounters)
+  : counters(perfCounters), verbose(verboseLogging), localProjection(verboseLogging)
 {
   qDebug() << Q_FUNC_INFO;
-  fileLoader = new AircraftFileLoader(verbose);
+  fileLoader = new AircraftFileLoader(verbose, perfCounters);
   fileLoader->setAircraftKeys({QStringLiteral("acf/_name"), QStringLiteral("acf/_ICAO"), QStringLiteral("acf/_tailnum"),
                                QStringLiteral("acf/_is_helicopter"), QStringLiteral("_engn/0/_type")});
+  fileLoader->setStringPool(&stringPool);
+  trafficFilter = TrafficFilter::createFromSettings();
+  initTcasConversion();
 }
 
 XpConnect::~XpConnect()
@@ -50,12 +133,27 @@ XpConnect::~XpConnect()
   qDebug() << Q_FUNC_INFO;
   delete fileLoader;
   delete dataRefs;
+  delete trafficFilter;
 }
 
-bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo)
+bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo,
+                                   bool loadAiAircraftFiles)
 {
+  TRACE_SCOPE("fillSimConnectData");
+
+  // Version was resolved once when initializing datarefs
+  if(dataRefs->getVersion() == XP12)
+    return fillSimConnectDataInternal<XP12>(data, fetchAi, fetchAiAircraftInfo, loadAiAircraftFiles);
+  else
+    return fillSimConnectDataInternal<XP11>(data, fetchAi, fetchAiAircraftInfo, loadAiAircraftFiles);
+}
+
+template<XpVersion VERSION>
+bool XpConnect::fillSimConnectDataInternal(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo,
+                                           bool loadAiAircraftFiles)
+{
+  typedef XpVersionTraits<VERSION> Traits;
   atools::fs::sc::SimConnectUserAircraft& userAircraft = data.userAircraft;
-  bool xp12 = dataRefs->isXplane12();
 
   // Reset user aircraft
   userAircraft = atools::fs::sc::SimConnectUserAircraft();
@@ -75,12 +173,8 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   userAircraft.numberOfEngines = static_cast<quint8>(dataRefs->numberOfEngines.valueInt());
 
   // Wind and ambient parameters
-  userAircraft.windSpeedKts =
-    xp12 ? atools::geo::meterPerSecToKnots(dataRefs->windSpeed.valueFloat()) : dataRefs->windSpeed.valueFloat();
-
-  userAircraft.windDirectionDegT =
-    xp12 ? dataRefs->windDirectionDeg.valueFloat() : atools::geo::normalizeCourse(dataRefs->windDirectionDeg.valueFloat() +
-                                                                                  userAircraft.magVarDeg);
+  userAircraft.windSpeedKts = Traits::windSpeedKts(*dataRefs);
+  userAircraft.windDirectionDegT = Traits::windDirectionDegT(*dataRefs, userAircraft.magVarDeg);
 
   userAircraft.ambientTemperatureCelsius = dataRefs->ambientTemperatureC.valueFloat();
   userAircraft.totalAirTemperatureCelsius = dataRefs->leTemperatureC.valueFloat();
@@ -99,9 +193,10 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   userAircraft.windowIcePercent = static_cast<quint8>(dataRefs->windowIcePercent.valueFloat() * 100.f);
 
   userAircraft.carbIcePercent = 0.f;
-  FloatList carbIce = dataRefs->carbIcePercent.valueFloatArr();
-  for(int i = 0; i < carbIce.size() && i < userAircraft.numberOfEngines; i++)
-    userAircraft.carbIcePercent = static_cast<quint8>(std::max(carbIce.value(i, 0.f) * 100.f,
+  std::array<float, 8> carbIce;
+  int numCarbIce = dataRefs->carbIcePercent.valueFloatArr(carbIce);
+  for(int i = 0; i < numCarbIce && i < userAircraft.numberOfEngines; i++)
+    userAircraft.carbIcePercent = static_cast<quint8>(std::max(carbIce.at(static_cast<size_t>(i)) * 100.f,
                                                                static_cast<float>(userAircraft.carbIcePercent)));
 
   // Weight
@@ -113,9 +208,7 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   userAircraft.fuelTotalWeightLbs = kgToLbs(dataRefs->fuelTotalWeightKgs.valueFloat());
   userAircraft.fuelFlowPPH = kgToLbs(dataRefs->fuelFlowKgSec8.valueFloatArrSum()) * 3600.f;
 
-  userAircraft.ambientVisibilityMeter = dataRefs->isXplane12() ?
-                                        atools::geo::nmToMeter(dataRefs->ambientVisibility.valueFloat()) :
-                                        dataRefs->ambientVisibility.valueFloat();
+  userAircraft.ambientVisibilityMeter = Traits::visibilityMeter(*dataRefs);
 
   // Build local time and use timezone offset from simulator
   // X-Plane does not allow to set the year
@@ -152,6 +245,21 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   // Get transponder code and Convert decimals to octal code
   userAircraft.transponderCode = atools::fs::util::decodeTransponderCode(dataRefs->transponderCode.valueInt());
 
+  // Dead reckoning - local coordinates are x east, y up and z south
+  double simTimeSec = dataRefs->simTimeSec.valueFloat();
+  DeadReckoningState userState;
+  userState.latDeg = dataRefs->latPositionDeg.valueDouble();
+  userState.lonDeg = dataRefs->lonPositionDeg.valueDouble();
+  userState.altMeter = dataRefs->actualAltitudeMeter.valueDouble();
+  userState.velocityEastMs = dataRefs->localVx.valueFloat();
+  userState.velocityNorthMs = -dataRefs->localVz.valueFloat();
+  userState.velocityUpMs = dataRefs->localVy.valueFloat();
+  userState.turnRateDegS = dataRefs->turnRateDegSec.valueFloat();
+  userState.simTimeSec = simTimeSec;
+  addDeadReckoningProps(userAircraft, userState.velocityEastMs, userState.velocityNorthMs, userState.velocityUpMs,
+                        userState.turnRateDegS, simTimeSec);
+  updateUserDeadReckoning(userState, dataRefs->simPaused.valueBool());
+
   // Model
   // points to the tail of the aircraft
   userAircraft.modelRadiusFt = static_cast<quint16>(roundToInt(meterToFeet(dataRefs->aircraftSizeZ.valueFloat())));
@@ -159,7 +267,7 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   // points to the right side of the aircraft - wingspan will be used before model radius for painting
   userAircraft.wingSpanFt = static_cast<quint16>(roundToInt(meterToFeet(dataRefs->aircraftSizeX.valueFloat() * 2.)));
 
-  atools::fs::sc::AircraftFlags simFlags = dataRefs->isXplane12() ? atools::fs::sc::SIM_XPLANE12 : atools::fs::sc::SIM_XPLANE11;
+  atools::fs::sc::AircraftFlags simFlags = Traits::SIM_FLAG;
 
   // Set misc flags
   userAircraft.flags = atools::fs::sc::IS_USER | simFlags;
@@ -178,14 +286,15 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   float fuelMassToVolDivider = 6.f;
 
   // Get the engine array
-  IntList engines = dataRefs->engineType8.valueIntArr();
+  std::array<int, 8> engines;
+  int numEngines = dataRefs->engineType8.valueIntArr(engines);
   userAircraft.engineType = atools::fs::sc::UNSUPPORTED;
   // PISTON = 0, JET = 1, NO_ENGINE = 2, HELO_TURBINE = 3, UNSUPPORTED = 4, TURBOPROP = 5
 
   // Get engine type
-  for(int i = 0; i < engines.size() && i < userAircraft.numberOfEngines; i++)
+  for(int i = 0; i < numEngines && i < userAircraft.numberOfEngines; i++)
   {
-    XpEngineType type = static_cast<XpEngineType>(engines.value(i, xpc::RECIP_CARB));
+    XpEngineType type = static_cast<XpEngineType>(engines.at(static_cast<size_t>(i)));
     switch(type)
     {
       case xpc::ELECTRIC:
@@ -223,20 +332,38 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
   // Load certain values from .acf file overriding dataref values
   fileLoader->loadAircraftFile(userAircraft, 0L);
 
-  data.aiAircraft.clear();
-  if(fetchAi)
+  // Keep AI from last call if updates are reduced
+  bool updateAi = fetchAi && ++aiUpdateCounter >= aiUpdateInterval;
+  if(updateAi)
+    aiUpdateCounter = 0;
+
+  bool resetAi = !fetchAi || updateAi;
+  if(resetAi)
+  {
+    data.aiAircraft.clear();
+    aiTable.beginUpdate();
+  }
+
+  if(updateAi)
   {
     quint32 objId = 1;
 
     // Carrier on first and frigate on second index in arrays
-    FloatList headings = dataRefs->boatHeadingDeg.valueFloatArr();
-    FloatList velocity = dataRefs->boatVelocityMsc.valueFloatArr();
-    FloatList x = dataRefs->boatXMtr.valueFloatArr();
-    FloatList y = dataRefs->boatYMtr.valueFloatArr();
-    FloatList z = dataRefs->boatZMtr.valueFloatArr();
+    std::array<float, 2> headings, velocity, x, y, z;
+    int numBoats = std::min({dataRefs->boatHeadingDeg.valueFloatArr(headings), dataRefs->boatVelocityMsc.valueFloatArr(velocity),
+                             dataRefs->boatXMtr.valueFloatArr(x), dataRefs->boatYMtr.valueFloatArr(y),
+                             dataRefs->boatZMtr.valueFloatArr(z)});
+
+    // Convert all boat positions at once without calling XPLM if close to the origin of the local coordinates
+    std::array<Pos, 2> boatPositions;
+    if(numBoats > 0)
+    {
+      localProjection.update(dataRefs->localLatRef.valueFloat(), dataRefs->localLonRef.valueFloat());
+      localProjection.localToWorld(x, y, z, std::span<Pos>(boatPositions).first(static_cast<size_t>(numBoats)));
+    }
 
     // Add aircraft carrier =============================================================
-    if(headings.size() > 0 && velocity.size() > 0 && x.size() > 0 && y.size() > 0 && z.size() > 0)
+    if(numBoats > 0)
     {
       const static int CARRIER_IDX = 0;
       atools::fs::sc::SimConnectAircraft carrier;
@@ -259,7 +386,7 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
       carrier.objectId = objId;
       carrier.category = atools::fs::sc::CARRIER;
       carrier.engineType = atools::fs::sc::UNSUPPORTED;
-      carrier.position = localToWorld(x.at(CARRIER_IDX), y.at(CARRIER_IDX), z.at(CARRIER_IDX));
+      carrier.position = boatPositions.at(CARRIER_IDX);
       carrier.position.setAltitude(atools::fs::sc::SC_INVALID_FLOAT);
 
       bool ok = true;
@@ -275,7 +402,7 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
     }
 
     // Add frigate =============================================================
-    if(headings.size() > 1 && velocity.size() > 1 && x.size() > 1 && y.size() > 1 && z.size() > 1)
+    if(numBoats > 1)
     {
       const static int FRIGATE_IDX = 1;
       atools::fs::sc::SimConnectAircraft frigate;
@@ -295,7 +422,7 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
       frigate.objectId = objId;
       frigate.category = atools::fs::sc::FRIGATE;
       frigate.engineType = atools::fs::sc::UNSUPPORTED;
-      frigate.position = localToWorld(x.at(FRIGATE_IDX), y.at(FRIGATE_IDX), z.at(FRIGATE_IDX));
+      frigate.position = boatPositions.at(FRIGATE_IDX);
       frigate.position.setAltitude(atools::fs::sc::SC_INVALID_FLOAT);
 
       bool ok = true;
@@ -313,67 +440,96 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
     // Count includes user aircraft
     int numTcasAircraft = dataRefs->tcasNumAcf.valueInt();
     bool hasTcasScheme = dataRefs->tcasModeCcode.isValid();
-    QByteArray icaoTypeArr, flightIdArr;
-    icaoTypeArr.resize(dataRefs->tcasIcaoType.sizeByteArr());
-    flightIdArr.resize(dataRefs->tcasFlightId.sizeByteArr());
 
     // Get AI or multiplayer aircraft ===============================
+    // Candidates with valid positions are collected first and filtered by distance before doing any other work
+    // Aircraft are stored in the traffic table and converted to objects in the writer thread
+    QList<TrafficCandidate> candidates;
+    bool foundTcas = false;
+
     // Use TCAS scheme if there is at least one AI aircraft - ignore user at 0
     if(hasTcasScheme && numTcasAircraft > 1)
     {
-      dataRefs->tcasIcaoType.valueByteArr(icaoTypeArr);
-      dataRefs->tcasFlightId.valueByteArr(flightIdArr);
+      TRACE_SCOPE("tcasLoop");
+
+      // Fetch arrays in one call each and convert units for all aircraft at once
+      TcasArrays& tcas = tcasArrays;
+      tcas.size = std::min({numTcasAircraft, dataRefs->tcasLon.valueFloatArr(tcas.lonX), dataRefs->tcasLat.valueFloatArr(tcas.latY),
+                            dataRefs->tcasEle.valueFloatArr(tcas.elevationMeter), dataRefs->tcasVMsc.valueFloatArr(tcas.speedMs),
+                            dataRefs->tcasVerticalSpeed.valueFloatArr(tcas.verticalSpeedFpm),
+                            dataRefs->tcasPsi.valueFloatArr(tcas.headingTrueDeg), dataRefs->tcasModeSId.valueIntArr(tcas.modeSId)});
+      convertTcasArrays(tcas);
 
       // Use new TCAS scheme - index 0 is user - TCAS arrays also contain user ======================
-      for(int i = 1; i < numTcasAircraft; i++)
+      for(int i = 1; i < tcas.size; i++)
       {
-        Pos pos(dataRefs->tcasLon.valueFloatArr(i), dataRefs->tcasLat.valueFloatArr(i), meterToFeet(dataRefs->tcasEle.valueFloatArr(i)));
-        if(pos.isValid() && !pos.isNull())
+        if(tcas.hasPosition[i])
         {
-          // Coordinates are ok too - must be an AI aircraft
-          atools::fs::sc::SimConnectAircraft aircraft;
-          aircraft.flags = simFlags;
-          aircraft.position = pos;
-          aircraft.headingTrueDeg = dataRefs->tcasPsi.valueFloatArr(i);
-          aircraft.flags.setFlag(atools::fs::sc::ON_GROUND, dataRefs->tcasWeightOnWheels.valueBoolArr(i));
-
-          aircraft.airplaneModel = QString(icaoTypeArr.mid(i * 8, 8));
-          aircraft.airplaneReg = QString(flightIdArr.mid(i * 8, 8));
-
-          // Mark fields as unavailable
-          aircraft.headingMagDeg = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.trueAirspeedKts = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.indicatedAltitudeFt = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.indicatedSpeedKts = atools::fs::sc::SC_INVALID_FLOAT;
-
-          // Ignore the vertical component
-          aircraft.groundSpeedKts = atools::geo::meterPerSecToKnots(dataRefs->tcasVMsc.valueFloatArr(i));
-
-          aircraft.machSpeed = atools::fs::sc::SC_INVALID_FLOAT;
-
-          aircraft.verticalSpeedFeetPerMin = dataRefs->tcasVerticalSpeed.valueFloatArr(i);
-
-          // Get transponder code and Convert decimals to octal code
-          aircraft.transponderCode = atools::fs::util::decodeTransponderCode(dataRefs->tcasModeCcode.valueIntArr(i));
-
-          aircraft.objectId = objId;
-          // aircraft.objectId = static_cast<quint32>(dataRefs->tcasModeSId.valueIntArr(i)) << 4; // Shift to have unique ids with ships
+          Pos pos(tcas.lonX[i], tcas.latY[i], tcas.altitudeFt[i]);
+          if(pos.isValid() && !pos.isNull())
+            // Coordinates are ok too - must be an AI aircraft
+            candidates.append({static_cast<quint64>(tcas.modeSId[i]) << 8 | static_cast<quint64>(i), i, pos});
+        }
+      }
+      foundTcas = !candidates.isEmpty();
 
-          aircraft.category = atools::fs::sc::AIRPLANE;
-          aircraft.engineType = atools::fs::sc::UNSUPPORTED;
+      if(trafficFilter != nullptr)
+        trafficFilter->filter(userAircraft.position, candidates);
 
-          if(fetchAiAircraftInfo)
-            fileLoader->loadAircraftFile(aircraft, static_cast<quint32>(i));
+      if(!candidates.isEmpty())
+      {
+        // Clear remainder if arrays are shorter than expected
+        std::fill(tcas.icaoType.begin() + dataRefs->tcasIcaoType.valueByteArr(tcas.icaoType), tcas.icaoType.end(), '\0');
+        std::fill(tcas.flightId.begin() + dataRefs->tcasFlightId.valueByteArr(tcas.flightId), tcas.flightId.end(), '\0');
+      }
 
-          data.aiAircraft.append(aircraft);
+      aiTable.reserveSlots(tcas.size);
+      aiTable.hasDeadReckoning = true;
+      aiTable.simTimeSec = simTimeSec;
 
-          objId++;
-        } // if(pos.isValid() && !pos.isNull())
-      } // for(int i = 1; i < numTcasAircraft; i++)
+      for(const TrafficCandidate& candidate : std::as_const(candidates))
+      {
+        // Slot is TCAS index
+        int i = candidate.index;
+        bool newSlot = aiTable.useSlot(i, candidate.key);
+        if(newSlot)
+          initAiAircraft(aiTable.aircraft[i], simFlags);
+
+        aiTable.lonX[i] = candidate.position.getLonX();
+        aiTable.latY[i] = candidate.position.getLatY();
+        aiTable.altitudeFt[i] = candidate.position.getAltitude();
+        aiTable.headingTrueDeg[i] = tcas.headingTrueDeg[i];
+        aiTable.onGround[i] = dataRefs->tcasWeightOnWheels.valueBoolArr(i);
+
+        // Ignore the vertical component
+        aiTable.groundSpeedKts[i] = tcas.groundSpeedKts[i];
+        aiTable.verticalSpeedFpm[i] = tcas.verticalSpeedFpm[i];
+
+        // Total speed includes vertical component - split into horizontal vector along heading
+        float headingRad = atools::geo::toRadians(tcas.headingTrueDeg[i]);
+        aiTable.velocityEastMs[i] = tcas.horizontalSpeedMs[i] * std::sin(headingRad);
+        aiTable.velocityNorthMs[i] = tcas.horizontalSpeedMs[i] * std::cos(headingRad);
+        aiTable.velocityUpMs[i] = tcas.verticalSpeedMs[i];
+        aiTable.turnRateDegS[i] = tcasTurnRate(i, tcas.modeSId[i], tcas.headingTrueDeg[i], simTimeSec);
+
+        // Converted to octal code when materializing
+        aiTable.transponderCodes[i] = dataRefs->tcasModeCcode.valueIntArr(i);
+
+        // Decode strings only if the raw fields have changed
+        quint64 model = tcas.field(tcas.icaoType, i), registration = tcas.field(tcas.flightId, i);
+        if(updateAiMetadata(i, newSlot, simFlags, fetchAiAircraftInfo, model, registration))
+        {
+          aiTable.aircraft[i].airplaneModel = stringPool.fromField(model);
+          aiTable.aircraft[i].airplaneReg = stringPool.fromField(registration);
+        }
+        loadAiAircraftFile(i, fetchAiAircraftInfo && loadAiAircraftFiles);
+      } // for(const TrafficCandidate& candidate : candidates)
     } // if(hasTcasScheme && numTcasAircraft > 1)
 
-    if(data.aiAircraft.isEmpty())
+    if(!foundTcas)
     {
+      TRACE_SCOPE("multiplayerLoop");
+
       // Use old multiplayer scheme ============================================
       // Includes user aircraft - can return more than 20 despite providing only datarefs 1-19 (minus user)
       // Add-ons might add more datarefs
@@ -388,45 +544,387 @@ bool XpConnect::fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fe
         Pos pos(ref.lonPositionDegAi.valueFloat(), ref.latPositionDegAi.valueFloat(), meterToFeet(ref.actualAltitudeMeterAi.valueFloat()));
 
         if(pos.isValid() && !pos.isNull())
-        {
           // Coordinates are ok too - must be an AI aircraft
-          atools::fs::sc::SimConnectAircraft aircraft;
-          aircraft.flags = simFlags;
-          aircraft.position = pos;
-          aircraft.headingTrueDeg = ref.headingTrueDegAi.valueFloat();
-          aircraft.airplaneReg = ref.tailnum.valueString();
-
-          // Mark fields as unavailable
-          aircraft.headingMagDeg = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.groundSpeedKts = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.indicatedAltitudeFt = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.indicatedSpeedKts = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.trueAirspeedKts = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.machSpeed = atools::fs::sc::SC_INVALID_FLOAT;
-          aircraft.verticalSpeedFeetPerMin = atools::fs::sc::SC_INVALID_FLOAT;
-
-          aircraft.objectId = objId;
-          aircraft.category = atools::fs::sc::AIRPLANE;
-          aircraft.engineType = atools::fs::sc::UNSUPPORTED;
-
-          if(fetchAiAircraftInfo)
-            fileLoader->loadAircraftFile(aircraft, static_cast<quint32>(i + 1));
-
-          data.aiAircraft.append(aircraft);
-
-          objId++;
-        } // if(pos.isValid() && !pos.isNull())
-      } // for(int i = 0; i < numAi; i++)
-    } // if(numTcasAircraft > 0) ... else ...
-  } // if(fetchAi)
+          candidates.append({static_cast<quint64>(i), i, pos});
+      }
+
+      if(trafficFilter != nullptr)
+        trafficFilter->filter(userAircraft.position, candidates);
+
+      aiTable.reserveSlots(numAi + 1);
+      aiTable.hasDeadReckoning = false;
+
+      for(const TrafficCandidate& candidate : std::as_const(candidates))
+      {
+        // Slot is multiplayer number - user is 0
+        int i = candidate.index, slot = i + 1;
+        const MultiplayerDataRefs& ref = dataRefs->multiplayerDataRefs.at(i);
+        bool newSlot = aiTable.useSlot(slot, candidate.key);
+        if(newSlot)
+          initAiAircraft(aiTable.aircraft[slot], simFlags);
+
+        aiTable.lonX[slot] = candidate.position.getLonX();
+        aiTable.latY[slot] = candidate.position.getLatY();
+        aiTable.altitudeFt[slot] = candidate.position.getAltitude();
+        aiTable.headingTrueDeg[slot] = ref.headingTrueDegAi.valueFloat();
+        aiTable.onGround[slot] = 0;
+
+        // Mark fields as unavailable
+        aiTable.groundSpeedKts[slot] = atools::fs::sc::SC_INVALID_FLOAT;
+        aiTable.verticalSpeedFpm[slot] = atools::fs::sc::SC_INVALID_FLOAT;
+        aiTable.transponderCodes[slot] = -1;
+
+        // Copy into buffer and compare hash to avoid allocation if not changed
+        std::array<char, 64> tailnumBuffer;
+        QByteArrayView tailnum(tailnumBuffer.data(), ref.tailnum.valueByteArr(tailnumBuffer));
+        tailnum.truncate(static_cast<qsizetype>(qstrnlen(tailnum.data(), static_cast<size_t>(tailnum.size()))));
+        if(updateAiMetadata(slot, newSlot, simFlags, fetchAiAircraftInfo, 0L, static_cast<quint64>(qHash(tailnum))))
+          aiTable.aircraft[slot].airplaneReg = stringPool.intern(QString::fromUtf8(tailnum));
+        loadAiAircraftFile(slot, fetchAiAircraftInfo && loadAiAircraftFiles);
+      } // for(const TrafficCandidate& candidate : candidates)
+    } // if(foundTcas) ... else ...
+
+  } // if(updateAi)
+
+  if(resetAi)
+  {
+    aiTable.endUpdate();
+    reportAiTrafficEvents();
+  }
 
   return true;
 }
 
+bool XpConnect::fillUserStreamRecord(UserStreamRecord& record, int flightLoopCounter) const
+{
+  if(dataRefs == nullptr)
+    return false;
+
+  record.latitudeDeg = dataRefs->latPositionDeg.valueDouble();
+  record.longitudeDeg = dataRefs->lonPositionDeg.valueDouble();
+  if(!atools::inRange(-90., 90., record.latitudeDeg) || !atools::inRange(-180., 180., record.longitudeDeg) ||
+     (record.latitudeDeg == 0. && record.longitudeDeg == 0.))
+    return false;
+
+  record.timestampNs = PerfCounters::monotonicNs();
+  record.frame = static_cast<quint64>(flightLoopCounter);
+  record.altitudeMeter = dataRefs->actualAltitudeMeter.valueDouble();
+  record.aglMeter = dataRefs->aglAltitudeMeter.valueFloat();
+
+  record.headingTrueDeg = dataRefs->headingTrueDeg.valueFloat();
+  record.headingMagDeg = dataRefs->headingMagDeg.valueFloat();
+  record.trackTrueDeg = dataRefs->trackTrueDeg.valueFloat();
+  record.pitchDeg = dataRefs->pitchDeg.valueFloat();
+  record.rollDeg = dataRefs->rollDeg.valueFloat();
+
+  record.groundSpeedMs = dataRefs->groundSpeedMs.valueFloat();
+  record.trueAirspeedMs = dataRefs->trueSpeedMs.valueFloat();
+  record.indicatedSpeedKts = dataRefs->indicatedSpeedKts.valueFloat();
+  record.verticalSpeedFpm = dataRefs->verticalSpeedFpm.valueFloat();
+
+  record.flags = 0;
+  if(dataRefs->onGround.valueBool())
+    record.flags |= USER_STREAM_ON_GROUND;
+  if(dataRefs->simPaused.valueBool())
+    record.flags |= USER_STREAM_PAUSED;
+  if(dataRefs->simReplay.valueBool())
+    record.flags |= USER_STREAM_REPLAY;
+  return true;
+}
+
+bool XpConnect::updateAiMetadata(int slot, bool newSlot, atools::fs::sc::AircraftFlags simFlags, bool fetchAiAircraftInfo,
+                                 quint64 rawModel, quint64 rawRegistration)
+{
+  // Remove aircraft file values if switched off by the user
+  if(!fetchAiAircraftInfo && aiTable.aircraftFileLoaded.at(slot))
+  {
+    aiTable.resetMetadata(slot);
+    initAiAircraft(aiTable.aircraft[slot], simFlags);
+  }
+
+  if(aiTable.updateRaw(slot, rawModel, rawRegistration))
+  {
+    // Aircraft file values fill empty strings - apply again after decoding
+    aiTable.aircraftFileLoaded[slot] = 0;
+
+    if(!newSlot)
+      aiTable.setUpdated(slot);
+    return true;
+  }
+  return false;
+}
+
+void XpConnect::loadAiAircraftFile(int slot, bool load)
+{
+  // Repeat until loaded in background or file was found missing
+  if(load && !aiTable.aircraftFileLoaded.at(slot))
+    aiTable.aircraftFileLoaded[slot] = fileLoader->loadAircraftFile(aiTable.aircraft[slot], static_cast<quint32>(slot));
+}
+
+void XpConnect::reportAiTrafficEvents() const
+{
+  int added = 0, updated = 0, removed = 0;
+  for(const AiTrafficEvent& event : aiTable.getEvents())
+  {
+    const char *name = nullptr;
+    switch(event.type)
+    {
+      case AI_ADDED:
+        added++;
+        name = "added";
+        break;
+
+      case AI_UPDATED:
+        updated++;
+        name = "updated";
+        break;
+
+      case AI_REMOVED:
+        removed++;
+        name = "removed";
+        break;
+    }
+
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "AI aircraft" << name << "slot" << event.slot << "object id" << event.objectId
+               << "key" << Qt::hex << event.key;
+  }
+
+  if(added > 0 || updated > 0 || removed > 0)
+    counters->addAiTrafficEvents(added, updated, removed);
+}
+
+void XpConnect::initAiAircraft(atools::fs::sc::SimConnectAircraft& aircraft, atools::fs::sc::AircraftFlags simFlags)
+{
+  aircraft.flags = simFlags;
+
+  // Mark fields as unavailable
+  aircraft.headingMagDeg = atools::fs::sc::SC_INVALID_FLOAT;
+  aircraft.trueAirspeedKts = atools::fs::sc::SC_INVALID_FLOAT;
+  aircraft.indicatedAltitudeFt = atools::fs::sc::SC_INVALID_FLOAT;
+  aircraft.indicatedSpeedKts = atools::fs::sc::SC_INVALID_FLOAT;
+  aircraft.machSpeed = atools::fs::sc::SC_INVALID_FLOAT;
+
+  aircraft.category = atools::fs::sc::AIRPLANE;
+  aircraft.engineType = atools::fs::sc::UNSUPPORTED;
+}
+
+int XpConnect::materializeAiTraffic(const AiTrafficTable& table, atools::fs::sc::SimConnectData& data)
+{
+  TRACE_SCOPE("materializeAiTraffic");
+  data.aiAircraft.reserve(data.aiAircraft.size() + table.getNumValid());
+
+  int num = 0;
+  for(int i = 0; i < table.size(); i++)
+  {
+    if(!table.valid.at(i))
+      continue;
+
+    // Copy strings and aircraft file values - fill the rest from the arrays
+    atools::fs::sc::SimConnectAircraft aircraft(table.aircraft.at(i));
+    aircraft.position = Pos(table.lonX.at(i), table.latY.at(i), table.altitudeFt.at(i));
+    aircraft.headingTrueDeg = table.headingTrueDeg.at(i);
+    aircraft.groundSpeedKts = table.groundSpeedKts.at(i);
+    aircraft.verticalSpeedFeetPerMin = table.verticalSpeedFpm.at(i);
+    aircraft.flags.setFlag(atools::fs::sc::ON_GROUND, table.onGround.at(i));
+    aircraft.objectId = table.objectIds.at(i);
+
+    // Get transponder code and Convert decimals to octal code
+    if(table.transponderCodes.at(i) != -1)
+      aircraft.transponderCode = atools::fs::util::decodeTransponderCode(table.transponderCodes.at(i));
+
+    if(table.hasDeadReckoning)
+      addDeadReckoningProps(aircraft, table.velocityEastMs.at(i), table.velocityNorthMs.at(i), table.velocityUpMs.at(i),
+                            table.turnRateDegS.at(i), table.simTimeSec);
+
+    data.aiAircraft.append(std::move(aircraft));
+    num++;
+  }
+  return num;
+}
+
+QStringList XpConnect::trafficReport(const atools::fs::sc::SimConnectData& data) const
+{
+  QStringList lines;
+
+  const atools::fs::sc::SimConnectUserAircraft& userAircraft = data.userAircraft;
+  QString line;
+  if(userAircraft.isValid())
+    QDebug(&line) << "User id" << userAircraft.objectId << "type" << userAircraft.airplaneType
+                  << "model" << userAircraft.airplaneModel << "reg" << userAircraft.airplaneReg << userAircraft.position;
+  else
+    line = QStringLiteral("User not valid");
+  lines.append(line);
+
+  // Traffic table - aircraft objects are only created in the writer thread
+  lines.append(QStringLiteral("AI traffic table %1").arg(aiTable.getNumValid()));
+  for(int i = 0; i < aiTable.size(); i++)
+  {
+    if(aiTable.valid.at(i))
+    {
+      const atools::fs::sc::SimConnectAircraft& aircraft = aiTable.aircraft.at(i);
+      line.clear();
+      QDebug(&line) << "AI slot" << i << "id" << aiTable.objectIds.at(i) << "type" << aircraft.airplaneType
+                    << "model" << aircraft.airplaneModel << "reg" << aircraft.airplaneReg
+                    << Pos(aiTable.lonX.at(i), aiTable.latY.at(i), aiTable.altitudeFt.at(i));
+      lines.append(line);
+    }
+  }
+
+  // Boats and other objects
+  for(const atools::fs::sc::SimConnectAircraft& aircraft : data.aiAircraft)
+  {
+    line.clear();
+    QDebug(&line) << "AI id" << aircraft.objectId << "type" << aircraft.airplaneType << "model" << aircraft.airplaneModel
+                  << "reg" << aircraft.airplaneReg << aircraft.position;
+    lines.append(line);
+  }
+
+  return lines;
+}
+
+void XpConnect::clearAiTraffic()
+{
+  aiTable.clear();
+  reportAiTrafficEvents();
+}
+
+/* Position with velocity vector converted from meter per second to knots */
+static TrafficKinematics kinematics(const atools::fs::sc::SimConnectAircraft& aircraft, float velocityEastMs, float velocityNorthMs)
+{
+  return {aircraft.position.getLatY(), aircraft.position.getLonX(), aircraft.position.getAltitude(),
+          atools::geo::meterPerSecToKnots(velocityEastMs), atools::geo::meterPerSecToKnots(velocityNorthMs)};
+}
+
+/* Position with velocity from ground speed along heading for aircraft without velocity vector */
+static TrafficKinematics kinematics(const atools::fs::sc::SimConnectAircraft& aircraft)
+{
+  float speedKts = 0.f;
+  if(aircraft.groundSpeedKts < atools::fs::sc::SC_INVALID_FLOAT && aircraft.headingTrueDeg < atools::fs::sc::SC_INVALID_FLOAT)
+    speedKts = aircraft.groundSpeedKts;
+
+  float headingRad = atools::geo::toRadians(aircraft.headingTrueDeg);
+  return {aircraft.position.getLatY(), aircraft.position.getLonX(), aircraft.position.getAltitude(),
+          speedKts * std::sin(headingRad), speedKts * std::cos(headingRad)};
+}
+
+void XpConnect::addTrafficGeometry(atools::fs::sc::SimConnectData& data, const AiTrafficTable& table,
+                                   const DeadReckoningState *userState, TrafficGeometry& geometry)
+{
+  const atools::fs::sc::SimConnectUserAircraft& userAircraft = data.userAircraft;
+  if(!userAircraft.position.isValid() || data.aiAircraft.isEmpty())
+    return;
+
+  int numAircraft = static_cast<int>(data.aiAircraft.size());
+  geometry.clear(numAircraft);
+
+  // Boats and other aircraft before the table aircraft
+  int firstTableIndex = std::max(numAircraft - table.getNumValid(), 0);
+  for(int i = 0; i < firstTableIndex; i++)
+    geometry.append(kinematics(data.aiAircraft.at(i)));
+
+  // Table aircraft in order of valid slots
+  int index = firstTableIndex;
+  for(int slot = 0; slot < table.size() && index < numAircraft; slot++)
+  {
+    if(!table.valid.at(slot))
+      continue;
+
+    const atools::fs::sc::SimConnectAircraft& aircraft = data.aiAircraft.at(index++);
+    if(table.hasDeadReckoning)
+      geometry.append(kinematics(aircraft, table.velocityEastMs.at(slot), table.velocityNorthMs.at(slot)));
+    else
+      geometry.append(kinematics(aircraft));
+  }
+
+  if(userState != nullptr)
+    geometry.calculate(kinematics(userAircraft, userState->velocityEastMs, userState->velocityNorthMs));
+  else
+    geometry.calculate(kinematics(userAircraft));
+
+  for(int i = 0; i < geometry.size(); i++)
+  {
+    // Properties replace the ones from the last update if AI is not updated on every fetch
+    atools::util::Props& props = data.aiAircraft[i].properties;
+    props.addProp(atools::util::Prop(PROP_XPC_REL_DISTANCE_NM, geometry.distanceNm.at(i)));
+    props.addProp(atools::util::Prop(PROP_XPC_REL_BEARING_DEG_TRUE, geometry.bearingDegTrue.at(i)));
+    props.addProp(atools::util::Prop(PROP_XPC_REL_ALTITUDE_FT, geometry.relAltitudeFt.at(i)));
+    props.addProp(atools::util::Prop(PROP_XPC_REL_CLOSURE_KTS, geometry.closureKts.at(i)));
+    props.addProp(atools::util::Prop(PROP_XPC_REL_CPA_TIME_SEC, geometry.cpaTimeSec.at(i)));
+    props.addProp(atools::util::Prop(PROP_XPC_REL_CPA_DISTANCE_NM, geometry.cpaDistanceNm.at(i)));
+  }
+}
+
+void XpConnect::blankAircraftStrings(atools::fs::sc::SimConnectData& data)
+{
+  auto blank = [](atools::fs::sc::SimConnectAircraft& aircraft) {
+    aircraft.airplaneTitle.clear();
+    aircraft.airplaneModel.clear();
+    aircraft.airplaneReg.clear();
+    aircraft.airplaneType.clear();
+  };
+
+  blank(data.userAircraft);
+  for(atools::fs::sc::SimConnectAircraft& aircraft : data.aiAircraft)
+    blank(aircraft);
+}
+
+void XpConnect::updateUserDeadReckoning(const DeadReckoningState& state, bool paused)
+{
+  // Compare the position extrapolated from the last update with the actual one - records accuracy of extrapolation
+  double interval = state.simTimeSec - lastUserState.simTimeSec;
+  if(lastUserStateValid && !paused && interval > 0. && interval < DEAD_RECKONING_MAX_INTERVAL_SEC)
+    counters->addDeadReckoningError(distanceMeter(extrapolateTo(lastUserState, state.simTimeSec), state));
+
+  lastUserState = state;
+  lastUserStateValid = true;
+}
+
+float XpConnect::tcasTurnRate(int index, int modeSId, float headingDeg, double simTimeSec)
+{
+  if(index < 0 || index >= static_cast<int>(tcasHistory.size()))
+    return 0.f;
+
+  TcasHistory& history = tcasHistory.at(static_cast<size_t>(index));
+  float turnRate = 0.f;
+  double interval = simTimeSec - history.simTimeSec;
+  if(history.modeSId == modeSId && interval > 0. && interval < DEAD_RECKONING_MAX_INTERVAL_SEC)
+  {
+    // Shortest angle between headings
+    float diff = headingDeg - history.headingDeg;
+    if(diff > 180.f)
+      diff -= 360.f;
+    else if(diff < -180.f)
+      diff += 360.f;
+    turnRate = static_cast<float>(diff / interval);
+  }
+
+  history.modeSId = modeSId;
+  history.headingDeg = headingDeg;
+  history.simTimeSec = simTimeSec;
+  return turnRate;
+}
+
 void XpConnect::initDataRefs()
 {
   dataRefs = new XpDataRefs;
   dataRefs->init();
 }
 
+void XpConnect::planeLoaded()
+{
+  if(dataRefs != nullptr)
+    dataRefs->updateArraySizes();
+}
+
+int XpConnect::rediscoverDataRefs()
+{
+  return dataRefs != nullptr ? dataRefs->rediscover() : 0;
+}
+
+QList<DataRefEntry> XpConnect::getDataRefEntries() const
+{
+  return dataRefs != nullptr ? dataRefs->getDataRefEntries() : QList<DataRefEntry>();
+}
+
 } // namespace xpc
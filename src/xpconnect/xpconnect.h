@@ -18,7 +18,16 @@
 #ifndef LITTLEXPC_XPCONNECT_H
 #define LITTLEXPC_XPCONNECT_H
 
-#include <QtGlobal>
+#include "xpconnect/aitraffictable.h"
+#include "xpconnect/deadreckoning.h"
+#include "xpconnect/localprojection.h"
+#include "xpconnect/stringpool.h"
+#include "xpconnect/tcasconversion.h"
+
+#include <QList>
+#include <QStringList>
+
+#include <array>
 
 namespace atools {
 namespace fs {
@@ -32,7 +41,13 @@ class SimConnectAircraft;
 namespace xpc {
 
 class AircraftFileLoader;
+class PerfCounters;
+class TrafficFilter;
+class TrafficGeometry;
 class XpDataRefs;
+struct DataRefEntry;
+struct UserStreamRecord;
+enum XpVersion : quint8;
 
 /*
  * Class that has full access to SimConnectData.
@@ -40,23 +55,151 @@ class XpDataRefs;
 class XpConnect
 {
 public:
-  XpConnect(bool verboseLogging);
+  /* Counters are updated by this and the aircraft file loader. */
+  XpConnect(bool verboseLogging, PerfCounters *perfCounters);
   ~XpConnect();
 
   XpConnect(const XpConnect& other) = delete;
   XpConnect& operator=(const XpConnect& other) = delete;
 
   /* Fill SimConnectData from X-Plane datarefs. Returns true if data was found.
+   * Values from aircraft files are removed if fetchAiAircraftInfo is false. loadAiAircraftFiles only stops loading
+   * new files and keeps values already loaded.
    * Runs in XP main loop from "flightLoopCallback()". */
-  bool fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo);
+  bool fillSimConnectData(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo, bool loadAiAircraftFiles);
+
+  /* Fill minimal user aircraft record from datarefs for every frame. Returns false if position is not valid
+   * or datarefs are not initialized yet. Runs in XP main loop. */
+  bool fillUserStreamRecord(UserStreamRecord& record, int flightLoopCounter) const;
+
+  /* Copy the traffic table for materializeAiTraffic(). Called in the writer thread under the same lock
+   * as fillSimConnectData(). */
+  void copyAiTraffic(AiTrafficTable& table) const
+  {
+    aiTable.copyValuesTo(table);
+  }
+
+  /* Append AI aircraft from a copy of the traffic table to the list in data. Returns number of aircraft added.
+   * Called in the writer thread on copies of data and table without holding the lock. */
+  static int materializeAiTraffic(const AiTrafficTable& table, atools::fs::sc::SimConnectData& data);
+
+  /* Remove all aircraft from traffic table. Call if no data was found. */
+  void clearAiTraffic();
+
+  /* Lines describing user, traffic table and other AI aircraft for the verbose log.
+   * Call in main thread under the same lock as fillSimConnectData(). */
+  QStringList trafficReport(const atools::fs::sc::SimConnectData& data) const;
+
+  /* Number of AI aircraft in traffic table */
+  int getNumAiTraffic() const
+  {
+    return aiTable.getNumValid();
+  }
+
+  /* Copy position and velocity of the user aircraft from the last update. Returns false if not available.
+   * Call under the same lock as fillSimConnectData(). */
+  bool copyUserState(DeadReckoningState& state) const
+  {
+    state = lastUserState;
+    return lastUserStateValid;
+  }
+
+  /* Add distance, bearing, relative altitude, closure rate and closest point of approach relative to user
+   * as properties to all AI aircraft. Does not access datarefs and is called in the writer thread.
+   *
+   * Velocities of user and traffic table aircraft are taken from the dead reckoning vectors in userState and table.
+   * The table aircraft have to be the last ones in data as appended by materializeAiTraffic().
+   * Aircraft without velocity vector like boats and multiplayer aircraft use ground speed along heading. */
+  static void addTrafficGeometry(atools::fs::sc::SimConnectData& data, const AiTrafficTable& table,
+                                 const DeadReckoningState *userState, TrafficGeometry& geometry);
+
+  /* Clear title, model, registration and type of user and all AI aircraft.
+   * Called in the writer thread on its copy of the data before serializing. */
+  static void blankAircraftStrings(atools::fs::sc::SimConnectData& data);
 
   /* Initialize the datarefs and print a warning if something is wrong. */
   void initDataRefs();
 
+  /* Fetch AI only every n-th call of fillSimConnectData() and keep the previous AI list in between.
+   * Used to reduce load. */
+  void setAiUpdateInterval(int interval)
+  {
+    aiUpdateInterval = interval;
+  }
+
+  /* True if initDataRefs() was called */
+  bool isDataRefsInitialized() const
+  {
+    return dataRefs != nullptr;
+  }
+
+  /* Called by X-Plane message when an aircraft was loaded. Re-validates cached dataref array sizes. */
+  void planeLoaded();
+
+  /* Look for datarefs which were not found on initialization. Not to be called in the fetch routine.
+   * Returns number of newly found datarefs. */
+  int rediscoverDataRefs();
+
+  /* All valid datarefs for the recorder. Pointers are invalidated by rediscoverDataRefs(). */
+  QList<DataRefEntry> getDataRefEntries() const;
+
 private:
+  /* Specialized for each simulator version using XpVersionTraits in the implementation */
+  template<XpVersion VERSION>
+  bool fillSimConnectDataInternal(atools::fs::sc::SimConnectData& data, bool fetchAi, bool fetchAiAircraftInfo,
+                                  bool loadAiAircraftFiles);
+
+  /* Set values which do not change for TCAS and multiplayer aircraft in a newly used table slot */
+  static void initAiAircraft(atools::fs::sc::SimConnectAircraft& aircraft, atools::fs::sc::AircraftFlags simFlags);
+
+  /* Compare raw string values of a table slot with the last ones. Returns true if strings have to be decoded. */
+  bool updateAiMetadata(int slot, bool newSlot, atools::fs::sc::AircraftFlags simFlags, bool fetchAiAircraftInfo,
+                        quint64 rawModel, quint64 rawRegistration);
+
+  /* Load aircraft file values for a table slot if not done yet and load is true */
+  void loadAiAircraftFile(int slot, bool load);
+
+  /* Print events of the traffic table in verbose mode and count them */
+  void reportAiTrafficEvents() const;
+
+  /* Adds velocity, turn rate and sim time to check dead reckoning for the user aircraft */
+  void updateUserDeadReckoning(const DeadReckoningState& state, bool paused);
+
+  /* Turn rate of TCAS target from heading change since last update. Resets if slot is used by another aircraft. */
+  float tcasTurnRate(int index, int modeSId, float headingDeg, double simTimeSec);
+
+  /* Last heading for each TCAS slot to calculate turn rate */
+  struct TcasHistory
+  {
+    int modeSId = -1;
+    float headingDeg = 0.f;
+    double simTimeSec = 0.;
+  };
+
   AircraftFileLoader *fileLoader;
-  XpDataRefs *dataRefs;
+  PerfCounters *counters;
+  TrafficFilter *trafficFilter = nullptr; /* Null if not enabled in settings */
+  XpDataRefs *dataRefs = nullptr;
   bool verbose = false;
+  int aiUpdateInterval = 1, aiUpdateCounter = 0;
+
+  /* User state from last update to measure accuracy of extrapolation */
+  DeadReckoningState lastUserState;
+  bool lastUserStateValid = false;
+
+  std::array<TcasHistory, 64> tcasHistory;
+
+  /* Converts boat positions from local coordinates */
+  LocalProjection localProjection;
+
+  /* Decoded strings for AI aircraft. Also used by fileLoader. */
+  StringPool stringPool;
+
+  /* Buffers for bulk fetch and conversion of TCAS values */
+  TcasArrays tcasArrays;
+
+  /* TCAS or multiplayer aircraft. Written in main thread and copied by the writer thread under the data lock. */
+  AiTrafficTable aiTable;
 };
 
 } // namespace xpc
@@ -17,220 +17,373 @@
 
 #include "xpdatarefs.h"
 
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <cstdio>
+
 namespace xpc {
 
-void XpDataRefs::init()
-{
-  // AI values - will be updated with number
-  const static QLatin1String MULTIPLAYER_HEADING_DEG_TRUE_AI("sim/multiplayer/position/plane%1_psi");
-  const static QLatin1String MULTIPLAYER_LAT_POSITION_DEG_AI("sim/multiplayer/position/plane%1_lat");
-  const static QLatin1String MULTIPLAYER_LON_POSITION_DEG_AI("sim/multiplayer/position/plane%1_lon");
-  const static QLatin1String MULTIPLAYER_ACTUAL_ALTITUDE_METER_AI("sim/multiplayer/position/plane%1_el");
-  const static QLatin1String MULTIPLAYER_TAILNUM("sim/multiplayer/position/plane%1_tailnum"); // Not standard
+namespace {
 
-  // This is the internal build number - it is a unique integer that always increases and is unique with each beta.
-  // For example, 10.51b5 might be 105105.
-  // There is no guarantee that the build number (last 2 digits) is in sync with the official beta number.
-  xplmVersion.init(QStringLiteral("sim/version/xplane_internal_version"));
-  xplmVersion.find();
+// Shortcuts to keep the table readable
+constexpr XPLMDataTypeID INT = xplmType_Int;
+constexpr XPLMDataTypeID FLOAT = xplmType_Float;
+constexpr XPLMDataTypeID DOUBLE = xplmType_Double;
+constexpr XPLMDataTypeID INT_ARR = xplmType_IntArray;
+constexpr XPLMDataTypeID FLOAT_ARR = xplmType_FloatArray;
+constexpr XPLMDataTypeID DATA = xplmType_Data;
 
+/* *INDENT-OFF* */
+constexpr DataRefDescriptor DESCRIPTORS[] =
+{
+  {&XpDataRefs::simPaused, "sim/time/paused", nullptr, INT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::simReplay, "sim/operation/prefs/replay_mode", nullptr, INT, XP11_XP12, REFRESH_TICK},
+
+  // SimConnectUserAircraft
   // Dataref 'sim/weather/temperature_ambient_c' has been replaced. Please use the new name.
   // Dataref 'sim/weather/temperature_le_c' has been replaced. Please use the new name.
   // Dataref 'sim/weather/visibility_reported_m' has been replaced. Please use the new name.
   // Dataref 'sim/weather/rain_percent' has been replaced. Please use the new name.
   // New "sim/weather/aircraft"
-  bool xp12 = isXplane12();
-
-  simPaused.init(dataRefs, QStringLiteral("sim/time/paused"));
-  simReplay.init(dataRefs, QStringLiteral("sim/operation/prefs/replay_mode"));
-
-  // SimConnectUserAircraft
-  windSpeed.init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/wind_now_speed_msc") /* m/s */ :
-  QStringLiteral("sim/cockpit2/gauges/indicators/wind_speed_kts") /* kts */);
-
-  windDirectionDeg.
-  init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/wind_now_direction_degt") /* true */ :
-  QStringLiteral("sim/cockpit2/gauges/indicators/wind_heading_deg_mag") /* mag */);
+  // XP11 kts - XP12 m/s
+  {&XpDataRefs::windSpeed, "sim/cockpit2/gauges/indicators/wind_speed_kts", "sim/weather/aircraft/wind_now_speed_msc",
+   FLOAT, XP11_XP12, REFRESH_TICK},
+  // XP11 mag - XP12 true
+  {&XpDataRefs::windDirectionDeg, "sim/cockpit2/gauges/indicators/wind_heading_deg_mag", "sim/weather/aircraft/wind_now_direction_degt",
+   FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Temperatures
   // air temperature (SAT) is also called: outside air temperature (OAT) or true air temperature
   // Lower than TAT
-  ambientTemperatureC.init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/temperature_ambient_deg_c") : QStringLiteral("sim/weather/temperature_ambient_c"));
-
+  {&XpDataRefs::ambientTemperatureC, "sim/weather/temperature_ambient_c", "sim/weather/aircraft/temperature_ambient_deg_c",
+   FLOAT, XP11_XP12, REFRESH_TICK},
   // Total air temperature (TAT) is also called: indicated air temperature (IAT) or ram air temperature (RAT)
   // higher than SAT
-  leTemperatureC.init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/temperature_leadingedge_deg_c") : QStringLiteral("sim/weather/temperature_le_c"));
-
-  seaLevelPressurePascal.init(dataRefs, QStringLiteral("sim/physics/earth_pressure_p"));
+  {&XpDataRefs::leTemperatureC, "sim/weather/temperature_le_c", "sim/weather/aircraft/temperature_leadingedge_deg_c",
+   FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::seaLevelPressurePascal, "sim/physics/earth_pressure_p", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Ice
-  pitotIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/pitot_ice"));
-  structuralIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/frm_ice"));
-  structuralIcePercent2.init(dataRefs, QStringLiteral("sim/flightmodel/failures/frm_ice2"));
-  aoaIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/aoa_ice"));
-  aoaIcePercent2.init(dataRefs, QStringLiteral("sim/flightmodel/failures/aoa_ice2"));
-  inletIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/inlet_ice"));
-  propIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/prop_ice"));
-  statIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/stat_ice"));
-  statIcePercent2.init(dataRefs, QStringLiteral("sim/flightmodel/failures/stat_ice2"));
-  windowIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/failures/window_ice"));
-  carbIcePercent.init(dataRefs, QStringLiteral("sim/flightmodel/engine/ENGN_crbice"));
+  {&XpDataRefs::pitotIcePercent, "sim/flightmodel/failures/pitot_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::structuralIcePercent, "sim/flightmodel/failures/frm_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::structuralIcePercent2, "sim/flightmodel/failures/frm_ice2", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::aoaIcePercent, "sim/flightmodel/failures/aoa_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::aoaIcePercent2, "sim/flightmodel/failures/aoa_ice2", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::inletIcePercent, "sim/flightmodel/failures/inlet_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::propIcePercent, "sim/flightmodel/failures/prop_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::statIcePercent, "sim/flightmodel/failures/stat_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::statIcePercent2, "sim/flightmodel/failures/stat_ice2", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::windowIcePercent, "sim/flightmodel/failures/window_ice", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::carbIcePercent, "sim/flightmodel/engine/ENGN_crbice", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
 
   // Weight
-  airplaneTotalWeightKgs.init(dataRefs, QStringLiteral("sim/flightmodel/weight/m_total"));
-  airplaneMaxGrossWeightKgs.init(dataRefs, QStringLiteral("sim/aircraft/weight/acf_m_max"));
-  airplaneEmptyWeightKgs.init(dataRefs, QStringLiteral("sim/aircraft/weight/acf_m_empty"));
-  airplanePayloadWeightKgs.init(dataRefs, QStringLiteral("sim/flightmodel/weight/m_fixed"));
+  {&XpDataRefs::airplaneTotalWeightKgs, "sim/flightmodel/weight/m_total", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::airplaneMaxGrossWeightKgs, "sim/aircraft/weight/acf_m_max", nullptr, FLOAT, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::airplaneEmptyWeightKgs, "sim/aircraft/weight/acf_m_empty", nullptr, FLOAT, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::airplanePayloadWeightKgs, "sim/flightmodel/weight/m_fixed", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
-  // fuelTotalQuantityGallons.init(dataRefs, ""); value calculated
-  fuelTotalWeightKgs.init(dataRefs, QStringLiteral("sim/flightmodel/weight/m_fuel_total"));
+  // fuelTotalQuantityGallons value calculated
+  {&XpDataRefs::fuelTotalWeightKgs, "sim/flightmodel/weight/m_fuel_total", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
-  // Value for up to eight engines
-  fuelFlowKgSec8.init(dataRefs, QStringLiteral("sim/cockpit2/engine/indicators/fuel_flow_kg_sec"));
-  // fuelFlowGPH.init(dataRefs, ""); value calculated
+  // Value for up to eight engines - fuelFlowGPH value calculated
+  {&XpDataRefs::fuelFlowKgSec8, "sim/cockpit2/engine/indicators/fuel_flow_kg_sec", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
 
-  magVarDeg.init(dataRefs, QStringLiteral("sim/flightmodel/position/magnetic_variation"));
-  ambientVisibility.init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/visibility_reported_sm") : QStringLiteral("sim/weather/visibility_reported_m"));
-  trackMagDeg.init(dataRefs, QStringLiteral("sim/cockpit2/gauges/indicators/ground_track_mag_pilot"));
-  // trackTrueDeg.init(dataRefs, ""); value calculated
+  {&XpDataRefs::magVarDeg, "sim/flightmodel/position/magnetic_variation", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  // XP11 meter - XP12 statute miles
+  {&XpDataRefs::ambientVisibility, "sim/weather/visibility_reported_m", "sim/weather/aircraft/visibility_reported_sm",
+   FLOAT, XP11_XP12, REFRESH_TICK},
+  // trackTrueDeg value calculated
+  {&XpDataRefs::trackMagDeg, "sim/cockpit2/gauges/indicators/ground_track_mag_pilot", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Date and time
-  localDateDays.init(dataRefs, QStringLiteral("sim/time/local_date_days")); // 1. Jan = 0
-  localTimeSec.init(dataRefs, QStringLiteral("sim/time/local_time_sec"));
-  zuluTimeSec.init(dataRefs, QStringLiteral("sim/time/zulu_time_sec"));
+  {&XpDataRefs::localDateDays, "sim/time/local_date_days", nullptr, INT, XP11_XP12, REFRESH_TICK}, // 1. Jan = 0
+  {&XpDataRefs::localTimeSec, "sim/time/local_time_sec", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::zuluTimeSec, "sim/time/zulu_time_sec", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // SimConnectAircraft
-  airplaneTailnum.init(dataRefs, QStringLiteral("sim/aircraft/view/acf_tailnum"));
-  airplaneTitle.init(dataRefs, QStringLiteral("sim/aircraft/view/acf_descrip"));
-  airplaneType.init(dataRefs, QStringLiteral("sim/aircraft/view/acf_ICAO"));
-  transponderCode.init(dataRefs, QStringLiteral("sim/cockpit/radios/transponder_code"));
+  {&XpDataRefs::airplaneTailnum, "sim/aircraft/view/acf_tailnum", nullptr, DATA, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::airplaneTitle, "sim/aircraft/view/acf_descrip", nullptr, DATA, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::airplaneType, "sim/aircraft/view/acf_ICAO", nullptr, DATA, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::transponderCode, "sim/cockpit/radios/transponder_code", nullptr, INT, XP11_XP12, REFRESH_TICK},
 
   // Position
-  latPositionDeg.init(dataRefs, QStringLiteral("sim/flightmodel/position/latitude"));
-  lonPositionDeg.init(dataRefs, QStringLiteral("sim/flightmodel/position/longitude"));
+  {&XpDataRefs::latPositionDeg, "sim/flightmodel/position/latitude", nullptr, DOUBLE, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::lonPositionDeg, "sim/flightmodel/position/longitude", nullptr, DOUBLE, XP11_XP12, REFRESH_TICK},
 
   // Speeds
-  indicatedSpeedKts.init(dataRefs, QStringLiteral("sim/flightmodel/position/indicated_airspeed"));
-  trueSpeedMs.init(dataRefs, QStringLiteral("sim/flightmodel/position/true_airspeed"));
-  groundSpeedMs.init(dataRefs, QStringLiteral("sim/flightmodel/position/groundspeed"));
-  machSpeed.init(dataRefs, QStringLiteral("sim/flightmodel/misc/machno"));
-  verticalSpeedFpm.init(dataRefs, QStringLiteral("sim/flightmodel/position/vh_ind_fpm"));
+  {&XpDataRefs::indicatedSpeedKts, "sim/flightmodel/position/indicated_airspeed", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::trueSpeedMs, "sim/flightmodel/position/true_airspeed", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::groundSpeedMs, "sim/flightmodel/position/groundspeed", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::machSpeed, "sim/flightmodel/misc/machno", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::verticalSpeedFpm, "sim/flightmodel/position/vh_ind_fpm", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Altitude
-  indicatedAltitudeFt.init(dataRefs, QStringLiteral("sim/flightmodel/misc/h_ind"));
-  actualAltitudeMeter.init(dataRefs, QStringLiteral("sim/flightmodel/position/elevation"));
-  aglAltitudeMeter.init(dataRefs, QStringLiteral("sim/flightmodel/position/y_agl"));
-
-  autopilotAltitudeFt.init(dataRefs, QStringLiteral("sim/cockpit/autopilot/altitude"));
+  {&XpDataRefs::indicatedAltitudeFt, "sim/flightmodel/misc/h_ind", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::actualAltitudeMeter, "sim/flightmodel/position/elevation", nullptr, DOUBLE, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::aglAltitudeMeter, "sim/flightmodel/position/y_agl", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::autopilotAltitudeFt, "sim/cockpit/autopilot/altitude", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Heading
-  headingTrueDeg.init(dataRefs, QStringLiteral("sim/flightmodel/position/true_psi"));
-  headingMagDeg.init(dataRefs, QStringLiteral("sim/flightmodel/position/mag_psi"));
+  {&XpDataRefs::headingTrueDeg, "sim/flightmodel/position/true_psi", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::headingMagDeg, "sim/flightmodel/position/mag_psi", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  // Flight path - true track
+  {&XpDataRefs::trackTrueDeg, "sim/flightmodel/position/hpath", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+
+  // Attitude - only used for the user aircraft stream
+  {&XpDataRefs::pitchDeg, "sim/flightmodel/position/theta", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::rollDeg, "sim/flightmodel/position/phi", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+
+  // Dead reckoning - velocity in local OpenGL coordinates x east, y up and z south in meter per second
+  {&XpDataRefs::localVx, "sim/flightmodel/position/local_vx", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::localVy, "sim/flightmodel/position/local_vy", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::localVz, "sim/flightmodel/position/local_vz", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  // Yaw rate in degrees per second
+  {&XpDataRefs::turnRateDegSec, "sim/flightmodel/position/R", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::simTimeSec, "sim/time/total_running_time_sec", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Misc
-  numberOfEngines.init(dataRefs, QStringLiteral("sim/aircraft/engine/acf_num_engines"));
-  onGround.init(dataRefs, QStringLiteral("sim/flightmodel/failures/onground_any"));
-  rainPercentage.init(dataRefs, xp12 ? QStringLiteral("sim/weather/aircraft/precipitation_on_aircraft_ratio") : QStringLiteral("sim/weather/rain_percent"));
+  {&XpDataRefs::numberOfEngines, "sim/aircraft/engine/acf_num_engines", nullptr, INT, XP11_XP12, REFRESH_AIRCRAFT},
+  {&XpDataRefs::onGround, "sim/flightmodel/failures/onground_any", nullptr, INT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::rainPercentage, "sim/weather/rain_percent", "sim/weather/aircraft/precipitation_on_aircraft_ratio",
+   FLOAT, XP11_XP12, REFRESH_TICK},
 
   // Size in local coordinates (meter)
   // points to the right side of the aircraft
-  aircraftSizeX.init(dataRefs, QStringLiteral("sim/aircraft/view/acf_size_x"));
+  {&XpDataRefs::aircraftSizeX, "sim/aircraft/view/acf_size_x", nullptr, FLOAT, XP11_XP12, REFRESH_AIRCRAFT},
   // points to the tail of the aircraft
-  aircraftSizeZ.init(dataRefs, QStringLiteral("sim/aircraft/view/acf_size_z"));
+  {&XpDataRefs::aircraftSizeZ, "sim/aircraft/view/acf_size_z", nullptr, FLOAT, XP11_XP12, REFRESH_AIRCRAFT},
 
   // The two X-Plane ships - Index 0=carrier,1=frigate ===========================
   // Heading of the boat in degrees from true north
-  boatHeadingDeg.init(dataRefs, QStringLiteral("sim/world/boat/heading_deg"));
-
+  {&XpDataRefs::boatHeadingDeg, "sim/world/boat/heading_deg", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // Deck height of the frigate (in coordinates of the OBJ model)
-  boatFrigateDeckHeightMtr.init(dataRefs, QStringLiteral("sim/world/boat/frigate_deck_height_mtr"));
-
+  {&XpDataRefs::boatFrigateDeckHeightMtr, "sim/world/boat/frigate_deck_height_mtr", nullptr, FLOAT, XP11_XP12, REFRESH_STATIC},
   // Deck height of the carrier (in coordinates of the OBJ model)
-  boatCarrierDeckHeightMtr.init(dataRefs, QStringLiteral("sim/world/boat/carrier_deck_height_mtr"));
-
+  {&XpDataRefs::boatCarrierDeckHeightMtr, "sim/world/boat/carrier_deck_height_mtr", nullptr, FLOAT, XP11_XP12, REFRESH_STATIC},
   // Velocity of the boat in meters per second in its current direction (value is always null in 11.41 and 11.50)
-  boatVelocityMsc.init(dataRefs, QStringLiteral("sim/world/boat/velocity_msc"));
-
+  {&XpDataRefs::boatVelocityMsc, "sim/world/boat/velocity_msc", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // Position of the boat in meters in the local coordinate OpenGL coordinate system.
-  boatXMtr.init(dataRefs, QStringLiteral("sim/world/boat/x_mtr"));
-  boatYMtr.init(dataRefs, QStringLiteral("sim/world/boat/y_mtr"));
-  boatZMtr.init(dataRefs, QStringLiteral("sim/world/boat/z_mtr"));
+  {&XpDataRefs::boatXMtr, "sim/world/boat/x_mtr", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::boatYMtr, "sim/world/boat/y_mtr", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::boatZMtr, "sim/world/boat/z_mtr", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
+  // Origin of the local coordinate system - changes when X-Plane shifts the origin
+  {&XpDataRefs::localLatRef, "sim/flightmodel/position/lat_ref", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
+  {&XpDataRefs::localLonRef, "sim/flightmodel/position/lon_ref", nullptr, FLOAT, XP11_XP12, REFRESH_TICK},
 
-  engineType8.init(dataRefs, QStringLiteral("sim/aircraft/prop/acf_en_type"));
+  {&XpDataRefs::engineType8, "sim/aircraft/prop/acf_en_type", nullptr, INT_ARR, XP11_XP12, REFRESH_AIRCRAFT},
 
   // ============================================================
   // New TCAS AI/multiplayer interface
   // int integer If TCAS is not overriden by plgugin, returns the number of planes in X-Plane, which might be under plugin control or X-Plane control. If TCAS is overriden, returns how many targets are actually being written to with the override. These are not necessarily consecutive entries in the TCAS arrays.
-  tcasNumAcf.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/indicators/tcas_num_acf"));
-
-  // int[64] integer 24bit (0-16777215 or 0 - 0xFFFFFF) unique ID of the airframe. This is also known as the ADS-B QStringLiteral("hexcode").
-  tcasModeSId.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/modeS_id"));
-
+  {&XpDataRefs::tcasNumAcf, "sim/cockpit2/tcas/indicators/tcas_num_acf", nullptr, INT, XP11_XP12, REFRESH_TICK},
+  // int[64] integer 24bit (0-16777215 or 0 - 0xFFFFFF) unique ID of the airframe. This is also known as the ADS-B "hexcode".
+  {&XpDataRefs::tcasModeSId, "sim/cockpit2/tcas/targets/modeS_id", nullptr, INT_ARR, XP11_XP12, REFRESH_TICK},
   // int[64] integer Mode C transponder code 0000 to 7777. This is not really an integer, this is an octal number.
-  tcasModeCcode.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/modeC_code"));
-
+  {&XpDataRefs::tcasModeCcode, "sim/cockpit2/tcas/targets/modeC_code", nullptr, INT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] degrees global coordinate, degrees.
-  tcasLat.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/lat"));
-
+  {&XpDataRefs::tcasLat, "sim/cockpit2/tcas/targets/position/lat", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] degrees global coordinate, degrees.
-  tcasLon.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/lon"));
-
+  {&XpDataRefs::tcasLon, "sim/cockpit2/tcas/targets/position/lon", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] meter global coordinate, meter.
-  tcasEle.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/ele"));
-
+  {&XpDataRefs::tcasEle, "sim/cockpit2/tcas/targets/position/ele", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] feet/min absolute vertical speed feet per minute.
-  tcasVerticalSpeed.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/vertical_speed"));
-
+  {&XpDataRefs::tcasVerticalSpeed, "sim/cockpit2/tcas/targets/position/vertical_speed", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] meter/s total true speed, norm of local velocity vector. That means it includes vertical speed
-  tcasVMsc.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/V_msc"));
-
+  {&XpDataRefs::tcasVMsc, "sim/cockpit2/tcas/targets/position/V_msc", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // float[64] degrees true heading orientation.
-  tcasPsi.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/psi"));
-
+  {&XpDataRefs::tcasPsi, "sim/cockpit2/tcas/targets/position/psi", nullptr, FLOAT_ARR, XP11_XP12, REFRESH_TICK},
   // int[64]  boolean ground/flight logic. Writeable only when override_TCAS is set.
-  tcasWeightOnWheels.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/position/weight_on_wheels"));
-
+  {&XpDataRefs::tcasWeightOnWheels, "sim/cockpit2/tcas/targets/position/weight_on_wheels", nullptr, INT_ARR, XP11_XP12, REFRESH_TICK},
   // sim/cockpit2/tcas/targets/icao_type  byte[512] y string  7 character ICAO code, terminated by 0 byte. C172, B738, etc...
   // see https://www.icao.int/publications/DOC8643/Pages/Search.aspx
-  tcasIcaoType.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/icao_type"));
-
+  {&XpDataRefs::tcasIcaoType, "sim/cockpit2/tcas/targets/icao_type", nullptr, DATA, XP11_XP12, REFRESH_TICK},
   // sim/cockpit2/tcas/targets/flight_id  byte[512] y string  7 character Flight ID, terminated by 0 byte. ICAO flightplan item 7.
-  tcasFlightId.init(dataRefs, QStringLiteral("sim/cockpit2/tcas/targets/flight_id"));
-
+  {&XpDataRefs::tcasFlightId, "sim/cockpit2/tcas/targets/flight_id", nullptr, DATA, XP11_XP12, REFRESH_TICK},
   // sim/cockpit2/tcas/targets/wake/wing_span_m float[64] y meter wing span of the aircraft creating wake turbulence
+};
+/* *INDENT-ON* */
+
+// AI values - will be updated with number 1 - 64
+constexpr const char *MULTIPLAYER_HEADING_DEG_TRUE_AI = "sim/multiplayer/position/plane%d_psi";
+constexpr const char *MULTIPLAYER_LAT_POSITION_DEG_AI = "sim/multiplayer/position/plane%d_lat";
+constexpr const char *MULTIPLAYER_LON_POSITION_DEG_AI = "sim/multiplayer/position/plane%d_lon";
+constexpr const char *MULTIPLAYER_ACTUAL_ALTITUDE_METER_AI = "sim/multiplayer/position/plane%d_el";
+constexpr const char *MULTIPLAYER_TAILNUM = "sim/multiplayer/position/plane%d_tailnum"; // Not standard
+
+/* Fill name for multiplayer aircraft number into ref */
+void setMultiplayerName(DataRef& ref, const char *format, int number)
+{
+  char name[64];
+  std::snprintf(name, sizeof(name), format, number);
+  ref.setName(QByteArray(name));
+}
+
+} // namespace
+
+std::span<const DataRefDescriptor> XpDataRefs::getDescriptors()
+{
+  return std::span<const DataRefDescriptor>(DESCRIPTORS);
+}
+
+void XpDataRefs::init()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // This is the internal build number - it is a unique integer that always increases and is unique with each beta.
+  // For example, 10.51b5 might be 105105.
+  // There is no guarantee that the build number (last 2 digits) is in sync with the official beta number.
+  xplmVersion.init("sim/version/xplane_internal_version");
+  xplmVersion.find();
+
+  // Resolve once - simulator version does not change during a session
+  version = xplmVersion.valueInt() >= 120000 ? XP12 : XP11;
+
+  // Resolve all datarefs from the table in one pass ============================
+  int found = 0, missing = 0;
+  for(const DataRefDescriptor& descriptor : DESCRIPTORS)
+  {
+    const char *name = descriptor.nameFor(version);
+    if(name == nullptr)
+      // Not available in this simulator version
+      continue;
+
+    DataRef& ref = this->*descriptor.dataRef;
+    ref.init(name);
+
+    if(ref.find())
+    {
+      found++;
+      if((ref.getDataRefType() & descriptor.type) == 0)
+        qWarning() << Q_FUNC_INFO << "Dataref" << ref.getName() << "has type" << ref.getDataRefType()
+                   << "expected" << descriptor.type;
+    }
+    else
+      missing++;
+  }
 
   // ============================================================
   // Old AI/multiplayer interface
-  // Initialize datarefs for the 64 AI aircraft first until an invalid one is found
-  for(int i = 1; i <= 64; i++)
+  findMultiplayerDataRefs(multiplayerDataRefs, true /* warnNotFound */);
+
+  initTimeNs = timer.nsecsElapsed();
+
+  qInfo() << Q_FUNC_INFO << "X-Plane" << (version == XP12 ? 12 : 11) << "found" << found << "missing" << missing
+          << "multiplayer" << multiplayerDataRefs.size() << "in" << (initTimeNs / 1000L) << "us";
+}
+
+QList<DataRefEntry> XpDataRefs::getDataRefEntries() const
+{
+  QList<DataRefEntry> entries;
+
+  if(xplmVersion.isValid())
+    entries.append({&xplmVersion, xplmType_Int});
+
+  for(const DataRefDescriptor& descriptor : DESCRIPTORS)
+  {
+    const DataRef& ref = this->*descriptor.dataRef;
+    if(ref.isValid())
+      entries.append({&ref, descriptor.type});
+  }
+
+  for(const MultiplayerDataRefs& refs : multiplayerDataRefs)
+  {
+    entries.append({&refs.latPositionDegAi, xplmType_Double});
+    entries.append({&refs.lonPositionDegAi, xplmType_Double});
+    entries.append({&refs.headingTrueDegAi, xplmType_Float});
+    entries.append({&refs.actualAltitudeMeterAi, xplmType_Double});
+    if(refs.tailnum.isValid())
+      entries.append({&refs.tailnum, xplmType_Data});
+  }
+  return entries;
+}
+
+int XpDataRefs::findMultiplayerDataRefs(QList<MultiplayerDataRefs>& refsList, bool warnNotFound)
+{
+  int numFound = 0;
+
+  // Tailnum is not standard and might be added later by a plugin
+  for(MultiplayerDataRefs& refs : refsList)
+  {
+    if(!refs.tailnum.isValid() && refs.tailnum.find(false /* warnNotFound */))
+      numFound++;
+  }
+
+  // Initialize datarefs for the 64 AI aircraft until an invalid one is found
+  // List index has to match the aircraft number minus one - stop at first gap
+  for(int i = static_cast<int>(refsList.size()) + 1; i <= 64; i++)
   {
     MultiplayerDataRefs refs;
-    refs.latPositionDegAi.setName(QString(MULTIPLAYER_LAT_POSITION_DEG_AI).arg(i));
-    refs.lonPositionDegAi.setName(QString(MULTIPLAYER_LON_POSITION_DEG_AI).arg(i));
-    refs.headingTrueDegAi.setName(QString(MULTIPLAYER_HEADING_DEG_TRUE_AI).arg(i));
-    refs.actualAltitudeMeterAi.setName(QString(MULTIPLAYER_ACTUAL_ALTITUDE_METER_AI).arg(i));
-    refs.tailnum.setName(QString(MULTIPLAYER_TAILNUM).arg(i));
+    setMultiplayerName(refs.latPositionDegAi, MULTIPLAYER_LAT_POSITION_DEG_AI, i);
+    setMultiplayerName(refs.lonPositionDegAi, MULTIPLAYER_LON_POSITION_DEG_AI, i);
+    setMultiplayerName(refs.headingTrueDegAi, MULTIPLAYER_HEADING_DEG_TRUE_AI, i);
+    setMultiplayerName(refs.actualAltitudeMeterAi, MULTIPLAYER_ACTUAL_ALTITUDE_METER_AI, i);
+    setMultiplayerName(refs.tailnum, MULTIPLAYER_TAILNUM, i);
 
     // Find datarefs
-    refs.latPositionDegAi.find();
-    refs.lonPositionDegAi.find();
-    refs.headingTrueDegAi.find();
-    refs.actualAltitudeMeterAi.find();
+    refs.latPositionDegAi.find(warnNotFound);
+    refs.lonPositionDegAi.find(warnNotFound);
+    refs.headingTrueDegAi.find(warnNotFound);
+    refs.actualAltitudeMeterAi.find(warnNotFound);
     refs.tailnum.find(false /* warnNotFound */);
 
     if(refs.isValid())
+    {
       // Add to the list
-      multiplayerDataRefs.append(refs);
+      refsList.append(refs);
+      numFound++;
+    }
     else
       break;
   }
+  return numFound;
+}
 
-  // Find remaining datarefs of user aircraft
-  for(DataRef *ref : std::as_const(dataRefs))
+int XpDataRefs::rediscover()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  int numFound = 0;
+  for(const DataRefDescriptor& descriptor : DESCRIPTORS)
   {
-    if(!ref->isValid())
-      ref->find();
+    DataRef& ref = this->*descriptor.dataRef;
+    if(!ref.isValid() && descriptor.nameFor(version) != nullptr && ref.find(false /* warnNotFound */))
+    {
+      qInfo() << Q_FUNC_INFO << "Found dataref" << ref.getName();
+      numFound++;
+    }
   }
+
+  // Work on a copy and swap in the complete list at once
+  QList<MultiplayerDataRefs> refsList(multiplayerDataRefs);
+  int numMultiplayerFound = findMultiplayerDataRefs(refsList, false /* warnNotFound */);
+  if(numMultiplayerFound > 0)
+  {
+    multiplayerDataRefs.swap(refsList);
+    numFound += numMultiplayerFound;
+    qInfo() << Q_FUNC_INFO << "Found" << numMultiplayerFound << "new multiplayer datarefs. Now"
+            << multiplayerDataRefs.size() << "aircraft";
+  }
+
+  if(numFound > 0)
+    qInfo() << Q_FUNC_INFO << "Found" << numFound << "datarefs in" << (timer.nsecsElapsed() / 1000L) << "us";
+
+  return numFound;
+}
+
+void XpDataRefs::updateArraySizes()
+{
+  int changed = 0;
+  for(const DataRefDescriptor& descriptor : DESCRIPTORS)
+  {
+    if((this->*descriptor.dataRef).updateArraySize())
+      changed++;
+  }
+
+  if(changed > 0)
+    qDebug() << Q_FUNC_INFO << "Array size changed for" << changed << "datarefs";
 }
 
 } // namespace xpc
@@ -22,8 +22,12 @@
 
 #include <QList>
 
+#include <span>
+
 namespace xpc {
 
+class XpDataRefs;
+
 enum XpEngineType
 {
   // 0 = recip carb, 1 = recip injected, 2 = free turbine, 3 = electric, 4 = lo bypass jet, 5 = hi bypass jet, 6 = rocket, 7 = tip rockets, 8 = fixed turbine
@@ -42,6 +46,50 @@ enum XpEngineType
   NEW_FIXED_TURBINE = 10
 };
 
+/* Simulator versions a dataref is available in. Used as flags. */
+enum XpVersion : quint8
+{
+  XP11 = 0x01,
+  XP12 = 0x02,
+  XP11_XP12 = XP11 | XP12
+};
+
+/* Describes how often a dataref value can change */
+enum DataRefRefresh : quint8
+{
+  REFRESH_TICK, /* Changes continuously - read on every fetch */
+  REFRESH_AIRCRAFT, /* Changes only if an aircraft is loaded */
+  REFRESH_STATIC /* Fixed for a simulator session */
+};
+
+/* Entry in the static dataref registry table. See XpDataRefs::getDescriptors(). */
+struct DataRefDescriptor
+{
+  DataRef XpDataRefs::*dataRef; /* Member in XpDataRefs */
+  const char *name; /* Name for X-Plane 11 and for X-Plane 12 if nameXp12 is null */
+  const char *nameXp12; /* Different name for X-Plane 12 or null */
+  XPLMDataTypeID type; /* Expected type - checked after finding the ref */
+  XpVersion versions; /* Simulators providing this dataref */
+  DataRefRefresh refresh;
+
+  /* Name for the given simulator or null if not available */
+  constexpr const char *nameFor(XpVersion version) const
+  {
+    if((versions & version) == 0)
+      return nullptr;
+    else
+      return version == XP12 && nameXp12 != nullptr ? nameXp12 : name;
+  }
+
+};
+
+/* A found dataref and its expected type. See XpDataRefs::getDataRefEntries(). */
+struct DataRefEntry
+{
+  const DataRef *dataRef;
+  XPLMDataTypeID type;
+};
+
 // Datarefs for one AI or multiplayer aircraft
 struct MultiplayerDataRefs
 {
@@ -74,12 +122,38 @@ public:
   XpDataRefs(const XpDataRefs& other) = delete;
   XpDataRefs& operator=(const XpDataRefs& other) = delete;
 
-  /* Initialize and find all datarefs */
+  /* Initialize and find all datarefs from the descriptor table */
   void init();
 
+  /* Static table of all datarefs resolved by init() excluding version and multiplayer datarefs */
+  static std::span<const DataRefDescriptor> getDescriptors();
+
+  /* All valid datarefs including version and multiplayer datarefs with their expected types */
+  QList<DataRefEntry> getDataRefEntries() const;
+
+  /* Time in nanoseconds needed to resolve all datarefs in init() */
+  qint64 getInitTimeNs() const
+  {
+    return initTimeNs;
+  }
+
+  /* Re-validate cached array sizes of all datarefs. Call when an aircraft was loaded. */
+  void updateArraySizes();
+
+  /* Try to find datarefs which were not available in init(). Plugins might register their datarefs later.
+   * Never call this in the fetch methods. New multiplayer refs are swapped in at once.
+   * Returns number of newly found datarefs. */
+  int rediscover();
+
+  /* Simulator version detected in init() */
+  XpVersion getVersion() const
+  {
+    return version;
+  }
+
   bool isXplane12() const
   {
-    return xplmVersion.valueInt() >= 120000;
+    return version == XP12;
   }
 
   /* Values documented in init() */
@@ -91,7 +165,8 @@ public:
           lonPositionDeg, indicatedSpeedKts, trueSpeedMs, groundSpeedMs, machSpeed, verticalSpeedFpm, indicatedAltitudeFt,
           actualAltitudeMeter, aglAltitudeMeter, autopilotAltitudeFt, headingTrueDeg, headingMagDeg, numberOfEngines, onGround,
           rainPercentage, aircraftSizeX, aircraftSizeZ, boatHeadingDeg, boatFrigateDeckHeightMtr, boatCarrierDeckHeightMtr, boatVelocityMsc,
-          boatXMtr, boatYMtr, boatZMtr, engineType8;
+          boatXMtr, boatYMtr, boatZMtr, localLatRef, localLonRef, engineType8, trackTrueDeg, pitchDeg, rollDeg, localVx, localVy, localVz, turnRateDegSec,
+          simTimeSec;
 
   /* TCAS interface datarefs - all arrays of 64 elements */
   DataRef tcasNumAcf, tcasModeCcode, tcasLat, tcasLon, tcasEle, tcasVerticalSpeed, tcasVMsc, tcasPsi, tcasWeightOnWheels, tcasIcaoType,
@@ -101,11 +176,11 @@ public:
   QList<MultiplayerDataRefs> multiplayerDataRefs;
 
 private:
-  // Contains all datarefs for simple initialization
-  DataRefPtrList dataRefs;
+  /* Find multiplayer datarefs for remaining aircraft numbers and missing tailnums. Returns number of new refs. */
+  static int findMultiplayerDataRefs(QList<MultiplayerDataRefs>& refsList, bool warnNotFound);
 
-  // Contains multiplayer aircraft datarefs
-  DataRefPtrList aiDataRefs;
+  XpVersion version = XP11;
+  qint64 initTimeNs = 0L;
 };
 
 } // namespace xpc
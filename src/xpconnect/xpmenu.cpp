@@ -18,6 +18,7 @@
 #include "xpmenu.h"
 
 #include "settings/settings.h"
+#include "xpconnect/tracer.h"
 
 extern "C" {
 #include "XPLMMenus.h"
@@ -25,12 +26,14 @@ extern "C" {
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
 
 namespace lxc {
 /* key names for atools::settings */
 static const QLatin1String SETTINGS_OPTIONS_FETCH_RATE_MS("Options/FetchRateMs");
 static const QLatin1String SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT("Options/FetchAiAircraft");
 static const QLatin1String SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT_INFO("Options/FetchAiAircraftInfo");
+static const QLatin1String SETTINGS_OPTIONS_STREAM_USER_AIRCRAFT("Options/StreamUserAircraft");
 }
 
 enum MenuId
@@ -38,6 +41,10 @@ enum MenuId
   VERSION = 0,
   FETCH_AI = 1,
   FETCH_AI_INFO = 2,
+  RECORD_DATAREFS = 3,
+  WRITE_TRACE = 4,
+  GOVERNOR_STATE = 5,
+  STREAM_USER_AIRCRAFT = 6,
   FETCH_RATE_50 = 50,
   FETCH_RATE_100 = 100,
   FETCH_RATE_150 = 150,
@@ -46,7 +53,7 @@ enum MenuId
   FETCH_RATE_500 = 500
 };
 
-const static int NUM_MENU_IDS = 9;
+const static int NUM_MENU_IDS = 13;
 
 // Pointer to this is passed to the menu handler by a called menu item
 struct Item
@@ -61,11 +68,13 @@ struct XpMenusPrivate
 {
   XPLMMenuID xpMenuId; // The menu container we'll append all our menu items to
   Item items[NUM_MENU_IDS];
+  int governorItemIndex = -1;
 };
 
 XpMenu::XpMenu()
 {
-  p = new XpMenusPrivate;
+  // Initialize all items since not all are used depending on build options
+  p = new XpMenusPrivate();
 }
 
 XpMenu::~XpMenu()
@@ -80,6 +89,7 @@ void XpMenu::restoreState()
   fetchAi = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT, true).toBool();
   fetchAiAircraftInfo = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT_INFO, true).toBool();
   fetchRateMs = std::max(settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_FETCH_RATE_MS, 200).toInt(), 50);
+  streamUserAircraft = settings.getAndStoreValue(lxc::SETTINGS_OPTIONS_STREAM_USER_AIRCRAFT, false).toBool();
 }
 
 void XpMenu::saveState() const
@@ -88,9 +98,17 @@ void XpMenu::saveState() const
   settings.setValue(lxc::SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT, fetchAi);
   settings.setValue(lxc::SETTINGS_OPTIONS_FETCH_AI_AIRCRAFT_INFO, fetchAiAircraftInfo);
   settings.setValue(lxc::SETTINGS_OPTIONS_FETCH_RATE_MS, fetchRateMs);
+  settings.setValue(lxc::SETTINGS_OPTIONS_STREAM_USER_AIRCRAFT, streamUserAircraft);
   atools::settings::Settings::syncSettings();
 }
 
+void XpMenu::setGovernorState(const QString& text)
+{
+  governorName = QStringLiteral("Load: %1").arg(text).toLatin1();
+  if(p->governorItemIndex != -1)
+    XPLMSetMenuItemName(p->xpMenuId, p->governorItemIndex, governorName.constData(), 0);
+}
+
 void XpMenu::menuHandlerInternal(void *, void *itemRefParam)
 {
   const Item *itemRef = static_cast<Item *>(itemRefParam);
@@ -115,12 +133,32 @@ void XpMenu::menuHandler(int menuId, int itemIndex)
     XPLMCheckMenuItem(p->xpMenuId, itemIndex, check == xplm_Menu_Unchecked ? xplm_Menu_Checked : xplm_Menu_Unchecked);
     fetchAiAircraftInfo = check == xplm_Menu_Unchecked;
   }
+  else if(menuId == STREAM_USER_AIRCRAFT)
+  {
+    // Toggle user stream menu item
+    XPLMMenuCheck check;
+    XPLMCheckMenuItemState(p->xpMenuId, itemIndex, &check);
+    XPLMCheckMenuItem(p->xpMenuId, itemIndex, check == xplm_Menu_Unchecked ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+    streamUserAircraft = check == xplm_Menu_Unchecked;
+  }
+  else if(menuId == RECORD_DATAREFS)
+  {
+    // Toggle recording menu item
+    XPLMMenuCheck check;
+    XPLMCheckMenuItemState(p->xpMenuId, itemIndex, &check);
+    XPLMCheckMenuItem(p->xpMenuId, itemIndex, check == xplm_Menu_Unchecked ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+    recordDataRefs = check == xplm_Menu_Unchecked;
+  }
+#ifdef LITTLEXPC_TRACE
+  else if(menuId == WRITE_TRACE)
+    xpc::Tracer::writeChromeTrace(QDir::temp().filePath(QStringLiteral("little_xpconnect_trace.json")));
+#endif
   else if(menuId >= FETCH_RATE_50 && menuId <= FETCH_RATE_500)
   {
     // First deselect all rate items
     for(const Item& itemRef : p->items)
     {
-      if(itemRef.menuId != FETCH_AI && itemRef.menuId != FETCH_AI_INFO)
+      if(itemRef.menuId >= FETCH_RATE_50 && itemRef.menuId <= FETCH_RATE_500)
         XPLMCheckMenuItem(p->xpMenuId, itemRef.xpItemIndex, xplm_Menu_Unchecked);
     }
 
@@ -128,7 +166,8 @@ void XpMenu::menuHandler(int menuId, int itemIndex)
     XPLMCheckMenuItem(p->xpMenuId, itemIndex, xplm_Menu_Checked);
     fetchRateMs = menuId;
   }
-  qInfo() << "fetchAi" << fetchAi << "fetchAircraftInfo" << fetchAiAircraftInfo << "fetchRate" << fetchRateMs;
+  qInfo() << "fetchAi" << fetchAi << "fetchAircraftInfo" << fetchAiAircraftInfo << "fetchRate" << fetchRateMs
+          << "streamUserAircraft" << streamUserAircraft << "recordDataRefs" << recordDataRefs;
 }
 
 void XpMenu::addMenu(const QString& menuNameParam)
@@ -148,6 +187,16 @@ void XpMenu::addMenu(const QString& menuNameParam)
   p->items[idx] = {VERSION, menuIndex, this};
   idx++;
 
+  // Updated by setGovernorState()
+  if(governorName.isEmpty())
+    governorName = "Load: Normal";
+  menuIndex = XPLMAppendMenuItem(p->xpMenuId, governorName.constData(), static_cast<void *>(&p->items[idx]), 1);
+  XPLMCheckMenuItem(p->xpMenuId, menuIndex, xplm_Menu_NoCheck);
+  XPLMEnableMenuItem(p->xpMenuId, menuIndex, 0);
+  p->items[idx] = {GOVERNOR_STATE, menuIndex, this};
+  p->governorItemIndex = menuIndex;
+  idx++;
+
   XPLMAppendMenuSeparator(p->xpMenuId);
 
   menuIndex = XPLMAppendMenuItem(p->xpMenuId, "Fetch AI", static_cast<void *>(&p->items[idx]), 1);
@@ -191,4 +240,23 @@ void XpMenu::addMenu(const QString& menuNameParam)
   XPLMCheckMenuItem(p->xpMenuId, menuIndex, fetchRateMs > 375 ? xplm_Menu_Checked : xplm_Menu_Unchecked);
   p->items[idx] = {FETCH_RATE_500, menuIndex, this};
   idx++;
+
+  XPLMAppendMenuSeparator(p->xpMenuId);
+
+  menuIndex = XPLMAppendMenuItem(p->xpMenuId, "Stream User Aircraft every Frame", static_cast<void *>(&p->items[idx]), 1);
+  XPLMCheckMenuItem(p->xpMenuId, menuIndex, streamUserAircraft ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  p->items[idx] = {STREAM_USER_AIRCRAFT, menuIndex, this};
+  idx++;
+
+  menuIndex = XPLMAppendMenuItem(p->xpMenuId, "Record Datarefs", static_cast<void *>(&p->items[idx]), 1);
+  XPLMCheckMenuItem(p->xpMenuId, menuIndex, recordDataRefs ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  p->items[idx] = {RECORD_DATAREFS, menuIndex, this};
+  idx++;
+
+#ifdef LITTLEXPC_TRACE
+  menuIndex = XPLMAppendMenuItem(p->xpMenuId, "Write Trace", static_cast<void *>(&p->items[idx]), 1);
+  XPLMCheckMenuItem(p->xpMenuId, menuIndex, xplm_Menu_NoCheck);
+  p->items[idx] = {WRITE_TRACE, menuIndex, this};
+  idx++;
+#endif
 }
@@ -56,6 +56,21 @@ public:
     return fetchAiAircraftInfo;
   }
 
+  /* Publish user aircraft on every frame into a separate segment */
+  bool isStreamUserAircraft() const
+  {
+    return streamUserAircraft;
+  }
+
+  /* Record all datarefs to a capture file. Not saved in settings. */
+  bool isRecordDataRefs() const
+  {
+    return recordDataRefs;
+  }
+
+  /* Show frame governor state in disabled menu item */
+  void setGovernorState(const QString& text);
+
   /* Restore values from settings. Call before addMenu() */
   void restoreState();
 
@@ -69,10 +84,10 @@ private:
   static void menuHandlerInternal(void *, void *itemRefParam);
 
   int fetchRateMs = 200;
-  bool fetchAi = true, fetchAiAircraftInfo = true;
+  bool fetchAi = true, fetchAiAircraftInfo = true, recordDataRefs = false, streamUserAircraft = false;
 
   XpMenusPrivate *p;
-  QByteArray menuName, versionName;
+  QByteArray menuName, versionName, governorName;
 };
 
 #endif // XPMENU_H
@@ -0,0 +1,92 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstddef>
+
+#if defined(__GLIBC__)
+
+namespace {
+std::atomic<quint64> numAllocations = 0L, numBytes = 0L;
+
+void count(size_t bytes)
+{
+  numAllocations.fetch_add(1, std::memory_order_relaxed);
+  numBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+} // namespace
+
+/* Replace the allocation functions of the C library for the whole program - memory is still managed by glibc */
+extern "C" {
+void *__libc_malloc(size_t size) noexcept;
+void *__libc_calloc(size_t num, size_t size) noexcept;
+void *__libc_realloc(void *ptr, size_t size) noexcept;
+
+void *malloc(size_t size) noexcept
+{
+  count(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size) noexcept
+{
+  count(num * size);
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+  count(size);
+  return __libc_realloc(ptr, size);
+}
+
+}
+
+namespace xpctest {
+
+AllocationCount getAllocationCount()
+{
+  return {numAllocations.load(std::memory_order_relaxed), numBytes.load(std::memory_order_relaxed)};
+}
+
+bool isAllocationCountSupported()
+{
+  return true;
+}
+
+} // namespace xpctest
+
+#else
+
+namespace xpctest {
+
+AllocationCount getAllocationCount()
+{
+  return AllocationCount();
+}
+
+bool isAllocationCountSupported()
+{
+  return false;
+}
+
+} // namespace xpctest
+
+#endif
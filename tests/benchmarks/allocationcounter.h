@@ -0,0 +1,41 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_ALLOCATIONCOUNTER_H
+#define LITTLEXPC_ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+namespace xpctest {
+
+/* Number of heap allocations and requested bytes in all threads since program start */
+struct AllocationCount
+{
+  quint64 allocations = 0L, bytes = 0L;
+};
+
+/*
+ * Counts calls of malloc(), calloc() and realloc() which covers operator new as well as the allocations
+ * of Qt containers. Only supported with the GNU C library where the functions can be replaced in the
+ * executable. Counts are always zero otherwise.
+ */
+AllocationCount getAllocationCount();
+bool isAllocationCountSupported();
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_ALLOCATIONCOUNTER_H
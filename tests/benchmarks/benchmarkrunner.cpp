@@ -0,0 +1,125 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "benchmarkrunner.h"
+
+#include "allocationcounter.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace xpctest {
+
+BenchmarkRunner::BenchmarkRunner(qint64 minTimeMs, const QRegularExpression& filterParam)
+  : minTimeNs(minTimeMs * 1000000L), filter(filterParam)
+{
+}
+
+bool BenchmarkRunner::isSelected(const QString& name) const
+{
+  return filter.match(name).hasMatch();
+}
+
+void BenchmarkRunner::run(const QString& name, const std::function<void()>& operation, qint64 outputBytes, qint64 budgetNs)
+{
+  if(!isSelected(name))
+    return;
+
+  // Warm up caches and lazy initialization
+  operation();
+
+  // Increase iterations until the minimum time is reached - only the last run is used
+  qint64 iterations = 1L, elapsedNs = 0L;
+  AllocationCount allocations;
+  while(true)
+  {
+    AllocationCount start = getAllocationCount();
+    QElapsedTimer timer;
+    timer.start();
+
+    for(qint64 i = 0; i < iterations; i++)
+      operation();
+
+    elapsedNs = std::max(timer.nsecsElapsed(), 1LL);
+    AllocationCount end = getAllocationCount();
+    allocations = {end.allocations - start.allocations, end.bytes - start.bytes};
+
+    if(elapsedNs >= minTimeNs)
+      break;
+
+    // Aim for 20 percent above minimum time but grow at least twice and at most a hundred times
+    qint64 predicted = static_cast<qint64>(static_cast<double>(minTimeNs) * 1.2 / static_cast<double>(elapsedNs) *
+                                           static_cast<double>(iterations));
+    iterations = std::clamp(predicted, iterations * 2, iterations * 100);
+  }
+
+  double count = static_cast<double>(iterations);
+  Result result = {name, iterations, static_cast<double>(elapsedNs) / count, static_cast<double>(allocations.allocations) / count,
+                   static_cast<double>(allocations.bytes) / count, outputBytes, budgetNs};
+  results.append(result);
+
+  if(progress != nullptr)
+    *progress << qSetFieldWidth(48) << Qt::left << result.name << qSetFieldWidth(0)
+              << qSetFieldWidth(12) << Qt::right << QString::number(result.nsPerOp, 'f', 1) << qSetFieldWidth(0) << " ns/op"
+              << qSetFieldWidth(10) << QString::number(result.allocsPerOp, 'f', 2) << qSetFieldWidth(0) << " allocs/op"
+              << qSetFieldWidth(12) << QString::number(result.bytesPerOp, 'f', 1) << qSetFieldWidth(0) << " B/op"
+              << qSetFieldWidth(10) << result.outputBytes << qSetFieldWidth(0) << " B out"
+              << (result.isOverBudget() ? QStringLiteral(" OVER BUDGET %1 ns").arg(result.budgetNs) : QString()) << Qt::endl;
+}
+
+bool BenchmarkRunner::isOverBudget() const
+{
+  return std::any_of(results.begin(), results.end(), [](const Result& result) {
+    return result.isOverBudget();
+  });
+}
+
+QByteArray BenchmarkRunner::toJson() const
+{
+  QJsonArray benchmarkArr;
+  for(const Result& result : results)
+  {
+    QJsonObject obj;
+    obj.insert(QStringLiteral("name"), result.name);
+    obj.insert(QStringLiteral("iterations"), result.iterations);
+    obj.insert(QStringLiteral("ns_per_op"), result.nsPerOp);
+    obj.insert(QStringLiteral("allocs_per_op"), result.allocsPerOp);
+    obj.insert(QStringLiteral("bytes_per_op"), result.bytesPerOp);
+    obj.insert(QStringLiteral("output_bytes"), result.outputBytes);
+    if(result.budgetNs > 0L)
+    {
+      obj.insert(QStringLiteral("budget_ns"), result.budgetNs);
+      obj.insert(QStringLiteral("over_budget"), result.isOverBudget());
+    }
+    benchmarkArr.append(obj);
+  }
+
+  QJsonObject root;
+  root.insert(QStringLiteral("version"), QStringLiteral(VERSION_NUMBER_LITTLEXPCONNECT));
+  root.insert(QStringLiteral("revision"), QStringLiteral(GIT_REVISION_LITTLEXPCONNECT));
+  root.insert(QStringLiteral("min_time_ms"), minTimeNs / 1000000L);
+  root.insert(QStringLiteral("allocation_count_supported"), isAllocationCountSupported());
+  root.insert(QStringLiteral("benchmarks"), benchmarkArr);
+  return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+} // namespace xpctest
@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_BENCHMARKRUNNER_H
+#define LITTLEXPC_BENCHMARKRUNNER_H
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+#include <functional>
+
+class QTextStream;
+
+namespace xpctest {
+
+/* Keep the compiler from removing calculations whose result is not used */
+template<typename TYPE>
+inline void doNotOptimize(const TYPE& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile ("" : : "r,m" (value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+#endif
+}
+
+/*
+ * Runs benchmark operations repeatedly for a minimum time and collects time, heap allocations and bytes
+ * allocated per operation. Results can be written as JSON to compare releases.
+ */
+class BenchmarkRunner
+{
+public:
+  /* Each operation is repeated until minTimeMs have passed. Only names matching filter are run. */
+  BenchmarkRunner(qint64 minTimeMs, const QRegularExpression& filterParam);
+
+  /* True if a benchmark with the given name would be run. Use to skip expensive setup. */
+  bool isSelected(const QString& name) const;
+
+  /* Run operation repeatedly if name matches the filter. outputBytes is the size of the data produced by
+   * one operation like serialized bytes and is reported as is. The operation fails if budgetNs is not zero and
+   * the time per operation exceeds it. */
+  void run(const QString& name, const std::function<void()>& operation, qint64 outputBytes = 0L, qint64 budgetNs = 0L);
+
+  /* True if any operation run with a budget exceeded it */
+  bool isOverBudget() const;
+
+  /* Results as JSON object with version and an array "benchmarks" having name, iterations, ns_per_op,
+   * allocs_per_op, bytes_per_op and output_bytes for each benchmark. Benchmarks with a budget also have
+   * budget_ns and over_budget. */
+  QByteArray toJson() const;
+
+  /* Print a result line after each benchmark to the stream. Default is null. */
+  void setProgressStream(QTextStream *value)
+  {
+    progress = value;
+  }
+
+private:
+  struct Result
+  {
+    QString name;
+    qint64 iterations;
+    double nsPerOp, allocsPerOp, bytesPerOp;
+    qint64 outputBytes, budgetNs;
+
+    bool isOverBudget() const
+    {
+      return budgetNs > 0L && nsPerOp > static_cast<double>(budgetNs);
+    }
+  };
+
+  QList<Result> results;
+  qint64 minTimeNs;
+  QRegularExpression filter;
+  QTextStream *progress = nullptr;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_BENCHMARKRUNNER_H
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "benchmarkrunner.h"
+#include "pipelinebenchmarks.h"
+#include "userstreambenchmarks.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+
+/*
+ * Runs micro benchmarks of the plugin stages against the XPLM stub and prints results as JSON to stdout or
+ * into a file. Progress is printed to stderr. Returns 2 if a benchmark exceeds its time budget.
+ *
+ * Settings are written to a temporary folder to keep the configuration of a local installation untouched.
+ */
+
+namespace {
+
+/* Drop debug and info messages of the plugin which would distort the results */
+void messageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+  if(type != QtDebugMsg && type != QtInfoMsg)
+    QTextStream(stderr) << message << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("Little Xpconnect Benchmarks"));
+  QCoreApplication::setOrganizationName(QStringLiteral("ABarthel"));
+  QCoreApplication::setApplicationVersion(QStringLiteral(VERSION_NUMBER_LITTLEXPCONNECT));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("Runs benchmarks of Little Xpconnect against a stub of the X-Plane plugin API "
+                                                  "and prints ns/op, allocations/op and bytes/op as JSON."));
+  parser.addHelpOption();
+  QCommandLineOption timeOpt(QStringLiteral("time"), QStringLiteral("Minimum run time for each benchmark. Default is 500."),
+                             QStringLiteral("milliseconds"), QStringLiteral("500"));
+  QCommandLineOption filterOpt(QStringLiteral("filter"), QStringLiteral("Run only benchmarks with names matching the "
+                                                                        "regular expression."),
+                               QStringLiteral("regexp"), QStringLiteral("."));
+  QCommandLineOption outputOpt(QStringLiteral("output"), QStringLiteral("Write JSON to file instead of stdout."),
+                               QStringLiteral("file"));
+  QCommandLineOption acfOpt(QStringLiteral("acf"), QStringLiteral("Also read up to ten .acf files found in this folder. "
+                                                                  "Use the folder \"Aircraft\" of X-Plane for example."),
+                            QStringLiteral("folder"));
+  parser.addOptions({timeOpt, filterOpt, outputOpt, acfOpt});
+  parser.process(app);
+
+  QRegularExpression filter(parser.value(filterOpt));
+  if(!filter.isValid())
+  {
+    QTextStream(stderr) << "Invalid filter: " << filter.errorString() << Qt::endl;
+    return 1;
+  }
+
+  // Keep settings away from a real installation
+  QTemporaryDir configDir, fileDir;
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(configDir.path()));
+  qInstallMessageHandler(messageHandler);
+
+  QTextStream progress(stderr);
+  xpctest::BenchmarkRunner runner(std::max(1LL, parser.value(timeOpt).toLongLong()), filter);
+  runner.setProgressStream(&progress);
+
+  xpctest::runPipelineBenchmarks(runner, fileDir.path());
+  xpctest::runAircraftFileBenchmarks(runner, fileDir.path(), parser.value(acfOpt));
+  xpctest::runDataRefBenchmarks(runner);
+  xpctest::runUserStreamBenchmarks(runner);
+
+  if(parser.isSet(outputOpt))
+  {
+    QFile file(parser.value(outputOpt));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      QTextStream(stderr) << "Cannot open " << file.fileName() << ": " << file.errorString() << Qt::endl;
+      return 1;
+    }
+    file.write(runner.toJson());
+  }
+  else
+  {
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    out.write(runner.toJson());
+  }
+
+  if(runner.isOverBudget())
+  {
+    QTextStream(stderr) << "Benchmarks over budget" << Qt::endl;
+    return 2;
+  }
+  return 0;
+}
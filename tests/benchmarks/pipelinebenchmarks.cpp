@@ -0,0 +1,272 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "pipelinebenchmarks.h"
+
+#include "aircraftfiles.h"
+#include "benchmarkrunner.h"
+#include "simulator.h"
+#include "xplmstub.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "fs/sc/xpconnecthandler.h"
+#include "xpconnect/aircraftfileloader.h"
+#include "xpconnect/dataref.h"
+#include "xpconnect/perfcounters.h"
+#include "xpconnect/sharedmemorywriter.h"
+#include "xpconnect/xpconnect.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSharedMemory>
+#include <QThread>
+
+#include <array>
+#include <utility>
+
+namespace xpctest {
+
+namespace {
+
+/* Same as in XpConnect */
+const QStringList AIRCRAFT_KEYS = {QStringLiteral("acf/_name"), QStringLiteral("acf/_ICAO"), QStringLiteral("acf/_tailnum"),
+                                   QStringLiteral("acf/_is_helicopter"), QStringLiteral("_engn/0/_type")};
+
+/* Properties in generated files for the fetch benchmarks - loading is done before measuring */
+const int NUM_FETCH_FILE_PROPERTIES = 1000;
+
+/* Targets spread around the default user position with different types and directions */
+QList<TcasTarget> createTargets(int num)
+{
+  const QList<AircraftFile>& types = getAircraftFileTypes();
+  UserAircraft user;
+
+  QList<TcasTarget> targets;
+  for(int i = 0; i < num; i++)
+  {
+    const AircraftFile& type = types.at(i % types.size());
+    TcasTarget target;
+    target.modeSId = 0x3c0000 + i;
+    target.modeCCode = 1000 + i;
+    target.latDeg = static_cast<float>(user.latDeg + (i / 8 - 4) * 0.1);
+    target.lonDeg = static_cast<float>(user.lonDeg + (i % 8 - 4) * 0.15);
+    target.altMeter = 1000.f + i * 100.f;
+    target.headingTrueDeg = static_cast<float>((i * 37) % 360);
+    target.speedMs = 120.f;
+    target.verticalSpeedFpm = (i % 3 - 1) * 500.f;
+    target.icaoType = type.icao.toLatin1();
+    target.flightId = QStringLiteral("DLH%1").arg(i).toLatin1();
+    targets.append(target);
+  }
+  return targets;
+}
+
+/* Fetch until the aircraft file loader has finished in the background to measure cached values only */
+void waitForAircraftFiles(xpc::XpConnect& xpConnect, const xpc::PerfCounters& counters, atools::fs::sc::SimConnectData& data)
+{
+  for(int i = 0; i < 5000; i++)
+  {
+    xpConnect.fillSimConnectData(data, true, true, true);
+    if(i > 0 && counters.getLoaderQueueDepth() == 0)
+      break;
+    QThread::msleep(1);
+  }
+
+  // Apply loaded values
+  xpConnect.fillSimConnectData(data, true, true, true);
+}
+
+} // namespace
+
+void runPipelineBenchmarks(BenchmarkRunner& runner, const QString& tempDir)
+{
+  QSharedMemory sharedMemory(QStringLiteral("LittleXpconnectBenchmark"));
+  if(!sharedMemory.create(atools::fs::sc::SHARED_MEMORY_SIZE) && !sharedMemory.attach())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create shared memory" << sharedMemory.errorString();
+    return;
+  }
+
+  for(int numAi : {0, 16, 63})
+  {
+    QString suffix = QStringLiteral("/ai_%1").arg(numAi);
+
+    // Simulator with TCAS targets and an aircraft file for each =====================
+    setupSimulator();
+    setSimulatorTime(100.);
+    setTcasTargets(createTargets(numAi));
+
+    QDir fileDir(QDir(tempDir).filePath(QStringLiteral("fetch_%1").arg(numAi)));
+    fileDir.mkpath(QStringLiteral("."));
+    xplmstub::setAircraftModels(writeAircraftFiles(fileDir.path(), numAi + 1, NUM_FETCH_FILE_PROPERTIES));
+
+    xpc::PerfCounters counters;
+    xpc::XpConnect xpConnect(false, &counters);
+    xpConnect.initDataRefs();
+
+    atools::fs::sc::SimConnectData data;
+    waitForAircraftFiles(xpConnect, counters, data);
+
+    // Fetch from datarefs into data and traffic table in main thread ========================
+    runner.run(QStringLiteral("XpConnect::fillSimConnectData") + suffix, [&xpConnect, &data]() {
+      xpConnect.fillSimConnectData(data, true, true, true);
+    });
+
+    // Serialize in writer thread ========================
+    xpc::AiTrafficTable table;
+    xpConnect.copyAiTraffic(table);
+    atools::fs::sc::SimConnectData writerData = data;
+    xpc::XpConnect::materializeAiTraffic(table, writerData);
+
+    // New buffer for each update like in SharedMemoryWriter
+    auto serialize = [&writerData]() -> QByteArray {
+                       QByteArray bytes;
+                       QBuffer buffer(&bytes);
+                       buffer.open(QIODevice::WriteOnly);
+                       writerData.write(&buffer);
+                       return bytes;
+                     };
+
+    QByteArray simDataBytes = serialize();
+    runner.run(QStringLiteral("SimConnectData::write") + suffix, [&serialize]() {
+      doNotOptimize(serialize());
+    }, simDataBytes.size());
+
+    // Copy into shared memory ========================
+    xpc::LatencyTimestamps timestamps;
+    qint64 bytesWritten = SharedMemoryWriter::writeData(sharedMemory, simDataBytes, false, timestamps);
+    runner.run(QStringLiteral("SharedMemoryWriter::writeData") + suffix, [&sharedMemory, &simDataBytes, &timestamps]() {
+      SharedMemoryWriter::writeData(sharedMemory, simDataBytes, false, timestamps);
+    }, bytesWritten);
+
+    // All stages in one thread without handover - same sequence as in SharedMemoryWriter ==================
+    runner.run(QStringLiteral("pipeline") + suffix, [&]() {
+      xpConnect.fillSimConnectData(data, true, true, true);
+      xpConnect.copyAiTraffic(table);
+      writerData = data;
+      xpc::XpConnect::materializeAiTraffic(table, writerData);
+
+      QByteArray bytes;
+      QBuffer buffer(&bytes);
+      buffer.open(QIODevice::WriteOnly);
+      writerData.write(&buffer);
+      buffer.close();
+
+      SharedMemoryWriter::writeData(sharedMemory, bytes, false, timestamps);
+    }, bytesWritten);
+  }
+
+  sharedMemory.detach();
+}
+
+void runAircraftFileBenchmarks(BenchmarkRunner& runner, const QString& tempDir, const QString& acfDir)
+{
+  // Generated files with keys at the end like in files of X-Plane ================
+  QList<std::pair<QString, QString> > files;
+  const AircraftFile& type = getAircraftFileTypes().constFirst();
+  for(int numProperties : {2000, 60000})
+  {
+    QString name = QStringLiteral("generated_%1").arg(numProperties);
+    files.append({name, writeAircraftFile(tempDir, name + QStringLiteral(".acf"), type, numProperties)});
+  }
+
+  // Real files ================
+  if(!acfDir.isEmpty())
+  {
+    QStringList realFiles;
+    QDirIterator it(acfDir, {QStringLiteral("*.acf")}, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+      realFiles.append(it.next());
+
+    realFiles.sort();
+    for(const QString& file : realFiles.mid(0, 10))
+      files.append({QFileInfo(file).completeBaseName(), file});
+
+    if(realFiles.isEmpty())
+      qWarning() << Q_FUNC_INFO << "No .acf files found in" << acfDir;
+  }
+
+  for(const std::pair<QString, QString>& file : std::as_const(files))
+  {
+    QString filepath = file.second;
+    runner.run(QStringLiteral("AircraftFileLoader::readValuesFromAircraftFile/") + file.first, [&filepath]() {
+      xpc::AircraftFileLoader::AircraftEntryType keyValuePairs;
+      xpc::AircraftFileLoader::readValuesFromAircraftFile(keyValuePairs, filepath, AIRCRAFT_KEYS, false);
+      doNotOptimize(keyValuePairs);
+    }, QFileInfo(filepath).size());
+  }
+}
+
+void runDataRefBenchmarks(BenchmarkRunner& runner)
+{
+  setupSimulator();
+  setTcasTargets(createTargets(63));
+
+  DataRef groundSpeed, latitude, tcasLat, tcasModeSId, tcasIcaoType;
+  groundSpeed.init("sim/flightmodel/position/groundspeed");
+  latitude.init("sim/flightmodel/position/latitude");
+  tcasLat.init("sim/cockpit2/tcas/targets/position/lat");
+  tcasModeSId.init("sim/cockpit2/tcas/targets/modeS_id");
+  tcasIcaoType.init("sim/cockpit2/tcas/targets/icao_type");
+  for(DataRef *ref : {&groundSpeed, &latitude, &tcasLat, &tcasModeSId, &tcasIcaoType})
+    ref->find();
+
+  // Scalars ===================
+  runner.run(QStringLiteral("DataRef::valueFloat"), [&groundSpeed]() {
+    doNotOptimize(groundSpeed.valueFloat());
+  });
+  runner.run(QStringLiteral("DataRef::valueDouble"), [&latitude]() {
+    doNotOptimize(latitude.valueDouble());
+  });
+
+  // Bulk array access into buffers without allocation ===================
+  std::array<float, 64> floats;
+  std::array<int, 64> ints;
+  std::array<char, 512> bytes;
+  runner.run(QStringLiteral("DataRef::valueFloatArr/span_64"), [&tcasLat, &floats]() {
+    doNotOptimize(tcasLat.valueFloatArr(floats));
+  }, static_cast<qint64>(sizeof(floats)));
+  runner.run(QStringLiteral("DataRef::valueIntArr/span_64"), [&tcasModeSId, &ints]() {
+    doNotOptimize(tcasModeSId.valueIntArr(ints));
+  }, static_cast<qint64>(sizeof(ints)));
+  runner.run(QStringLiteral("DataRef::valueByteArr/span_512"), [&tcasIcaoType, &bytes]() {
+    doNotOptimize(tcasIcaoType.valueByteArr(bytes));
+  }, static_cast<qint64>(sizeof(bytes)));
+
+  // Array access into lists ===================
+  FloatList floatList;
+  runner.run(QStringLiteral("DataRef::valueFloatArr/list_64"), [&tcasLat, &floatList]() {
+    tcasLat.valueFloatArr(floatList);
+  }, static_cast<qint64>(sizeof(floats)));
+  runner.run(QStringLiteral("DataRef::valueFloatArr/return_64"), [&tcasLat]() {
+    doNotOptimize(tcasLat.valueFloatArr());
+  }, static_cast<qint64>(sizeof(floats)));
+  runner.run(QStringLiteral("DataRef::valueByteArr/return_512"), [&tcasIcaoType]() {
+    doNotOptimize(tcasIcaoType.valueByteArr());
+  }, static_cast<qint64>(sizeof(bytes)));
+
+  // Single elements as used for values read only for a few aircraft ===================
+  runner.run(QStringLiteral("DataRef::valueFloatArr/index_x64"), [&tcasLat]() {
+    for(int i = 0; i < 64; i++)
+      doNotOptimize(tcasLat.valueFloatArr(i));
+  }, static_cast<qint64>(sizeof(floats)));
+}
+
+} // namespace xpctest
@@ -0,0 +1,41 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_PIPELINEBENCHMARKS_H
+#define LITTLEXPC_PIPELINEBENCHMARKS_H
+
+#include <QString>
+
+namespace xpctest {
+
+class BenchmarkRunner;
+
+/* Benchmarks for each stage of the fetch, serialize and publish pipeline and the whole pipeline in one thread
+ * with 0, 16 and 63 TCAS targets. 63 is the maximum since the user occupies the first of the 64 slots.
+ * Aircraft files are written to tempDir. */
+void runPipelineBenchmarks(BenchmarkRunner& runner, const QString& tempDir);
+
+/* Read keys from generated aircraft files of different sizes and from up to ten .acf files found
+ * recursively in acfDir if not empty. Use the "Aircraft" folder of X-Plane for real files. */
+void runAircraftFileBenchmarks(BenchmarkRunner& runner, const QString& tempDir, const QString& acfDir);
+
+/* Scalar and array accessors of DataRef on TCAS target arrays */
+void runDataRefBenchmarks(BenchmarkRunner& runner);
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_PIPELINEBENCHMARKS_H
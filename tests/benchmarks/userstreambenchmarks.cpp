@@ -0,0 +1,73 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "userstreambenchmarks.h"
+
+#include "benchmarkrunner.h"
+#include "simulator.h"
+
+#include "xpconnect/perfcounters.h"
+#include "xpconnect/userstream.h"
+#include "xpconnect/xpconnect.h"
+
+#include <QDebug>
+
+namespace xpctest {
+
+void runUserStreamBenchmarks(BenchmarkRunner& runner)
+{
+  setupSimulator();
+  setSimulatorTime(100.);
+
+  xpc::PerfCounters counters;
+  xpc::XpConnect xpConnect(false, &counters);
+  xpConnect.initDataRefs();
+
+  // Own key to avoid disturbing a running plugin or client
+  xpc::UserStream userStream(QStringLiteral("LittleXpconnectUserStreamBenchmark"));
+  if(!userStream.open())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open user stream";
+    return;
+  }
+
+  xpc::UserStreamRecord record;
+  if(!xpConnect.fillUserStreamRecord(record, 0))
+  {
+    qWarning() << Q_FUNC_INFO << "No valid user aircraft";
+    return;
+  }
+
+  int frame = 0;
+  runner.run(QStringLiteral("XpConnect::fillUserStreamRecord"), [&xpConnect, &record, &frame]() {
+    xpConnect.fillUserStreamRecord(record, frame++);
+  }, static_cast<qint64>(sizeof(record)));
+
+  runner.run(QStringLiteral("UserStream::write"), [&userStream, &record]() {
+    userStream.write(record);
+  }, static_cast<qint64>(sizeof(record)));
+
+  // Same sequence as in SharedMemoryWriter::streamUserAircraft() for each frame
+  runner.run(QStringLiteral("userStream/frame"), [&xpConnect, &userStream, &record, &frame]() {
+    if(xpConnect.fillUserStreamRecord(record, frame++))
+      userStream.write(record);
+  }, static_cast<qint64>(sizeof(record)), xpc::USER_STREAM_BUDGET_NS);
+
+  userStream.close();
+}
+
+} // namespace xpctest
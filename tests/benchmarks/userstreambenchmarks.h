@@ -0,0 +1,31 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_USERSTREAMBENCHMARKS_H
+#define LITTLEXPC_USERSTREAMBENCHMARKS_H
+
+namespace xpctest {
+
+class BenchmarkRunner;
+
+/* Filling the user aircraft record from datarefs and publishing it into a separate segment. Both are done on
+ * every frame in the flight loop. "userStream/frame" fails if it exceeds xpc::USER_STREAM_BUDGET_NS. */
+void runUserStreamBenchmarks(BenchmarkRunner& runner);
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_USERSTREAMBENCHMARKS_H
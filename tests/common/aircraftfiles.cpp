@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "aircraftfiles.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QPair>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace xpctest {
+
+const QList<AircraftFile>& getAircraftFileTypes()
+{
+  static const QList<AircraftFile> TYPES = {
+    {QStringLiteral("Boeing 737-800"), QStringLiteral("B738"), QStringLiteral("N737LR"), QStringLiteral("JET_HIB"), false},
+    {QStringLiteral("Airbus A330-300"), QStringLiteral("A333"), QStringLiteral("D-AIKA"), QStringLiteral("JET_HIB"), false},
+    {QStringLiteral("Cessna Skyhawk"), QStringLiteral("C172"), QStringLiteral("N172SP"), QStringLiteral("RCP_CRB"), false},
+    {QStringLiteral("Baron 58"), QStringLiteral("BE58"), QStringLiteral("N58LR"), QStringLiteral("RCP_INJ"), false},
+    {QStringLiteral("King Air C90B"), QStringLiteral("BE9L"), QStringLiteral("N90KA"), QStringLiteral("TRB_FRE"), false},
+    {QStringLiteral("Lockheed C-130"), QStringLiteral("C130"), QStringLiteral("65-0962"), QStringLiteral("TRB_FIX"), false},
+    {QStringLiteral("Sikorsky S-76"), QStringLiteral("S76"), QStringLiteral("N76XP"), QStringLiteral("TRB_FRE"), true},
+    {QStringLiteral("Robinson R22"), QStringLiteral("R22"), QStringLiteral("N22RB"), QStringLiteral("RCP_CRB"), true}
+  };
+  return TYPES;
+}
+
+QString writeAircraftFile(const QString& dir, const QString& filename, const AircraftFile& aircraft, int numFillerProperties)
+{
+  QList<QPair<QString, QString> > properties;
+  properties.reserve(numFillerProperties + 8);
+
+  // Fill with parts and engine properties like "P _part/12/_s_dim 0.500000"
+  for(int i = 0; i < numFillerProperties; i++)
+    properties.append({QStringLiteral("_part/%1/_prop_%2").arg(i / 64).arg(i % 64), QString::number(i * 0.25, 'f', 6)});
+
+  properties.append({QStringLiteral("_engn/0/_type"), aircraft.engineType});
+  properties.append({QStringLiteral("_engn/0/_throt_max_FWD"), QStringLiteral("1.000000")});
+  properties.append({QStringLiteral("acf/_ICAO"), aircraft.icao});
+  properties.append({QStringLiteral("acf/_author"), QStringLiteral("Little Xpconnect Tests")});
+  properties.append({QStringLiteral("acf/_descrip"), aircraft.name + QStringLiteral(" generated for tests")});
+  properties.append({QStringLiteral("acf/_is_helicopter"), aircraft.helicopter ? QStringLiteral("1") : QStringLiteral("0")});
+  properties.append({QStringLiteral("acf/_name"), aircraft.name});
+  properties.append({QStringLiteral("acf/_tailnum"), aircraft.tailnum});
+
+  std::sort(properties.begin(), properties.end());
+
+  QString filepath = QDir(dir).filePath(filename);
+  QFile file(filepath);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    stream << "I\n1200 Version\nACF\n\nPROPERTIES_BEGIN\n";
+    for(const QPair<QString, QString>& property : std::as_const(properties))
+      stream << "P " << property.first << ' ' << property.second << '\n';
+    stream << "PROPERTIES_END\n";
+    file.close();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filepath << file.errorString();
+
+  return filepath;
+}
+
+QStringList writeAircraftFiles(const QString& dir, int num, int numFillerProperties)
+{
+  const QList<AircraftFile>& types = getAircraftFileTypes();
+
+  QStringList paths;
+  for(int i = 0; i < num; i++)
+  {
+    AircraftFile aircraft = types.at(i % types.size());
+    aircraft.tailnum += QString::number(i);
+    paths.append(writeAircraftFile(dir, QStringLiteral("%1_%2.acf").arg(aircraft.icao).arg(i), aircraft, numFillerProperties));
+  }
+  return paths;
+}
+
+} // namespace xpctest
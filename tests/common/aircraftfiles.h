@@ -0,0 +1,51 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_AIRCRAFTFILES_H
+#define LITTLEXPC_AIRCRAFTFILES_H
+
+#include <QString>
+#include <QStringList>
+
+namespace xpctest {
+
+/* Values of a generated aircraft file as read by xpc::AircraftFileLoader */
+struct AircraftFile
+{
+  QString name, icao, tailnum;
+
+  /* Engine type like "JET_HIB", "RCP_CRB" or "TRB_FIX" */
+  QString engineType;
+  bool helicopter = false;
+};
+
+/* Types used by writeAircraftFiles() */
+const QList<AircraftFile>& getAircraftFileTypes();
+
+/* Write an .acf file in the text format of X-Plane to the folder and return the full path.
+ * Properties are sorted like in files saved by Plane Maker. numFillerProperties additional properties describing
+ * parts and engines are added which are sorted before the "acf/" keys as in the files of X-Plane.
+ * Real files have between 20000 and 100000 properties. */
+QString writeAircraftFile(const QString& dir, const QString& filename, const AircraftFile& aircraft, int numFillerProperties);
+
+/* Write num files cycling through getAircraftFileTypes() with unique names and tail numbers.
+ * Returns full paths. */
+QStringList writeAircraftFiles(const QString& dir, int num, int numFillerProperties);
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_AIRCRAFTFILES_H
@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "capturereplay.h"
+
+#include "xplmstub.h"
+
+namespace xpctest {
+
+namespace {
+
+/* View on array elements stored in native byte order */
+template<typename TYPE>
+std::span<const TYPE> arrayValues(const QByteArray& value)
+{
+  return std::span<const TYPE>(reinterpret_cast<const TYPE *>(value.constData()),
+                               static_cast<size_t>(value.size()) / sizeof(TYPE));
+}
+
+} // namespace
+
+bool CaptureReplay::open(const QString& filename)
+{
+  close();
+  if(!reader.open(filename))
+    return false;
+
+  for(const DataRefCaptureReader::Ref& ref : reader.getRefs())
+  {
+    // Replace values defined before with recorded type
+    xplmstub::undefine(ref.name.constData());
+    xplmstub::define(ref.name.constData(), ref.type == xplmType_Double ? xplmType_Double | xplmType_Float : ref.type);
+  }
+  return true;
+}
+
+void CaptureReplay::close()
+{
+  reader.close();
+  framePending = false;
+  numValuesApplied = 0L;
+}
+
+bool CaptureReplay::applyUntil(qint64 timeNs)
+{
+  while(true)
+  {
+    if(!framePending)
+    {
+      if(!reader.nextFrame())
+        return false;
+      framePending = true;
+    }
+
+    if(reader.getTimestampNs() > timeNs)
+      return true;
+
+    applyFrame();
+    framePending = false;
+  }
+}
+
+bool CaptureReplay::applyNextFrame()
+{
+  if(!framePending && !reader.nextFrame())
+    return false;
+
+  applyFrame();
+  framePending = false;
+  return true;
+}
+
+void CaptureReplay::applyFrame()
+{
+  const QList<DataRefCaptureReader::Ref>& refs = reader.getRefs();
+  for(int index : reader.getChangedIndexes())
+  {
+    const char *name = refs.at(index).name.constData();
+    const QByteArray& value = reader.getValue(index);
+
+    switch(refs.at(index).type)
+    {
+      case xplmType_Int:
+        xplmstub::setInt(name, reader.valueInt(index));
+        break;
+
+      case xplmType_Float:
+        xplmstub::setFloat(name, reader.valueFloat(index));
+        break;
+
+      case xplmType_Double:
+        xplmstub::setDouble(name, reader.valueDouble(index));
+        break;
+
+      case xplmType_IntArray:
+        xplmstub::setIntArray(name, arrayValues<int>(value));
+        break;
+
+      case xplmType_FloatArray:
+        xplmstub::setFloatArray(name, arrayValues<float>(value));
+        break;
+
+      case xplmType_Data:
+        xplmstub::setBytes(name, value);
+        break;
+
+      default:
+        continue;
+    }
+    numValuesApplied++;
+  }
+}
+
+} // namespace xpctest
@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_CAPTUREREPLAY_H
+#define LITTLEXPC_CAPTUREREPLAY_H
+
+#include "datarefcapturereader.h"
+
+namespace xpctest {
+
+/*
+ * Replays a capture file written by xpc::DataRefRecorder through the XPLM stub.
+ * All recorded datarefs are defined in the stub and their values are set frame by frame. The plugin reads
+ * the recorded values like in the simulator which allows to run XpConnect::fillSimConnectData()
+ * on recorded sessions.
+ *
+ * Datarefs defined before in the stub are kept unless they are also recorded.
+ */
+class CaptureReplay
+{
+public:
+  /* Open capture and define datarefs. Returns false on error. */
+  bool open(const QString& filename);
+  void close();
+
+  /* Apply all frames recorded up to the given time since start of recording.
+   * Returns false if the end of the file was reached. */
+  bool applyUntil(qint64 timeNs);
+
+  /* Apply the next frame. Returns false at the end of the file. */
+  bool applyNextFrame();
+
+  const DataRefCaptureReader& getReader() const
+  {
+    return reader;
+  }
+
+  /* Number of values set in the stub since open() */
+  quint64 getNumValuesApplied() const
+  {
+    return numValuesApplied;
+  }
+
+private:
+  /* Set values of current frame in stub */
+  void applyFrame();
+
+  DataRefCaptureReader reader;
+
+  /* Frame was read by applyUntil() but is not due yet */
+  bool framePending = false;
+  quint64 numValuesApplied = 0L;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_CAPTUREREPLAY_H
@@ -0,0 +1,217 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "datarefcapturereader.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace xpctest {
+
+namespace {
+
+template<typename TYPE>
+TYPE read(const uchar *data)
+{
+  return qFromLittleEndian<TYPE>(data);
+}
+
+} // namespace
+
+DataRefCaptureReader::DataRefCaptureReader()
+{
+}
+
+DataRefCaptureReader::~DataRefCaptureReader()
+{
+  close();
+}
+
+bool DataRefCaptureReader::open(const QString& filename)
+{
+  close();
+
+  file = new QFile(filename);
+  if(!file->open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file->errorString();
+    close();
+    return false;
+  }
+
+  size = file->size();
+  data = file->map(0, size);
+  if(data == nullptr)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file->errorString();
+    close();
+    return false;
+  }
+
+  if(size < xpc::CAPTURE_MAGIC_SIZE + 4 || std::memcmp(data, xpc::CAPTURE_MAGIC, xpc::CAPTURE_MAGIC_SIZE) != 0)
+  {
+    qWarning() << Q_FUNC_INFO << "Not a capture file" << filename;
+    close();
+    return false;
+  }
+
+  offset = xpc::CAPTURE_MAGIC_SIZE;
+  quint32 numRefs = read<quint32>(data + offset);
+  offset += 4;
+
+  for(quint32 i = 0; i < numRefs; i++)
+  {
+    if(offset + 6 > size)
+    {
+      qWarning() << Q_FUNC_INFO << "Truncated header" << filename;
+      close();
+      return false;
+    }
+
+    XPLMDataTypeID type = static_cast<XPLMDataTypeID>(read<quint32>(data + offset));
+    quint16 nameSize = read<quint16>(data + offset + 4);
+    offset += 6;
+
+    if(offset + nameSize > size)
+    {
+      qWarning() << Q_FUNC_INFO << "Truncated header" << filename;
+      close();
+      return false;
+    }
+
+    refs.append({QByteArray(reinterpret_cast<const char *>(data + offset), nameSize), type});
+    offset += nameSize;
+  }
+
+  firstFrameOffset = offset;
+  values.resize(refs.size());
+
+  qInfo() << Q_FUNC_INFO << "Opened" << filename << "with" << refs.size() << "datarefs";
+  return true;
+}
+
+void DataRefCaptureReader::close()
+{
+  values.clear();
+  changedIndexes.clear();
+  refs.clear();
+
+  if(file != nullptr)
+  {
+    if(data != nullptr)
+      file->unmap(const_cast<uchar *>(data));
+    file->close();
+    delete file;
+    file = nullptr;
+  }
+
+  data = nullptr;
+  size = firstFrameOffset = offset = 0L;
+  timestampNs = 0L;
+  frameCount = 0L;
+  keyFrame = false;
+}
+
+void DataRefCaptureReader::rewind()
+{
+  offset = firstFrameOffset;
+  for(QByteArray& value : values)
+    value.clear();
+  changedIndexes.clear();
+  timestampNs = 0L;
+  frameCount = 0L;
+  keyFrame = false;
+}
+
+bool DataRefCaptureReader::nextFrame()
+{
+  if(data == nullptr || offset + xpc::CAPTURE_FRAME_HEADER_SIZE > size)
+    return false;
+
+  const uchar *frame = data + offset;
+  quint32 frameSize = read<quint32>(frame);
+  if(frameSize < xpc::CAPTURE_FRAME_HEADER_SIZE || offset + frameSize > size)
+  {
+    // Incomplete last frame if recording was interrupted
+    qWarning() << Q_FUNC_INFO << "Truncated frame at offset" << offset;
+    return false;
+  }
+
+  timestampNs = static_cast<qint64>(read<quint64>(frame + 4));
+  quint32 numValues = read<quint32>(frame + 4 + 8);
+  keyFrame = frame[4 + 8 + 4] != 0;
+  changedIndexes.clear();
+
+  qsizetype pos = xpc::CAPTURE_FRAME_HEADER_SIZE;
+  for(quint32 i = 0; i < numValues; i++)
+  {
+    if(pos + xpc::CAPTURE_VALUE_HEADER_SIZE > frameSize)
+      return false;
+
+    quint16 index = read<quint16>(frame + pos);
+    quint32 valueSize = read<quint32>(frame + pos + 2);
+    pos += xpc::CAPTURE_VALUE_HEADER_SIZE;
+
+    if(index >= values.size() || pos + valueSize > frameSize)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid value in frame at offset" << offset;
+      return false;
+    }
+
+    // Point into mapped memory without copying
+    values[index] = QByteArray::fromRawData(reinterpret_cast<const char *>(frame + pos), valueSize);
+    changedIndexes.append(index);
+    pos += valueSize;
+  }
+
+  offset += frameSize;
+  frameCount++;
+  return true;
+}
+
+int DataRefCaptureReader::indexOf(const QByteArray& name) const
+{
+  for(int i = 0; i < refs.size(); i++)
+  {
+    if(refs.at(i).name == name)
+      return i;
+  }
+  return -1;
+}
+
+int DataRefCaptureReader::valueInt(int index) const
+{
+  const QByteArray& value = values.at(index);
+  return value.size() >= 4 ? qFromLittleEndian<qint32>(value.constData()) : 0;
+}
+
+float DataRefCaptureReader::valueFloat(int index) const
+{
+  const QByteArray& value = values.at(index);
+  return value.size() >= 4 ? qFromLittleEndian<float>(value.constData()) : 0.f;
+}
+
+double DataRefCaptureReader::valueDouble(int index) const
+{
+  const QByteArray& value = values.at(index);
+  return value.size() >= 8 ? qFromLittleEndian<double>(value.constData()) : 0.;
+}
+
+} // namespace xpctest
@@ -0,0 +1,117 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_DATAREFCAPTUREREADER_H
+#define LITTLEXPC_DATAREFCAPTUREREADER_H
+
+#include "xpconnect/datarefcapture.h"
+
+class QFile;
+
+namespace xpctest {
+
+/*
+ * Reads a capture file written by xpc::DataRefRecorder and iterates over the frames.
+ * The file is memory mapped and values point directly into the mapped memory.
+ *
+ * See CaptureReplay for feeding the values into the XPLM stub.
+ */
+class DataRefCaptureReader
+{
+public:
+  /* Name and type of a recorded dataref */
+  struct Ref
+  {
+    QByteArray name;
+    XPLMDataTypeID type;
+  };
+
+  DataRefCaptureReader();
+  ~DataRefCaptureReader();
+
+  DataRefCaptureReader(const DataRefCaptureReader& other) = delete;
+  DataRefCaptureReader& operator=(const DataRefCaptureReader& other) = delete;
+
+  /* Map file and read header. Returns false on error. */
+  bool open(const QString& filename);
+  void close();
+
+  /* Go back to the first frame. Values are cleared. */
+  void rewind();
+
+  /* Read next frame and apply values. Returns false at end of file or on error. */
+  bool nextFrame();
+
+  const QList<Ref>& getRefs() const
+  {
+    return refs;
+  }
+
+  /* Index of dataref by name or -1 if not recorded */
+  int indexOf(const QByteArray& name) const;
+
+  /* Current raw value of dataref at index. Empty if not set yet. */
+  const QByteArray& getValue(int index) const
+  {
+    return values.at(index);
+  }
+
+  /* Indexes of values contained in the current frame */
+  const QList<int>& getChangedIndexes() const
+  {
+    return changedIndexes;
+  }
+
+  /* Convenience methods for scalar values. Return 0 if not available. */
+  int valueInt(int index) const;
+  float valueFloat(int index) const;
+  double valueDouble(int index) const;
+
+  /* Time of current frame since start of recording */
+  qint64 getTimestampNs() const
+  {
+    return timestampNs;
+  }
+
+  bool isKeyFrame() const
+  {
+    return keyFrame;
+  }
+
+  /* Number of frames read since open() or rewind() */
+  quint64 getFrameCount() const
+  {
+    return frameCount;
+  }
+
+private:
+  QFile *file = nullptr;
+  const uchar *data = nullptr;
+  qint64 size = 0L, firstFrameOffset = 0L, offset = 0L;
+
+  QList<Ref> refs;
+  QList<QByteArray> values;
+  QList<int> changedIndexes;
+
+  qint64 timestampNs = 0L;
+  quint64 frameCount = 0L;
+  bool keyFrame = false;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_DATAREFCAPTUREREADER_H
@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "latencystatistics.h"
+
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+namespace xpctest {
+
+void LatencyStatistics::add(const xpc::LatencyTimestamps& timestamps, qint64 readNs)
+{
+  const qint64 intervals[CLIENT_LATENCY_COUNT] =
+  {
+    timestamps.publishNs - timestamps.captureNs,
+    timestamps.serializedNs - timestamps.publishNs,
+    timestamps.writtenNs - timestamps.serializedNs,
+    readNs - timestamps.writtenNs,
+    readNs - timestamps.captureNs
+  };
+
+  for(int i = 0; i < CLIENT_LATENCY_COUNT; i++)
+    samples[i].append(std::max(intervals[i], 0LL));
+  sorted = false;
+}
+
+qint64 LatencyStatistics::getPercentileNs(ClientLatencyStage stage, double percentile) const
+{
+  if(!sorted)
+  {
+    for(QList<qint64>& values : samples)
+      std::sort(values.begin(), values.end());
+    sorted = true;
+  }
+
+  const QList<qint64>& values = samples.at(stage);
+  if(values.isEmpty())
+    return 0L;
+
+  // Nearest rank
+  qsizetype rank = static_cast<qsizetype>(std::ceil(percentile / 100. * static_cast<double>(values.size())));
+  return values.at(std::clamp(rank - 1, qsizetype(0), values.size() - 1));
+}
+
+void LatencyStatistics::print(QTextStream& out) const
+{
+  for(int i = 0; i < CLIENT_LATENCY_COUNT; i++)
+  {
+    ClientLatencyStage stage = static_cast<ClientLatencyStage>(i);
+    out << "  " << qSetFieldWidth(8) << Qt::left << getStageName(stage) << qSetFieldWidth(0) << Qt::right
+        << " p50 " << static_cast<double>(getPercentileNs(stage, 50.)) / 1000. << " us"
+        << " p90 " << static_cast<double>(getPercentileNs(stage, 90.)) / 1000. << " us"
+        << " p99 " << static_cast<double>(getPercentileNs(stage, 99.)) / 1000. << " us"
+        << " max " << static_cast<double>(getPercentileNs(stage, 100.)) / 1000. << " us" << Qt::endl;
+  }
+}
+
+const char *LatencyStatistics::getStageName(ClientLatencyStage stage)
+{
+  switch(stage)
+  {
+    case CLIENT_LATENCY_FETCH:
+      return "fetch";
+
+    case CLIENT_LATENCY_HANDOFF:
+      return "handoff";
+
+    case CLIENT_LATENCY_WRITE:
+      return "write";
+
+    case CLIENT_LATENCY_READ:
+      return "read";
+
+    case CLIENT_LATENCY_TOTAL:
+      return "total";
+
+    case CLIENT_LATENCY_COUNT:
+      break;
+  }
+  return "unknown";
+}
+
+} // namespace xpctest
@@ -0,0 +1,73 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_LATENCYSTATISTICS_H
+#define LITTLEXPC_LATENCYSTATISTICS_H
+
+#include "xpconnect/perfcounters.h"
+
+#include <QList>
+
+#include <array>
+
+class QTextStream;
+
+namespace xpctest {
+
+/* Intervals between the timestamps of one update as seen by a client */
+enum ClientLatencyStage
+{
+  CLIENT_LATENCY_FETCH, /* Capture to publish - filling data in the flight loop */
+  CLIENT_LATENCY_HANDOFF, /* Publish to serialized - writer thread wake up and serialization */
+  CLIENT_LATENCY_WRITE, /* Serialized to written - shared memory lock and copy */
+  CLIENT_LATENCY_READ, /* Written to read - client polling and lock */
+  CLIENT_LATENCY_TOTAL, /* Capture to read - age of the data when the client gets it */
+  CLIENT_LATENCY_COUNT
+};
+
+/*
+ * Collects all latency samples of the updates read by a client and calculates exact percentiles per stage.
+ * Unlike xpc::PerfCounters in the plugin this includes the time until the client has read the data.
+ */
+class LatencyStatistics
+{
+public:
+  /* Add intervals of one update. readNs is the time the client copied the segment. */
+  void add(const xpc::LatencyTimestamps& timestamps, qint64 readNs);
+
+  /* Percentile from 0 to 100 in nanoseconds. Zero if there are no samples. */
+  qint64 getPercentileNs(ClientLatencyStage stage, double percentile) const;
+
+  qsizetype size() const
+  {
+    return samples.at(0).size();
+  }
+
+  /* Print a line with p50, p90, p99 and maximum for each stage in microseconds */
+  void print(QTextStream& out) const;
+
+  static const char *getStageName(ClientLatencyStage stage);
+
+private:
+  /* Sorted on demand */
+  mutable std::array<QList<qint64>, CLIENT_LATENCY_COUNT> samples;
+  mutable bool sorted = true;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_LATENCYSTATISTICS_H
@@ -0,0 +1,113 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sharedmemoryreader.h"
+
+#include "xpconnect/sharedmemorywriter.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xpctest {
+
+SharedMemoryReader::SharedMemoryReader()
+{
+  sharedMemory.setKey(atools::fs::sc::SHARED_MEMORY_KEY);
+}
+
+SharedMemoryReader::~SharedMemoryReader()
+{
+  detach();
+}
+
+bool SharedMemoryReader::attach()
+{
+  if(sharedMemory.isAttached())
+    return true;
+
+  return sharedMemory.attach(QSharedMemory::ReadOnly);
+}
+
+void SharedMemoryReader::detach()
+{
+  if(sharedMemory.isAttached())
+    sharedMemory.detach();
+}
+
+bool SharedMemoryReader::read()
+{
+  if(!sharedMemory.isAttached())
+    return false;
+
+  QByteArray bytes;
+  qint64 copiedNs = 0L;
+  if(sharedMemory.lock())
+  {
+    const char *mem = static_cast<const char *>(sharedMemory.constData());
+    qsizetype size = qFromBigEndian<quint32>(mem);
+    if(size > static_cast<qsizetype>(sizeof(quint32) * 2) && size <= sharedMemory.size())
+      // Include trailer if it fits - older plugin versions do not write it
+      bytes = QByteArray(mem, std::min(size + SharedMemoryWriter::LATENCY_TRAILER_SIZE, sharedMemory.size()));
+    sharedMemory.unlock();
+    copiedNs = xpc::PerfCounters::monotonicNs();
+  }
+
+  if(bytes.isEmpty() || bytes == segment)
+    return false;
+
+  segment = bytes;
+  dataSize = qFromBigEndian<quint32>(segment.constData());
+  terminated = qFromBigEndian<quint32>(segment.constData() + sizeof(quint32)) > 0;
+
+  timestamps = xpc::LatencyTimestamps();
+  readNs = readTrailer(segment, dataSize, timestamps) ? copiedNs : 0L;
+
+  QByteArray simDataBytes = segment.mid(sizeof(quint32) * 2, dataSize - sizeof(quint32) * 2);
+  QBuffer buffer(&simDataBytes);
+  buffer.open(QIODevice::ReadOnly);
+  if(data.read(&buffer))
+    numUpdates++;
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot read data of size" << dataSize;
+    numErrors++;
+  }
+  return true;
+}
+
+bool SharedMemoryReader::readTrailer(const QByteArray& segment, quint32 dataSize, xpc::LatencyTimestamps& timestamps)
+{
+  if(segment.size() < static_cast<qsizetype>(dataSize) + SharedMemoryWriter::LATENCY_TRAILER_SIZE)
+    return false;
+
+  const char *trailer = segment.constData() + dataSize;
+  if(qFromBigEndian<quint32>(trailer) != SharedMemoryWriter::LATENCY_TRAILER_MAGIC)
+    return false;
+
+  trailer += sizeof(quint32);
+  timestamps.captureNs = qFromBigEndian<qint64>(trailer);
+  timestamps.publishNs = qFromBigEndian<qint64>(trailer + sizeof(qint64));
+  timestamps.serializedNs = qFromBigEndian<qint64>(trailer + sizeof(qint64) * 2);
+  timestamps.writtenNs = qFromBigEndian<qint64>(trailer + sizeof(qint64) * 3);
+  return true;
+}
+
+} // namespace xpctest
@@ -0,0 +1,118 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_SHAREDMEMORYREADER_H
+#define LITTLEXPC_SHAREDMEMORYREADER_H
+
+#include "fs/sc/simconnectdata.h"
+#include "xpconnect/perfcounters.h"
+
+#include <QSharedMemory>
+
+namespace xpctest {
+
+/*
+ * Reference client for the main shared memory segment written by SharedMemoryWriter.
+ * Reads the segment the same way as Little Navmap does: lock, copy size given in header and unlock.
+ * Additionally copies the latency trailer behind the data and takes the read time from the same clock.
+ */
+class SharedMemoryReader
+{
+public:
+  SharedMemoryReader();
+  ~SharedMemoryReader();
+
+  SharedMemoryReader(const SharedMemoryReader& other) = delete;
+  SharedMemoryReader& operator=(const SharedMemoryReader& other) = delete;
+
+  /* Attach to the segment if not already done. Returns false if the segment does not exist yet. */
+  bool attach();
+  void detach();
+
+  bool isAttached() const
+  {
+    return sharedMemory.isAttached();
+  }
+
+  /* Copy the segment and deserialize the data if it has changed since the last call.
+   * Returns true if new data was read. */
+  bool read();
+
+  /* Data of last update */
+  const atools::fs::sc::SimConnectData& getData() const
+  {
+    return data;
+  }
+
+  /* Segment copied in last update including header and everything behind the data */
+  const QByteArray& getSegment() const
+  {
+    return segment;
+  }
+
+  /* Size of header and data as given in the segment header */
+  quint32 getDataSize() const
+  {
+    return dataSize;
+  }
+
+  bool isTerminated() const
+  {
+    return terminated;
+  }
+
+  /* Timestamps from the latency trailer of the last update. All zero if the segment has no trailer. */
+  const xpc::LatencyTimestamps& getTimestamps() const
+  {
+    return timestamps;
+  }
+
+  /* Time of copying the last update as given by xpc::PerfCounters::monotonicNs(). Zero if there is no trailer. */
+  qint64 getReadNs() const
+  {
+    return readNs;
+  }
+
+  /* Parse the latency trailer following the data of dataSize bytes in segment.
+   * Returns false if the segment is too short or the magic number does not match. */
+  static bool readTrailer(const QByteArray& segment, quint32 dataSize, xpc::LatencyTimestamps& timestamps);
+
+  /* Number of changed segments read and number of segments which could not be deserialized */
+  int getNumUpdates() const
+  {
+    return numUpdates;
+  }
+
+  int getNumErrors() const
+  {
+    return numErrors;
+  }
+
+private:
+  QSharedMemory sharedMemory;
+  atools::fs::sc::SimConnectData data;
+  QByteArray segment;
+  xpc::LatencyTimestamps timestamps;
+  qint64 readNs = 0L;
+  quint32 dataSize = 0;
+  bool terminated = false;
+  int numUpdates = 0, numErrors = 0;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_SHAREDMEMORYREADER_H
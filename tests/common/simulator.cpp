@@ -0,0 +1,234 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "simulator.h"
+
+#include "xplmstub.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace xpctest {
+
+namespace {
+
+const double EARTH_RADIUS_METER = 6371000.;
+
+/* X-Plane moves the local origin if the aircraft is farther away */
+const double ORIGIN_SHIFT_METER = 50000.;
+
+double originLat = 0., originLon = 0.;
+
+/* Number of TCAS target slots including the user and length of the string fields */
+constexpr int NUM_TCAS_SLOTS = 64;
+constexpr int TCAS_FIELD_SIZE = 8;
+
+/* Great circle distance on the sphere */
+double distanceMeter(double lat1, double lon1, double lat2, double lon2)
+{
+  double dLat = (lat2 - lat1) * M_PI / 180., dLon = (lon2 - lon1) * M_PI / 180.;
+  double a = std::sin(dLat / 2.) * std::sin(dLat / 2.) +
+             std::cos(lat1 * M_PI / 180.) * std::cos(lat2 * M_PI / 180.) * std::sin(dLon / 2.) * std::sin(dLon / 2.);
+  return 2. * EARTH_RADIUS_METER * std::asin(std::sqrt(a));
+}
+
+void setString(const char *name, const char *value, int size)
+{
+  QByteArray bytes(size, '\0');
+  std::memcpy(bytes.data(), value, std::min(std::strlen(value), static_cast<size_t>(size - 1)));
+  xplmstub::setBytes(name, bytes);
+}
+
+} // namespace
+
+int dataRefArraySize(const char *name, XPLMDataTypeID type)
+{
+  QByteArray ref(name);
+  if(type & xplmType_Data)
+  {
+    // Strings are 8 bytes per target for TCAS and a fixed buffer for the user aircraft
+    if(ref.startsWith("sim/cockpit2/tcas/"))
+      return 64 * 8;
+    else if(ref == "sim/aircraft/view/acf_descrip")
+      return 260;
+    else
+      return 40;
+  }
+  else if(type & (xplmType_IntArray | xplmType_FloatArray))
+  {
+    if(ref.startsWith("sim/cockpit2/tcas/"))
+      return 64;
+    else if(ref.startsWith("sim/world/boat/"))
+      // Carrier and frigate
+      return 2;
+    else
+      // Engines
+      return 8;
+  }
+  return 0;
+}
+
+void setupSimulator(xpc::XpVersion version, const UserAircraft& user)
+{
+  xplmstub::reset();
+
+  xplmstub::setInt("sim/version/xplane_internal_version", version == xpc::XP12 ? 120100 : 114100);
+
+  for(const xpc::DataRefDescriptor& descriptor : xpc::XpDataRefs::getDescriptors())
+  {
+    const char *name = descriptor.nameFor(version);
+    if(name != nullptr)
+    {
+      // X-Plane provides position also as float
+      XPLMDataTypeID types = descriptor.type == xplmType_Double ? xplmType_Double | xplmType_Float : descriptor.type;
+      xplmstub::define(name, types, dataRefArraySize(name, descriptor.type));
+    }
+  }
+
+  // User aircraft ==============================
+  setString("sim/aircraft/view/acf_descrip", "Cessna 172 SP Skyhawk", 260);
+  setString("sim/aircraft/view/acf_ICAO", "C172", 40);
+  setString("sim/aircraft/view/acf_tailnum", "N172SP", 40);
+  xplmstub::setInt("sim/aircraft/engine/acf_num_engines", 1);
+  xplmstub::setIntArray("sim/aircraft/prop/acf_en_type", 0, xpc::RECIP_CARB);
+  xplmstub::setFloat("sim/aircraft/weight/acf_m_max", 1111.f);
+  xplmstub::setFloat("sim/aircraft/weight/acf_m_empty", 767.f);
+  xplmstub::setFloat("sim/flightmodel/weight/m_total", 1000.f);
+  xplmstub::setFloat("sim/flightmodel/weight/m_fixed", 100.f);
+  xplmstub::setFloat("sim/flightmodel/weight/m_fuel_total", 133.f);
+  xplmstub::setFloat("sim/aircraft/view/acf_size_x", 5.5f);
+  xplmstub::setFloat("sim/aircraft/view/acf_size_z", 4.1f);
+  xplmstub::setInt("sim/cockpit/radios/transponder_code", 7000);
+  xplmstub::setFloat("sim/physics/earth_pressure_p", 29.92f);
+
+  // Only user aircraft in TCAS list
+  xplmstub::setInt("sim/cockpit2/tcas/indicators/tcas_num_acf", 1);
+
+  originLat = user.latDeg;
+  originLon = user.lonDeg;
+  xplmstub::setLocalOrigin(originLat, originLon);
+  setUserAircraft(user);
+}
+
+void setUserAircraft(const UserAircraft& user)
+{
+  if(distanceMeter(originLat, originLon, user.latDeg, user.lonDeg) > ORIGIN_SHIFT_METER)
+  {
+    originLat = user.latDeg;
+    originLon = user.lonDeg;
+    xplmstub::setLocalOrigin(originLat, originLon);
+  }
+
+  double heading = user.headingTrueDeg * M_PI / 180.;
+  float verticalSpeedMs = user.verticalSpeedFpm * 0.3048f / 60.f;
+
+  xplmstub::setDouble("sim/flightmodel/position/latitude", user.latDeg);
+  xplmstub::setDouble("sim/flightmodel/position/longitude", user.lonDeg);
+  xplmstub::setDouble("sim/flightmodel/position/elevation", user.altMeter);
+  xplmstub::setFloat("sim/flightmodel/position/y_agl", static_cast<float>(user.altMeter));
+  xplmstub::setFloat("sim/flightmodel/misc/h_ind", static_cast<float>(user.altMeter / 0.3048));
+  xplmstub::setFloat("sim/flightmodel/position/true_psi", user.headingTrueDeg);
+  xplmstub::setFloat("sim/flightmodel/position/mag_psi", user.headingTrueDeg);
+  xplmstub::setFloat("sim/flightmodel/position/hpath", user.headingTrueDeg);
+  xplmstub::setFloat("sim/cockpit2/gauges/indicators/ground_track_mag_pilot", user.headingTrueDeg);
+  xplmstub::setFloat("sim/flightmodel/position/groundspeed", user.groundSpeedMs);
+  xplmstub::setFloat("sim/flightmodel/position/true_airspeed", user.groundSpeedMs);
+  xplmstub::setFloat("sim/flightmodel/position/indicated_airspeed", user.groundSpeedMs / 0.514444f);
+  xplmstub::setFloat("sim/flightmodel/misc/machno", user.groundSpeedMs / 340.3f);
+  xplmstub::setFloat("sim/flightmodel/position/vh_ind_fpm", user.verticalSpeedFpm);
+  xplmstub::setInt("sim/flightmodel/failures/onground_any", user.onGround ? 1 : 0);
+
+  // Local coordinates are x east, y up and z south
+  xplmstub::setFloat("sim/flightmodel/position/local_vx", static_cast<float>(user.groundSpeedMs * std::sin(heading)));
+  xplmstub::setFloat("sim/flightmodel/position/local_vy", verticalSpeedMs);
+  xplmstub::setFloat("sim/flightmodel/position/local_vz", static_cast<float>(-user.groundSpeedMs * std::cos(heading)));
+}
+
+void moveUserAircraft(UserAircraft& user, double seconds)
+{
+  // Destination on great circle from start point, heading and distance
+  double lat = user.latDeg * M_PI / 180., lon = user.lonDeg * M_PI / 180., heading = user.headingTrueDeg * M_PI / 180.;
+  double angle = user.groundSpeedMs * seconds / EARTH_RADIUS_METER;
+
+  double lat2 = std::asin(std::sin(lat) * std::cos(angle) + std::cos(lat) * std::sin(angle) * std::cos(heading));
+  double lon2 = lon + std::atan2(std::sin(heading) * std::sin(angle) * std::cos(lat),
+                                 std::cos(angle) - std::sin(lat) * std::sin(lat2));
+
+  user.latDeg = lat2 * 180. / M_PI;
+  user.lonDeg = std::remainder(lon2 * 180. / M_PI, 360.);
+  user.altMeter = std::max(0., user.altMeter + user.verticalSpeedFpm * 0.3048 / 60. * seconds);
+}
+
+void setTcasTargets(const QList<TcasTarget>& targets)
+{
+  int num = std::min(static_cast<int>(targets.size()), NUM_TCAS_SLOTS - 1);
+
+  // Index 0 is the user aircraft which is not read by the plugin
+  std::array<int, NUM_TCAS_SLOTS> modeSId = {}, modeCCode = {}, onGround = {};
+  std::array<float, NUM_TCAS_SLOTS> lat = {}, lon = {}, ele = {}, psi = {}, speed = {}, verticalSpeed = {};
+  QByteArray icaoType(NUM_TCAS_SLOTS * TCAS_FIELD_SIZE, '\0'), flightId(NUM_TCAS_SLOTS * TCAS_FIELD_SIZE, '\0');
+
+  for(int i = 0; i < num; i++)
+  {
+    const TcasTarget& target = targets.at(i);
+    int slot = i + 1;
+    modeSId[slot] = target.modeSId;
+    modeCCode[slot] = target.modeCCode;
+    onGround[slot] = target.onGround ? 1 : 0;
+    lat[slot] = target.latDeg;
+    lon[slot] = target.lonDeg;
+    ele[slot] = target.altMeter;
+    psi[slot] = target.headingTrueDeg;
+    speed[slot] = target.speedMs;
+    verticalSpeed[slot] = target.verticalSpeedFpm;
+
+    // Fields are zero terminated
+    std::memcpy(icaoType.data() + slot * TCAS_FIELD_SIZE, target.icaoType.constData(),
+                static_cast<size_t>(std::min(static_cast<int>(target.icaoType.size()), TCAS_FIELD_SIZE - 1)));
+    std::memcpy(flightId.data() + slot * TCAS_FIELD_SIZE, target.flightId.constData(),
+                static_cast<size_t>(std::min(static_cast<int>(target.flightId.size()), TCAS_FIELD_SIZE - 1)));
+  }
+
+  xplmstub::setInt("sim/cockpit2/tcas/indicators/tcas_num_acf", num + 1);
+  xplmstub::setIntArray("sim/cockpit2/tcas/targets/modeS_id", modeSId);
+  xplmstub::setIntArray("sim/cockpit2/tcas/targets/modeC_code", modeCCode);
+  xplmstub::setIntArray("sim/cockpit2/tcas/targets/position/weight_on_wheels", onGround);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/lat", lat);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/lon", lon);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/ele", ele);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/psi", psi);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/V_msc", speed);
+  xplmstub::setFloatArray("sim/cockpit2/tcas/targets/position/vertical_speed", verticalSpeed);
+  xplmstub::setBytes("sim/cockpit2/tcas/targets/icao_type", icaoType);
+  xplmstub::setBytes("sim/cockpit2/tcas/targets/flight_id", flightId);
+}
+
+void setSimulatorTime(double simTimeSec)
+{
+  // Start simulation at 12:00 zulu
+  float daySec = static_cast<float>(std::fmod(43200. + simTimeSec, 86400.));
+  xplmstub::setFloat("sim/time/total_running_time_sec", static_cast<float>(simTimeSec));
+  xplmstub::setFloat("sim/time/zulu_time_sec", daySec);
+  xplmstub::setFloat("sim/time/local_time_sec", daySec);
+  xplmstub::setInt("sim/time/local_date_days", 170);
+}
+
+} // namespace xpctest
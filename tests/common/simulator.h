@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_SIMULATOR_H
+#define LITTLEXPC_SIMULATOR_H
+
+#include "xpconnect/xpdatarefs.h"
+
+#include <QByteArray>
+#include <QList>
+
+namespace xpctest {
+
+/* Position and motion of the user aircraft */
+struct UserAircraft
+{
+  double latDeg = 50.0333, lonDeg = 8.5706, altMeter = 1500.;
+  float headingTrueDeg = 70.f, groundSpeedMs = 100.f, verticalSpeedFpm = 0.f;
+  bool onGround = false;
+};
+
+/* AI aircraft in the TCAS target arrays */
+struct TcasTarget
+{
+  int modeSId = 0, modeCCode = 1200;
+  float latDeg = 0.f, lonDeg = 0.f, altMeter = 0.f, headingTrueDeg = 0.f, speedMs = 0.f, verticalSpeedFpm = 0.f;
+  bool onGround = false;
+
+  /* Up to seven characters */
+  QByteArray icaoType, flightId;
+};
+
+/* Reset the XPLM stub and define all datarefs of xpc::XpDataRefs::getDescriptors() with the expected types
+ * and the array sizes used by X-Plane. Values are zero except simulator version, user aircraft strings,
+ * engines and the user position from setUserAircraft(). */
+void setupSimulator(xpc::XpVersion version = xpc::XP12, const UserAircraft& user = UserAircraft());
+
+/* Size of a dataref array as used by X-Plane. Zero for scalar values. */
+int dataRefArraySize(const char *name, XPLMDataTypeID type);
+
+/* Update position, attitude and velocity datarefs of the user aircraft.
+ * Moves the local coordinate origin like X-Plane if the aircraft is too far away. */
+void setUserAircraft(const UserAircraft& user);
+
+/* Move the user aircraft along its heading with ground and vertical speed for the given time */
+void moveUserAircraft(UserAircraft& user, double seconds);
+
+/* Fill the TCAS target arrays from index 1 on and set the number of aircraft including the user at index 0.
+ * Remaining slots are cleared. Targets exceeding the array size are ignored. */
+void setTcasTargets(const QList<TcasTarget>& targets);
+
+/* Update simulator time datarefs */
+void setSimulatorTime(double simTimeSec);
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_SIMULATOR_H
@@ -0,0 +1,168 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "trafficscenario.h"
+
+#include "aircraftfiles.h"
+#include "xplmstub.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace xpctest {
+
+namespace {
+
+const double EARTH_RADIUS_METER = 6371000.;
+
+/* Seed for the random generator */
+const quint32 SEED = 4711;
+
+/* Mode S ids of generated aircraft start here */
+const int MODE_S_ID_BASE = 0x400000;
+
+/* Aircraft stay between these altitudes */
+const float MIN_ALT_METER = 150.f, MAX_ALT_METER = 12000.f;
+
+/* Distance of carrier and frigate from the local origin and their speed */
+const std::array<float, 2> BOAT_RADIUS_METER = {6000.f, 9000.f}, BOAT_SPEED_MS = {15.f, 10.f};
+
+} // namespace
+
+TrafficScenario::TrafficScenario(int numAircraft, double churnPerSecondParam, bool boatsParam)
+  : random(SEED), churnPerSecond(churnPerSecondParam), boats(boatsParam)
+{
+  aircraft.resize(std::clamp(numAircraft, 0, 63));
+  for(int i = 0; i < aircraft.size(); i++)
+    spawn(i);
+}
+
+void TrafficScenario::writeModels(const QString& dir, int numModels, int numFillerProperties)
+{
+  modelPaths = writeAircraftFiles(dir, std::max(numModels, 1), numFillerProperties);
+
+  // User aircraft at index zero
+  xplmstub::setAircraftModel(0, modelPaths.constFirst());
+  for(int i = 0; i < aircraft.size(); i++)
+    assignModel(i);
+}
+
+void TrafficScenario::spawn(int index)
+{
+  int serial = nextSerial++;
+  const AircraftFile& type = getAircraftFileTypes().at(serial % getAircraftFileTypes().size());
+
+  Aircraft& ac = aircraft[index];
+  ac.serial = serial;
+  ac.radiusMeter = static_cast<float>(uniform(2000., 150000.));
+  ac.bearingDeg = static_cast<float>(uniform(0., 360.));
+  ac.speedMs = static_cast<float>(type.helicopter ? uniform(20., 70.) : uniform(40., 250.));
+  ac.altMeter = static_cast<float>(uniform(MIN_ALT_METER, MAX_ALT_METER));
+  ac.climbFpm = static_cast<float>(uniform(-2000., 2000.));
+
+  ac.target.modeSId = MODE_S_ID_BASE + serial;
+  ac.target.modeCCode = 1000 + serial % 7000;
+  ac.target.icaoType = type.icao.toLatin1();
+  ac.target.flightId = QStringLiteral("LX%1").arg(serial % 100000, 5, 10, QChar('0')).toLatin1();
+
+  assignModel(index);
+}
+
+void TrafficScenario::assignModel(int index)
+{
+  if(!modelPaths.isEmpty())
+    xplmstub::setAircraftModel(index + 1, modelPaths.at(aircraft.at(index).serial % modelPaths.size()));
+}
+
+void TrafficScenario::update(double simTimeSec, const UserAircraft& user)
+{
+  double seconds = lastSimTimeSec < 0. ? 0. : std::max(simTimeSec - lastSimTimeSec, 0.);
+  lastSimTimeSec = simTimeSec;
+
+  // Replace aircraft round robin according to churn rate
+  if(churnPerSecond > 0. && !aircraft.isEmpty())
+  {
+    churnAccumulator += churnPerSecond * seconds;
+    while(churnAccumulator >= 1.)
+    {
+      spawn(nextChurnIndex);
+      nextChurnIndex = (nextChurnIndex + 1) % static_cast<int>(aircraft.size());
+      churnAccumulator -= 1.;
+      numReplaced++;
+    }
+  }
+
+  targets.clear();
+  double cosLat = std::max(std::cos(user.latDeg * M_PI / 180.), 0.01);
+  for(Aircraft& ac : aircraft)
+  {
+    // Circle clockwise around the user aircraft
+    ac.bearingDeg = static_cast<float>(std::fmod(ac.bearingDeg + ac.speedMs * seconds / (2. * M_PI * ac.radiusMeter) * 360., 360.));
+
+    ac.altMeter += static_cast<float>(ac.climbFpm * 0.3048 / 60. * seconds);
+    if(ac.altMeter < MIN_ALT_METER || ac.altMeter > MAX_ALT_METER)
+    {
+      // Turn around vertically
+      ac.climbFpm = -ac.climbFpm;
+      ac.altMeter = std::clamp(ac.altMeter, MIN_ALT_METER, MAX_ALT_METER);
+    }
+
+    // Plane approximation is sufficient for the distances used here
+    double bearing = ac.bearingDeg * M_PI / 180.;
+    ac.target.latDeg = static_cast<float>(user.latDeg + ac.radiusMeter * std::cos(bearing) / EARTH_RADIUS_METER * 180. / M_PI);
+    ac.target.lonDeg = static_cast<float>(user.lonDeg + ac.radiusMeter * std::sin(bearing) / (EARTH_RADIUS_METER * cosLat) * 180. / M_PI);
+    ac.target.altMeter = ac.altMeter;
+    ac.target.headingTrueDeg = std::fmod(ac.bearingDeg + 90.f, 360.f);
+    ac.target.speedMs = ac.speedMs;
+    ac.target.verticalSpeedFpm = ac.climbFpm;
+    targets.append(ac.target);
+  }
+  setTcasTargets(targets);
+
+  if(boats)
+    updateBoats(simTimeSec);
+}
+
+void TrafficScenario::updateBoats(double simTimeSec)
+{
+  // Local coordinates are x east, y up and z south
+  std::array<float, 2> heading, velocity, x, y = {0.f, 0.f}, z;
+  for(size_t i = 0; i < 2; i++)
+  {
+    double bearing = std::fmod(BOAT_SPEED_MS[i] * simTimeSec / BOAT_RADIUS_METER[i] + static_cast<double>(i) * M_PI, 2. * M_PI);
+    x[i] = static_cast<float>(BOAT_RADIUS_METER[i] * std::sin(bearing));
+    z[i] = static_cast<float>(-BOAT_RADIUS_METER[i] * std::cos(bearing));
+    heading[i] = static_cast<float>(std::fmod(bearing * 180. / M_PI + 90., 360.));
+    velocity[i] = BOAT_SPEED_MS[i];
+  }
+
+  xplmstub::setFloatArray("sim/world/boat/heading_deg", heading);
+  xplmstub::setFloatArray("sim/world/boat/velocity_msc", velocity);
+  xplmstub::setFloatArray("sim/world/boat/x_mtr", x);
+  xplmstub::setFloatArray("sim/world/boat/y_mtr", y);
+  xplmstub::setFloatArray("sim/world/boat/z_mtr", z);
+  xplmstub::setFloat("sim/world/boat/carrier_deck_height_mtr", 19.f);
+  xplmstub::setFloat("sim/world/boat/frigate_deck_height_mtr", 8.f);
+}
+
+double TrafficScenario::uniform(double min, double max)
+{
+  return min + random.bounded(max - min);
+}
+
+} // namespace xpctest
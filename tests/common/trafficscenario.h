@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TRAFFICSCENARIO_H
+#define LITTLEXPC_TRAFFICSCENARIO_H
+
+#include "simulator.h"
+
+#include <QRandomGenerator>
+#include <QStringList>
+
+namespace xpctest {
+
+/*
+ * Load scenario for the plugin at the limits of X-Plane. Drives the datarefs of the XPLM stub like X-Plane would
+ * so the plugin runs its normal fetch path including TCAS bulk fetch, traffic filter, AI table and the
+ * aircraft file loader.
+ *
+ * TCAS targets circle around the user aircraft at different distances, altitudes and speeds. Churn replaces
+ * aircraft with new ones having a new mode S id, flight id and aircraft model to exercise slot reuse and the
+ * loader queue. Carrier and frigate circle around the origin of the local coordinates if boats are enabled.
+ *
+ * Same sequence of aircraft for each run.
+ */
+class TrafficScenario
+{
+public:
+  /* numAircraft is limited to 63 since the user occupies the first TCAS slot. churnPerSecond is the number
+   * of aircraft replaced per second of simulator time. */
+  TrafficScenario(int numAircraft, double churnPerSecond, bool boats);
+
+  TrafficScenario(const TrafficScenario& other) = delete;
+  TrafficScenario& operator=(const TrafficScenario& other) = delete;
+
+  /* Write numModels aircraft files with numFillerProperties each into dir. Aircraft are assigned to the models
+   * round robin. Without models the plugin finds no aircraft files. Call after setupSimulator(). */
+  void writeModels(const QString& dir, int numModels, int numFillerProperties);
+
+  /* Move all aircraft and boats to the given simulator time and replace aircraft according to churn.
+   * Sets TCAS, boat and aircraft model datarefs. Call from the frame hook after setUserAircraft(). */
+  void update(double simTimeSec, const UserAircraft& user);
+
+  int getNumAircraft() const
+  {
+    return static_cast<int>(aircraft.size());
+  }
+
+  /* Number of aircraft replaced by churn so far */
+  int getNumReplaced() const
+  {
+    return numReplaced;
+  }
+
+private:
+  /* Motion of one aircraft relative to the user */
+  struct Aircraft
+  {
+    float radiusMeter, bearingDeg, speedMs, altMeter, climbFpm;
+
+    /* Unique number of the aircraft which also selects type and model */
+    int serial;
+    TcasTarget target;
+  };
+
+  /* Create a new aircraft at the index */
+  void spawn(int index);
+
+  /* Set model path for TCAS slot of aircraft at the index */
+  void assignModel(int index);
+
+  /* Carrier and frigate circling around the local origin */
+  void updateBoats(double simTimeSec);
+
+  /* Random value in range min to max */
+  double uniform(double min, double max);
+
+  QList<Aircraft> aircraft;
+
+  /* Buffer for setTcasTargets() - reused */
+  QList<TcasTarget> targets;
+  QStringList modelPaths;
+  QRandomGenerator random;
+
+  double churnPerSecond, churnAccumulator = 0., lastSimTimeSec = -1.;
+  int nextSerial = 0, nextChurnIndex = 0, numReplaced = 0;
+  bool boats;
+};
+
+} // namespace xpctest
+
+#endif // LITTLEXPC_TRAFFICSCENARIO_H
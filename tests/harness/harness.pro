@@ -0,0 +1,29 @@
+#*****************************************************************************
+# Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#****************************************************************************
+
+# Runs the plugin with a simulated user aircraft and reads the shared memory. Run by "make check".
+
+include(../tests.pri)
+
+TEMPLATE = app
+CONFIG += testcase
+TARGET = harness
+
+linkTestLibs(common plugin xplmstub)
+
+SOURCES += \
+  main.cpp
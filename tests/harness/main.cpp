@@ -0,0 +1,236 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "latencystatistics.h"
+#include "sharedmemoryreader.h"
+#include "simulator.h"
+#include "trafficscenario.h"
+#include "xplmstub.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+
+extern "C" {
+#include "XPLMDataAccess.h"
+#include "XPLMPlugin.h"
+}
+
+/*
+ * Loads the plugin through its XPLM entry points, drives the flight loops with a simulated user aircraft and
+ * reads the shared memory like a client. Prints a report and returns an error if no data was received.
+ *
+ * AI aircraft, churn and boats are injected through the datarefs of the stub to measure flight loop cost,
+ * segment size and aircraft file loader queue under load.
+ *
+ * Settings are written to a temporary folder to keep the configuration of a local installation untouched.
+ */
+
+// Entry points in main.cpp
+PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc);
+PLUGIN_API void XPluginStop(void);
+PLUGIN_API int XPluginEnable(void);
+PLUGIN_API void XPluginDisable(void);
+PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, long inMessage, void *inParam);
+
+// Flight loop callbacks in main.cpp
+float flightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
+                         void *inRefcon);
+float rediscoverCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
+                         void *inRefcon);
+float userStreamCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter,
+                         void *inRefcon);
+
+namespace {
+
+QString callbackName(XPLMFlightLoop_f callback)
+{
+  if(callback == flightLoopCallback)
+    return QStringLiteral("fetch");
+  else if(callback == rediscoverCallback)
+    return QStringLiteral("rediscover");
+  else if(callback == userStreamCallback)
+    return QStringLiteral("user stream");
+  else
+    return QStringLiteral("unknown");
+}
+
+/* Print values of all performance datarefs published by the plugin */
+void printPerfDataRefs(QTextStream& out)
+{
+  for(const QByteArray& name : xplmstub::getNames())
+  {
+    if(!name.startsWith("littlexpconnect/perf/"))
+      continue;
+
+    XPLMDataRef ref = XPLMFindDataRef(name.constData());
+    XPLMDataTypeID type = XPLMGetDataRefTypes(ref);
+    out << "  " << name << " = ";
+    if(type & xplmType_Int)
+      out << XPLMGetDatai(ref);
+    else if(type & xplmType_Float)
+      out << XPLMGetDataf(ref);
+    else
+      out << XPLMGetDatad(ref);
+    out << Qt::endl;
+  }
+}
+
+/* Wall time percentile of callback durations in microseconds */
+double percentileUs(QList<qint64> durations, double percentile)
+{
+  if(durations.isEmpty())
+    return 0.;
+
+  std::sort(durations.begin(), durations.end());
+  qsizetype index = std::min(durations.size() - 1, static_cast<qsizetype>(percentile / 100. * static_cast<double>(durations.size())));
+  return static_cast<double>(durations.at(index)) / 1000.;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  Q_INIT_RESOURCE(littlexpconnect);
+
+  QStringList arguments;
+  for(int i = 0; i < argc; i++)
+    arguments.append(QString::fromLocal8Bit(argv[i]));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("Runs Little Xpconnect against a stub of the X-Plane plugin API."));
+  parser.addHelpOption();
+  QCommandLineOption fpsOpt(QStringLiteral("fps"), QStringLiteral("Simulator frame rate. Default is 60."),
+                            QStringLiteral("rate"), QStringLiteral("60"));
+  QCommandLineOption secondsOpt(QStringLiteral("seconds"), QStringLiteral("Simulator time to run. Default is 30."),
+                                QStringLiteral("seconds"), QStringLiteral("30"));
+  QCommandLineOption realtimeOpt(QStringLiteral("realtime"), QStringLiteral("Keep frame rate in real time instead of running "
+                                                                            "frames as fast as possible."));
+  QCommandLineOption xp11Opt(QStringLiteral("xp11"), QStringLiteral("Simulate X-Plane 11 instead of 12."));
+  QCommandLineOption logOpt(QStringLiteral("log"), QStringLiteral("Print messages of the plugin to Log.txt to stderr."));
+  QCommandLineOption aircraftOpt(QStringLiteral("aircraft"), QStringLiteral("Number of TCAS targets up to 63. Default is 0."),
+                                 QStringLiteral("number"), QStringLiteral("0"));
+  QCommandLineOption churnOpt(QStringLiteral("churn"), QStringLiteral("Aircraft replaced by new ones per second. Default is 0."),
+                              QStringLiteral("number"), QStringLiteral("0"));
+  QCommandLineOption modelsOpt(QStringLiteral("models"), QStringLiteral("Number of different aircraft files. Default is 16."),
+                               QStringLiteral("number"), QStringLiteral("16"));
+  QCommandLineOption propertiesOpt(QStringLiteral("acf-properties"), QStringLiteral("Properties in each aircraft file. "
+                                                                                    "Default is 20000."),
+                                   QStringLiteral("number"), QStringLiteral("20000"));
+  QCommandLineOption boatsOpt(QStringLiteral("boats"), QStringLiteral("Add carrier and frigate."));
+  parser.addOptions({fpsOpt, secondsOpt, realtimeOpt, xp11Opt, logOpt, aircraftOpt, churnOpt, modelsOpt, propertiesOpt, boatsOpt});
+  parser.process(arguments);
+
+  double fps = std::max(1., parser.value(fpsOpt).toDouble());
+  double seconds = std::max(0., parser.value(secondsOpt).toDouble());
+  double frameSeconds = 1. / fps;
+  int numFrames = static_cast<int>(seconds * fps);
+
+  // Keep settings, logs and aircraft files away from a real installation
+  QTemporaryDir configDir, modelDir;
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(configDir.path()));
+
+  // Set up simulator and let user aircraft fly straight ahead
+  xpctest::UserAircraft user;
+  xpctest::setupSimulator(parser.isSet(xp11Opt) ? xpc::XP11 : xpc::XP12, user);
+  xplmstub::setEchoDebugStrings(parser.isSet(logOpt));
+
+  // Traffic around the user aircraft
+  xpctest::TrafficScenario traffic(parser.value(aircraftOpt).toInt(), parser.value(churnOpt).toDouble(), parser.isSet(boatsOpt));
+  if(traffic.getNumAircraft() > 0)
+    traffic.writeModels(modelDir.path(), parser.value(modelsOpt).toInt(), std::max(0, parser.value(propertiesOpt).toInt()));
+
+  xplmstub::setFrameHook([&user, &traffic, frameSeconds](double simTimeSec, int) {
+    xpctest::moveUserAircraft(user, frameSeconds);
+    xpctest::setUserAircraft(user);
+    xpctest::setSimulatorTime(simTimeSec);
+    traffic.update(simTimeSec, user);
+  });
+
+  // Load plugin ==================================================
+  char name[256], signature[256], description[256];
+  if(XPluginStart(name, signature, description) != 1 || XPluginEnable() != 1)
+  {
+    QTextStream(stderr) << "Plugin failed to start" << Qt::endl;
+    return 1;
+  }
+  XPluginReceiveMessage(XPLM_NO_PLUGIN_ID, XPLM_MSG_PLANE_LOADED, nullptr);
+
+  // Run frames and read shared memory after each frame ===========
+  xpctest::SharedMemoryReader reader;
+  xpctest::LatencyStatistics latency;
+  qsizetype maxSegmentBytes = 0, maxAi = 0;
+  for(int i = 0; i < numFrames; i++)
+  {
+    xplmstub::runFrames(1, frameSeconds, parser.isSet(realtimeOpt));
+    if(reader.attach() && reader.read() && reader.getReadNs() > 0L)
+    {
+      latency.add(reader.getTimestamps(), reader.getReadNs());
+      maxSegmentBytes = std::max(maxSegmentBytes, reader.getSegment().size());
+      maxAi = std::max(maxAi, reader.getData().getAiAircraftConst().size());
+    }
+  }
+
+  QTextStream out(stdout);
+  out << "Plugin " << name << " (" << signature << ")" << Qt::endl;
+  out << "Frames " << xplmstub::getFrameCount() << " simulator time " << xplmstub::getElapsedTime() << " s at "
+      << fps << " fps" << Qt::endl;
+  out << "Traffic aircraft " << traffic.getNumAircraft() << " replaced " << traffic.getNumReplaced()
+      << " boats " << (parser.isSet(boatsOpt) ? 2 : 0) << Qt::endl;
+
+  out << "Flight loops:" << Qt::endl;
+  for(const xplmstub::FlightLoopStats& stats : xplmstub::getFlightLoopStats())
+  {
+    double calls = static_cast<double>(std::max(stats.calls, quint64(1)));
+    out << "  " << callbackName(stats.callback) << " calls " << stats.calls
+        << " avg " << static_cast<double>(stats.totalNs) / calls / 1000. << " us"
+        << " p99 " << percentileUs(stats.durationsNs, 99.) << " us"
+        << " max " << static_cast<double>(stats.maxNs) / 1000. << " us"
+        << " cpu avg " << static_cast<double>(stats.totalCpuNs) / calls / 1000. << " us" << Qt::endl;
+  }
+
+  const QList<qint64>& frameCpuNs = xplmstub::getFrameCpuNs();
+  out << "CPU time of all flight loops per frame:"
+      << " p50 " << percentileUs(frameCpuNs, 50.) << " us"
+      << " p99 " << percentileUs(frameCpuNs, 99.) << " us"
+      << " max " << percentileUs(frameCpuNs, 100.) << " us" << Qt::endl;
+
+  out << "Latency from capture to read:" << Qt::endl;
+  latency.print(out);
+
+  out << "Performance datarefs:" << Qt::endl;
+  printPerfDataRefs(out);
+
+  out << "Reader updates " << reader.getNumUpdates() << " errors " << reader.getNumErrors()
+      << " segment bytes " << reader.getSegment().size()
+      << " AI " << reader.getData().getAiAircraftConst().size() << Qt::endl;
+  out << "Reader peak segment bytes " << maxSegmentBytes << " peak AI " << maxAi << Qt::endl;
+
+  // Unload plugin ==================================================
+  XPluginDisable();
+  XPluginStop();
+  reader.detach();
+
+  bool ok = reader.getNumUpdates() > 0 && reader.getNumErrors() == 0 &&
+            reader.getData().getUserAircraftConst().isValid() && latency.size() > 0 &&
+            (traffic.getNumAircraft() == 0 || maxAi > 0);
+  out << (ok ? "Passed" : "Failed") << Qt::endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "latencystatistics.h"
+#include "sharedmemoryreader.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+
+/*
+ * Reference client reading the shared memory of a plugin running in X-Plane. Polls the segment like
+ * Little Navmap, parses the latency trailer and prints percentiles for each stage from capture in the flight loop
+ * until the data was read by this client.
+ *
+ * Runs until the given time has passed or the plugin terminates.
+ */
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("Little Xpconnect Latency Reader"));
+  QCoreApplication::setOrganizationName(QStringLiteral("ABarthel"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("Reads the shared memory of Little Xpconnect and prints latency percentiles "
+                                                  "for capture, handoff, write and read."));
+  parser.addHelpOption();
+  QCommandLineOption intervalOpt(QStringLiteral("interval"), QStringLiteral("Polling interval. Default is 10."),
+                                 QStringLiteral("milliseconds"), QStringLiteral("10"));
+  QCommandLineOption secondsOpt(QStringLiteral("seconds"), QStringLiteral("Time to run. Default is 60."),
+                                QStringLiteral("seconds"), QStringLiteral("60"));
+  parser.addOptions({intervalOpt, secondsOpt});
+  parser.process(app);
+
+  int intervalMs = std::max(1, parser.value(intervalOpt).toInt());
+  qint64 runMs = std::max(1LL, parser.value(secondsOpt).toLongLong()) * 1000L;
+
+  QTextStream out(stdout);
+  xpctest::SharedMemoryReader reader;
+  xpctest::LatencyStatistics statistics;
+  int numWithoutTrailer = 0;
+
+  QElapsedTimer timer, reportTimer;
+  timer.start();
+  reportTimer.start();
+  while(timer.elapsed() < runMs)
+  {
+    if(reader.attach() && reader.read())
+    {
+      if(reader.isTerminated())
+        break;
+
+      if(reader.getReadNs() > 0L)
+        statistics.add(reader.getTimestamps(), reader.getReadNs());
+      else
+        numWithoutTrailer++;
+    }
+
+    if(reportTimer.elapsed() > 10000L && statistics.size() > 0)
+    {
+      out << "Updates " << statistics.size() << Qt::endl;
+      statistics.print(out);
+      reportTimer.restart();
+    }
+    QThread::msleep(static_cast<unsigned long>(intervalMs));
+  }
+
+  out << "Updates " << reader.getNumUpdates() << " errors " << reader.getNumErrors()
+      << " without latency trailer " << numWithoutTrailer << Qt::endl;
+  statistics.print(out);
+  return reader.getNumUpdates() > 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#*****************************************************************************
+# Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#****************************************************************************
+
+# Plugin sources as a static library to be linked against the XPLM stub
+
+include(../tests.pri)
+
+TEMPLATE = lib
+CONFIG += staticlib
+TARGET = plugin
+
+HEADERS += \
+  $$files(../../src/*.h) \
+  $$files(../../src/xpconnect/*.h)
+
+SOURCES += \
+  ../../src/main.cpp \
+  $$files(../../src/xpconnect/*.cpp)
+
+RESOURCES += ../../littlexpconnect.qrc
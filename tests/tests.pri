@@ -0,0 +1,71 @@
+#*****************************************************************************
+# Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#****************************************************************************
+
+# =============================================================================
+# Common settings for all test projects. Uses the same environment variables as littlexpconnect.pro.
+# Only the headers of the X-Plane SDK are needed. The XPLM library is replaced by the stub in xplmstub.
+# =============================================================================
+
+QT += core
+QT -= gui
+
+CONFIG += build_all c++20 console
+CONFIG -= gui debug_and_release debug_and_release_target app_bundle
+
+ATOOLS_INC_PATH=$$(ATOOLS_INC_PATH)
+ATOOLS_LIB_PATH=$$(ATOOLS_LIB_PATH)
+ATOOLS_NO_QT5COMPAT=$$(ATOOLS_NO_QT5COMPAT)
+XPSDK_BASE=$$(XPSDK_BASE)
+TRACE=$$(LITTLEXPC_TRACE)
+
+QMAKE_CXXFLAGS += -Wall -Wextra -Wpedantic -Wno-pragmas -Wno-unknown-warning -Wno-unknown-warning-option
+
+CONFIG(debug, debug|release) : CONF_TYPE=debug
+CONFIG(release, debug|release) : CONF_TYPE=release
+
+isEmpty(XPSDK_BASE) : XPSDK_BASE="$$PWD/../../X-Plane SDK"
+isEmpty(ATOOLS_INC_PATH) : ATOOLS_INC_PATH=$$PWD/../../atools/src
+isEmpty(ATOOLS_LIB_PATH) : ATOOLS_LIB_PATH=$$PWD/../../build-atools-$$CONF_TYPE
+
+!isEqual(ATOOLS_NO_QT5COMPAT, "true"): QT += core5compat
+
+DEFINES += QT_DISABLE_DEPRECATED_UP_TO=0x061000
+DEFINES += VERSION_NUMBER_LITTLEXPCONNECT='\\"test\\"'
+DEFINES += GIT_REVISION_LITTLEXPCONNECT='\\"test\\"'
+DEFINES += QT_NO_CAST_FROM_BYTEARRAY
+DEFINES += QT_NO_CAST_TO_ASCII
+DEFINES += XPLM302=1 XPLM301=1 XPLM300=1 XPLM210=1 XPLM200=1 APL=0 IBM=0 LIN=1
+DEFINES += LITTLEXPCONNECT_LIBRARY
+
+isEqual(TRACE, "true") : DEFINES += LITTLEXPC_TRACE
+
+win32 : DEFINES += _USE_MATH_DEFINES
+
+DEPENDPATH += $$ATOOLS_INC_PATH
+INCLUDEPATH += $$PWD/../src $$PWD/xplmstub $$PWD/common $$ATOOLS_INC_PATH $${XPSDK_BASE}/CHeaders/XPLM $${XPSDK_BASE}/CHeaders/Widgets
+
+# Static test libraries in link order. Libraries are expected in the shadow build tree of tests.pro.
+defineTest(linkTestLibs) {
+  for(lib, 1) {
+    LIBS += -L$$OUT_PWD/../$$lib -l$$lib
+    PRE_TARGETDEPS += $$OUT_PWD/../$$lib/lib$${lib}.a
+  }
+  LIBS += -L$$ATOOLS_LIB_PATH -latools -lz
+  PRE_TARGETDEPS += $$ATOOLS_LIB_PATH/libatools.a
+  export(LIBS)
+  export(PRE_TARGETDEPS)
+}
@@ -0,0 +1,34 @@
+#*****************************************************************************
+# Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#****************************************************************************
+
+# =============================================================================
+# Tests, benchmarks and plugin harness running the plugin against a stub of the XPLM library.
+# Uses the same environment variables as littlexpconnect.pro. See BUILD.txt.
+#
+# Run all tests with "make check" in the build folder.
+# =============================================================================
+
+TEMPLATE = subdirs
+
+SUBDIRS = xplmstub plugin common unittests benchmarks harness latencyreader
+
+plugin.depends = xplmstub
+common.depends = plugin
+unittests.depends = common
+benchmarks.depends = common
+harness.depends = common
+latencyreader.depends = common
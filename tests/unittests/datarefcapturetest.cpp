@@ -0,0 +1,249 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "datarefcapturetest.h"
+
+#include "capturereplay.h"
+#include "xplmstub.h"
+#include "xpconnect/datarefcapture.h"
+
+#include <QFile>
+#include <QTest>
+
+#include <limits>
+#include <utility>
+
+namespace {
+
+const int NUM_FRAMES = 250;
+
+/* Frames after which a key frame is written by the recorder */
+const int KEY_FRAME_INTERVAL = 100;
+
+/* Datarefs of all types used for recording */
+struct TestDataRefs
+{
+  DataRef intRef, floatRef, doubleRef, intArrRef, floatArrRef, dataRef;
+
+  TestDataRefs()
+  {
+    xplmstub::define("test/int", xplmType_Int);
+    xplmstub::define("test/float", xplmType_Float);
+    xplmstub::define("test/double", xplmType_Double | xplmType_Float);
+    xplmstub::define("test/int_arr", xplmType_IntArray, 4);
+    xplmstub::define("test/float_arr", xplmType_FloatArray, 4);
+    xplmstub::setBytes("test/data", QByteArrayView("N172SP\0\0", 8));
+
+    intRef.init("test/int");
+    floatRef.init("test/float");
+    doubleRef.init("test/double");
+    intArrRef.init("test/int_arr");
+    floatArrRef.init("test/float_arr");
+    dataRef.init("test/data");
+
+    for(DataRef *ref : {&intRef, &floatRef, &doubleRef, &intArrRef, &floatArrRef, &dataRef})
+      ref->find();
+  }
+
+  QList<xpc::DataRefEntry> entries() const
+  {
+    return {{&intRef, xplmType_Int}, {&floatRef, xplmType_Float}, {&doubleRef, xplmType_Double},
+            {&intArrRef, xplmType_IntArray}, {&floatArrRef, xplmType_FloatArray}, {&dataRef, xplmType_Data}};
+  }
+
+};
+
+/* Values of a frame. Int changes each frame and float array every ten frames. */
+void setFrameValues(int frame)
+{
+  xplmstub::setInt("test/int", frame);
+  xplmstub::setFloat("test/float", 1.5f);
+  xplmstub::setDouble("test/double", 50.0333333333);
+  xplmstub::setIntArray("test/int_arr", 2, 7);
+  xplmstub::setFloatArray("test/float_arr", 1, static_cast<float>(frame / 10));
+}
+
+/* Record frames into file and flush every 50 frames */
+void recordFile(xpc::DataRefRecorder& recorder, const TestDataRefs& refs, const QString& filename, int numFrames)
+{
+  recorder.start(filename, refs.entries());
+  for(int frame = 0; frame < numFrames; frame++)
+  {
+    setFrameValues(frame);
+    recorder.recordFrame();
+
+    if(frame % 50 == 0)
+      recorder.flush();
+  }
+}
+
+} // namespace
+
+void DataRefCaptureTest::init()
+{
+  xplmstub::reset();
+}
+
+void DataRefCaptureTest::recordAndRead()
+{
+  QString filename = tempDir.filePath(QStringLiteral("recordandread.lxcrec"));
+  {
+    TestDataRefs refs;
+    xpc::DataRefRecorder recorder;
+    recordFile(recorder, refs, filename, NUM_FRAMES);
+    recorder.stop();
+    recorder.flush();
+  }
+
+  xpctest::DataRefCaptureReader reader;
+  QVERIFY(reader.open(filename));
+  QCOMPARE(reader.getRefs().size(), 6);
+  QCOMPARE(reader.getRefs().at(0).name, QByteArray("test/int"));
+  QCOMPARE(reader.getRefs().at(2).type, static_cast<XPLMDataTypeID>(xplmType_Double));
+  QCOMPARE(reader.indexOf("test/data"), 5);
+  QCOMPARE(reader.indexOf("test/unknown"), -1);
+
+  int floatArr = reader.indexOf("test/float_arr");
+  qint64 lastTimestamp = 0L;
+  for(int frame = 0; frame < NUM_FRAMES; frame++)
+  {
+    QVERIFY(reader.nextFrame());
+    QVERIFY(reader.getTimestampNs() >= lastTimestamp);
+    lastTimestamp = reader.getTimestampNs();
+
+    bool keyFrame = frame % KEY_FRAME_INTERVAL == 0;
+    QCOMPARE(reader.isKeyFrame(), keyFrame);
+
+    // Delta frames contain only the changed int and the float array on every tenth frame
+    qsizetype expectedValues = keyFrame ? 6 : (frame % 10 == 0 ? 2 : 1);
+    QCOMPARE(reader.getChangedIndexes().size(), expectedValues);
+
+    QCOMPARE(reader.valueInt(0), frame);
+    QCOMPARE(reader.valueFloat(1), 1.5f);
+    QCOMPARE(reader.valueDouble(2), 50.0333333333);
+    QCOMPARE(reader.getValue(3).size(), 4 * static_cast<qsizetype>(sizeof(int)));
+    QCOMPARE(reinterpret_cast<const float *>(reader.getValue(floatArr).constData())[1], static_cast<float>(frame / 10));
+    QCOMPARE(reader.getValue(5), QByteArray("N172SP\0\0", 8));
+  }
+
+  QVERIFY(!reader.nextFrame());
+  QCOMPARE(reader.getFrameCount(), static_cast<quint64>(NUM_FRAMES));
+
+  reader.rewind();
+  QVERIFY(reader.nextFrame());
+  QCOMPARE(reader.valueInt(0), 0);
+}
+
+void DataRefCaptureTest::fileOperationsInFlush()
+{
+  QString filename = tempDir.filePath(QStringLiteral("flush.lxcrec"));
+  TestDataRefs refs;
+  xpc::DataRefRecorder recorder;
+
+  recorder.start(filename, refs.entries());
+  QVERIFY(recorder.isRecording());
+  QVERIFY(!QFile::exists(filename));
+
+  setFrameValues(0);
+  recorder.recordFrame();
+  recorder.flush();
+  QVERIFY(QFile::exists(filename));
+
+  // Frames recorded before stop are written by the next flush
+  setFrameValues(1);
+  recorder.recordFrame();
+  recorder.stop();
+  QVERIFY(!recorder.isRecording());
+  recorder.flush();
+
+  xpctest::DataRefCaptureReader reader;
+  QVERIFY(reader.open(filename));
+  QVERIFY(reader.nextFrame());
+  QVERIFY(reader.nextFrame());
+  QCOMPARE(reader.valueInt(0), 1);
+  QVERIFY(!reader.nextFrame());
+}
+
+void DataRefCaptureTest::restart()
+{
+  QString filename1 = tempDir.filePath(QStringLiteral("restart1.lxcrec"));
+  QString filename2 = tempDir.filePath(QStringLiteral("restart2.lxcrec"));
+
+  TestDataRefs refs;
+  xpc::DataRefRecorder recorder;
+  recordFile(recorder, refs, filename1, 20);
+
+  // Start without stop and flush both in one go
+  recordFile(recorder, refs, filename2, 30);
+  recorder.stop();
+  recorder.flush();
+
+  for(const auto& [filename, numFrames] : {std::pair(filename1, 20), std::pair(filename2, 30)})
+  {
+    xpctest::DataRefCaptureReader reader;
+    QVERIFY(reader.open(filename));
+    QVERIFY(reader.nextFrame());
+    QVERIFY(reader.isKeyFrame());
+    while(reader.nextFrame())
+      ;
+    QCOMPARE(reader.getFrameCount(), static_cast<quint64>(numFrames));
+  }
+}
+
+void DataRefCaptureTest::replay()
+{
+  QString filename = tempDir.filePath(QStringLiteral("replay.lxcrec"));
+  {
+    TestDataRefs refs;
+    xpc::DataRefRecorder recorder;
+    recordFile(recorder, refs, filename, NUM_FRAMES);
+    recorder.stop();
+    recorder.flush();
+  }
+
+  // Replay into an empty stub
+  xplmstub::reset();
+  xpctest::CaptureReplay replay;
+  QVERIFY(replay.open(filename));
+  QVERIFY(xplmstub::isDefined("test/float_arr"));
+
+  XPLMDataRef intRef = XPLMFindDataRef("test/int"), doubleRef = XPLMFindDataRef("test/double"),
+              floatArrRef = XPLMFindDataRef("test/float_arr"), dataRef = XPLMFindDataRef("test/data");
+  QCOMPARE(XPLMGetDataRefTypes(doubleRef), static_cast<XPLMDataTypeID>(xplmType_Double | xplmType_Float));
+
+  for(int frame = 0; frame < NUM_FRAMES; frame++)
+  {
+    QVERIFY(replay.applyNextFrame());
+    QCOMPARE(XPLMGetDatai(intRef), frame);
+    QCOMPARE(XPLMGetDatad(doubleRef), 50.0333333333);
+
+    float values[4];
+    QCOMPARE(XPLMGetDatavf(floatArrRef, values, 0, 4), 4);
+    QCOMPARE(values[1], static_cast<float>(frame / 10));
+
+    char data[8];
+    QCOMPARE(XPLMGetDatab(dataRef, data, 0, 8), 8);
+    QCOMPARE(QByteArray(data, 6), QByteArray("N172SP"));
+  }
+  QVERIFY(!replay.applyNextFrame());
+
+  // Replay by time applies all frames recorded up to now
+  QVERIFY(replay.open(filename));
+  QVERIFY(!replay.applyUntil(std::numeric_limits<qint64>::max()));
+  QCOMPARE(XPLMGetDatai(intRef), NUM_FRAMES - 1);
+  QCOMPARE(replay.getReader().getFrameCount(), static_cast<quint64>(NUM_FRAMES));
+}
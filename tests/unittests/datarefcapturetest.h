@@ -0,0 +1,52 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_DATAREFCAPTURETEST_H
+#define LITTLEXPC_DATAREFCAPTURETEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/*
+ * Records datarefs from the XPLM stub with xpc::DataRefRecorder and checks the file with the
+ * reader and the replay driver of the tests.
+ */
+class DataRefCaptureTest :
+  public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+
+  /* Delta and key frames and values as recorded */
+  void recordAndRead();
+
+  /* File is opened and closed in flush() only */
+  void fileOperationsInFlush();
+
+  /* Restart closes the first file completely */
+  void restart();
+
+  /* Values replayed into the stub are read back by the XPLM API */
+  void replay();
+
+private:
+  QTemporaryDir tempDir;
+};
+
+#endif // LITTLEXPC_DATAREFCAPTURETEST_H
@@ -0,0 +1,216 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "deadreckoningtest.h"
+
+#include "xpconnect/deadreckoning.h"
+
+#include <QTest>
+
+#include <cmath>
+#include <numbers>
+
+using xpc::DeadReckoningState;
+
+namespace {
+
+/* Same as in deadreckoning.cpp */
+const double EARTH_RADIUS_METER = 6371000.;
+
+/* Angle in degrees covered by the distance on a great circle */
+double meterToDeg(double meter)
+{
+  return meter / EARTH_RADIUS_METER * 180. / std::numbers::pi;
+}
+
+DeadReckoningState state(double latDeg, double lonDeg, float velocityEastMs, float velocityNorthMs, float turnRateDegS = 0.f)
+{
+  DeadReckoningState result;
+  result.latDeg = latDeg;
+  result.lonDeg = lonDeg;
+  result.altMeter = 1000.;
+  result.velocityEastMs = velocityEastMs;
+  result.velocityNorthMs = velocityNorthMs;
+  result.turnRateDegS = turnRateDegS;
+  result.simTimeSec = 100.;
+  return result;
+}
+
+} // namespace
+
+void DeadReckoningTest::straight_data()
+{
+  QTest::addColumn<double>("lat");
+  QTest::addColumn<float>("east");
+  QTest::addColumn<float>("north");
+  QTest::addColumn<double>("expectedLatDiff");
+  QTest::addColumn<double>("expectedLonDiff");
+
+  // Ten seconds with 100 m/s is one kilometer
+  QTest::newRow("North") << 50. << 0.f << 100.f << meterToDeg(1000.) << 0.;
+  QTest::newRow("South") << 50. << 0.f << -100.f << -meterToDeg(1000.) << 0.;
+  QTest::newRow("East at equator") << 0. << 100.f << 0.f << 0. << meterToDeg(1000.);
+  QTest::newRow("West at 60 deg") << 60. << -100.f << 0.f << 0. << -meterToDeg(1000.) * 2.;
+  QTest::newRow("Northeast") << 0. << 60.f << 80.f << meterToDeg(800.) << meterToDeg(600.);
+}
+
+void DeadReckoningTest::straight()
+{
+  QFETCH(double, lat);
+  QFETCH(float, east);
+  QFETCH(float, north);
+  QFETCH(double, expectedLatDiff);
+  QFETCH(double, expectedLonDiff);
+
+  DeadReckoningState start = state(lat, 8., east, north);
+  start.velocityUpMs = 5.f;
+  DeadReckoningState result = xpc::extrapolate(start, 10.);
+
+  QVERIFY(std::abs(result.latDeg - lat - expectedLatDiff) < 1.e-9);
+  QVERIFY(std::abs(result.lonDeg - 8. - expectedLonDiff) < 1.e-9);
+  QCOMPARE(result.altMeter, 1050.);
+  QCOMPARE(result.simTimeSec, 110.);
+
+  // Velocity is not changed without turn
+  QCOMPARE(result.velocityEastMs, east);
+  QCOMPARE(result.velocityNorthMs, north);
+  QVERIFY(std::abs(xpc::distanceMeter(start, result) - std::sqrt(1000. * 1000. + 50. * 50.)) < 0.01);
+
+  // Backwards in time returns to start - longitude scale is taken at the start latitude
+  DeadReckoningState back = xpc::extrapolate(result, -10.);
+  QVERIFY(xpc::distanceMeter(start, back) < 0.01);
+}
+
+void DeadReckoningTest::turning_data()
+{
+  QTest::addColumn<float>("turnRate");
+  QTest::addColumn<double>("seconds");
+  QTest::addColumn<double>("expectedEastMeter");
+  QTest::addColumn<double>("expectedNorthMeter");
+  QTest::addColumn<float>("expectedVelocityEast");
+  QTest::addColumn<float>("expectedVelocityNorth");
+
+  // Standard rate turn with 100 m/s starting north has a radius of 100 / (3 deg/s in rad)
+  double radius = 100. / (3. * std::numbers::pi / 180.);
+  QTest::newRow("Right quarter") << 3.f << 30. << radius << radius << 100.f << 0.f;
+  QTest::newRow("Right half") << 3.f << 60. << 2. * radius << 0. << 0.f << -100.f;
+  QTest::newRow("Right full") << 3.f << 120. << 0. << 0. << 0.f << 100.f;
+  QTest::newRow("Left quarter") << -3.f << 30. << -radius << radius << -100.f << 0.f;
+  QTest::newRow("Left half") << -3.f << 60. << -2. * radius << 0. << 0.f << -100.f;
+}
+
+void DeadReckoningTest::turning()
+{
+  QFETCH(float, turnRate);
+  QFETCH(double, seconds);
+  QFETCH(double, expectedEastMeter);
+  QFETCH(double, expectedNorthMeter);
+  QFETCH(float, expectedVelocityEast);
+  QFETCH(float, expectedVelocityNorth);
+
+  // Start at the equator where a degree of longitude and latitude have the same length
+  DeadReckoningState start = state(0., 0., 0.f, 100.f, turnRate);
+  DeadReckoningState result = xpc::extrapolate(start, seconds);
+
+  QVERIFY2(std::abs(result.latDeg - meterToDeg(expectedNorthMeter)) < meterToDeg(0.01), qPrintable(QString::number(result.latDeg)));
+  QVERIFY2(std::abs(result.lonDeg - meterToDeg(expectedEastMeter)) < meterToDeg(0.01), qPrintable(QString::number(result.lonDeg)));
+  QVERIFY(std::abs(result.velocityEastMs - expectedVelocityEast) < 1.e-3f);
+  QVERIFY(std::abs(result.velocityNorthMs - expectedVelocityNorth) < 1.e-3f);
+  QCOMPARE(result.turnRateDegS, turnRate);
+
+  // Speed is kept
+  QVERIFY(std::abs(std::hypot(result.velocityEastMs, result.velocityNorthMs) - 100.f) < 1.e-3f);
+}
+
+void DeadReckoningTest::pole_data()
+{
+  QTest::addColumn<double>("lat");
+  QTest::addColumn<float>("north");
+
+  QTest::newRow("North pole") << 89.99 << 100.f;
+  QTest::newRow("South pole") << -89.99 << -100.f;
+}
+
+void DeadReckoningTest::pole()
+{
+  QFETCH(double, lat);
+  QFETCH(float, north);
+
+  // Two kilometers cross the pole which is about 1.1 km away
+  DeadReckoningState start = state(lat, 10., 0.f, north);
+  DeadReckoningState result = xpc::extrapolate(start, 20.);
+
+  double overshoot = std::abs(lat) + meterToDeg(2000.) - 90.;
+  QVERIFY(overshoot > 0.);
+  QVERIFY(std::abs(std::abs(result.latDeg) - (90. - overshoot)) < 1.e-9);
+  QVERIFY(result.latDeg * lat > 0.);
+  QVERIFY(std::abs(result.lonDeg - -170.) < 1.e-9);
+
+  // Continues away from the pole on the opposite meridian
+  QCOMPARE(result.velocityNorthMs, -north);
+  QCOMPARE(result.velocityEastMs, 0.f);
+
+  DeadReckoningState next = xpc::extrapolate(result, 10.);
+  QVERIFY(std::abs(next.latDeg) < std::abs(result.latDeg));
+  QVERIFY(std::abs(next.lonDeg - -170.) < 1.e-9);
+}
+
+void DeadReckoningTest::antimeridian_data()
+{
+  QTest::addColumn<double>("lon");
+  QTest::addColumn<float>("east");
+  QTest::addColumn<double>("expectedLon");
+
+  // Two kilometers at the equator
+  QTest::newRow("Eastbound") << 179.995 << 100.f << 179.995 + meterToDeg(2000.) - 360.;
+  QTest::newRow("Westbound") << -179.995 << -100.f << -179.995 - meterToDeg(2000.) + 360.;
+  QTest::newRow("Not crossing") << 179.9 << 100.f << 179.9 + meterToDeg(2000.);
+}
+
+void DeadReckoningTest::antimeridian()
+{
+  QFETCH(double, lon);
+  QFETCH(float, east);
+  QFETCH(double, expectedLon);
+
+  DeadReckoningState start = state(0., lon, east, 0.f);
+  DeadReckoningState result = xpc::extrapolate(start, 20.);
+
+  QVERIFY(result.lonDeg >= -180. && result.lonDeg <= 180.);
+  QVERIFY2(std::abs(result.lonDeg - expectedLon) < 1.e-9, qPrintable(QString::number(result.lonDeg, 'f', 9)));
+  QCOMPARE(result.latDeg, 0.);
+
+  // Distance has to take the shorter way across the anti-meridian
+  QVERIFY(std::abs(xpc::distanceMeter(start, result) - 2000.) < 0.01);
+}
+
+void DeadReckoningTest::extrapolateTo()
+{
+  DeadReckoningState start = state(50., 8., 30.f, 40.f, 1.5f);
+  DeadReckoningState result1 = xpc::extrapolateTo(start, 107.5);
+  DeadReckoningState result2 = xpc::extrapolate(start, 7.5);
+
+  QCOMPARE(result1.simTimeSec, 107.5);
+  QCOMPARE(result1.latDeg, result2.latDeg);
+  QCOMPARE(result1.lonDeg, result2.lonDeg);
+  QCOMPARE(result1.velocityEastMs, result2.velocityEastMs);
+
+  // Extrapolating to the sample time does not change the state
+  DeadReckoningState same = xpc::extrapolateTo(start, start.simTimeSec);
+  QCOMPARE(same.latDeg, start.latDeg);
+  QCOMPARE(same.lonDeg, start.lonDeg);
+}
@@ -0,0 +1,43 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_DEADRECKONINGTEST_H
+#define LITTLEXPC_DEADRECKONINGTEST_H
+
+#include <QObject>
+
+/*
+ * Checks the reference extrapolator against positions calculated by hand.
+ */
+class DeadReckoningTest :
+  public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void straight_data();
+  void straight();
+  void turning_data();
+  void turning();
+  void pole_data();
+  void pole();
+  void antimeridian_data();
+  void antimeridian();
+  void extrapolateTo();
+};
+
+#endif // LITTLEXPC_DEADRECKONINGTEST_H
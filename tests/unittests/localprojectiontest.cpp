@@ -0,0 +1,215 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "localprojectiontest.h"
+
+#include "xplmstub.h"
+#include "xpconnect/localprojection.h"
+
+#include "geo/pos.h"
+
+#include <QTest>
+
+#include <cmath>
+#include <numbers>
+
+extern "C" {
+#include "XPLMGraphics.h"
+}
+
+using xpc::LocalProjection;
+
+namespace {
+
+/* Mean earth radius differing from the one used by X-Plane */
+const double MEAN_EARTH_RADIUS_METER = 6371000.;
+
+/* Highest altitude above origin used for validation in localprojection.cpp */
+const double MAX_HEIGHT_METER = 10000.;
+
+/* Positions are returned as float which adds up to half a unit in the last place for latitude and longitude */
+const double FLOAT_ROUNDING_METER = 1.5;
+
+/* Straight distance between two positions on a sphere with the given radius */
+double distanceMeter(double lat1, double lon1, double alt1, double lat2, double lon2, double alt2, double radius)
+{
+  auto cartesian = [radius](double lat, double lon, double alt, double& x, double& y, double& z) {
+                     double latRad = lat * std::numbers::pi / 180., lonRad = lon * std::numbers::pi / 180.;
+                     x = (radius + alt) * std::cos(latRad) * std::cos(lonRad);
+                     y = (radius + alt) * std::cos(latRad) * std::sin(lonRad);
+                     z = (radius + alt) * std::sin(latRad);
+                   };
+
+  double x1, y1, z1, x2, y2, z2;
+  cartesian(lat1, lon1, alt1, x1, y1, z1);
+  cartesian(lat2, lon2, alt2, x2, y2, z2);
+  return std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1) + (z2 - z1) * (z2 - z1));
+}
+
+/* Set stub origin and let the projection pick it up like the plugin does */
+void updateOrigin(LocalProjection& projection, double lat, double lon, double alt)
+{
+  xplmstub::setLocalOrigin(lat, lon, alt);
+  projection.update(static_cast<float>(lat), static_cast<float>(lon));
+}
+
+} // namespace
+
+void LocalProjectionTest::init()
+{
+  xplmstub::reset();
+}
+
+void LocalProjectionTest::errorBound_data()
+{
+  QTest::addColumn<double>("radius");
+  QTest::addColumn<double>("lat");
+  QTest::addColumn<double>("lon");
+  QTest::addColumn<double>("alt");
+  QTest::addColumn<double>("expectedRange");
+
+  struct Origin
+  {
+    const char *name;
+    double lat, lon, alt;
+  };
+
+  const Origin ORIGINS[] = {
+    {"EDDF", 50.0333, 8.5706, 111.},
+    {"Anti-meridian", 0., 179.95, 0.},
+    {"YSSY", -33.946, 151.177, 6.},
+    {"Greenland", 80., -20., 1500.},
+    {"North pole", 89.9, 0., 0.}
+  };
+
+  for(const Origin& origin : ORIGINS)
+  {
+    // Radius is derived from XPLMLocalToWorld() - error is only numerical and the largest range is used
+    QTest::newRow(qPrintable(QStringLiteral("%1 X-Plane radius").arg(QLatin1String(origin.name))))
+      << xplmstub::XPLANE_EARTH_RADIUS_METER << origin.lat << origin.lon << origin.alt << LocalProjection::MAX_RANGE_METER;
+
+    QTest::newRow(qPrintable(QStringLiteral("%1 mean radius").arg(QLatin1String(origin.name))))
+      << MEAN_EARTH_RADIUS_METER << origin.lat << origin.lon << origin.alt << LocalProjection::MAX_RANGE_METER;
+  }
+}
+
+void LocalProjectionTest::errorBound()
+{
+  QFETCH(double, radius);
+  QFETCH(double, lat);
+  QFETCH(double, lon);
+  QFETCH(double, alt);
+  QFETCH(double, expectedRange);
+
+  xplmstub::setEarthRadius(radius);
+  LocalProjection projection(false);
+  updateOrigin(projection, lat, lon, alt);
+
+  double range = projection.getValidRangeMeter();
+  QCOMPARE(range, expectedRange);
+  QVERIFY2(std::abs(projection.getEarthRadiusMeter() - radius) < 0.01,
+           qPrintable(QStringLiteral("radius %1").arg(projection.getEarthRadiusMeter(), 0, 'f', 3)));
+
+  // Grid of points within the valid range and height used for validation
+  const int STEPS = 10;
+  for(int i = -STEPS; i <= STEPS; i++)
+  {
+    for(int j = -STEPS; j <= STEPS; j++)
+    {
+      double x = range * i / STEPS, z = range * j / STEPS;
+      if(x * x + z * z > range * range)
+        continue;
+
+      for(double y : {0., MAX_HEIGHT_METER / 2., MAX_HEIGHT_METER})
+      {
+        double error = projection.errorMeter(x, y, z);
+        QVERIFY2(error < LocalProjection::MAX_ERROR_METER,
+                 qPrintable(QStringLiteral("x %1 y %2 z %3 error %4").arg(x).arg(y).arg(z).arg(error)));
+
+        // Check returned position independently - calculated points must not call X-Plane
+        quint64 numCalls = xplmstub::getLocalToWorldCount();
+        atools::geo::Pos pos = projection.localToWorld(x, y, z);
+        QCOMPARE(xplmstub::getLocalToWorldCount(), numCalls);
+
+        double latXp, lonXp, altXp;
+        XPLMLocalToWorld(x, y, z, &latXp, &lonXp, &altXp);
+        double distance = distanceMeter(pos.getLatY(), pos.getLonX(), pos.getAltitude(), latXp, lonXp, altXp, radius);
+        QVERIFY2(distance < LocalProjection::MAX_ERROR_METER + FLOAT_ROUNDING_METER,
+                 qPrintable(QStringLiteral("x %1 y %2 z %3 distance %4").arg(x).arg(y).arg(z).arg(distance)));
+      }
+    }
+  }
+  QCOMPARE(projection.getNumFallback(), 0);
+
+  // Outside of the range - result has to be the same as from X-Plane
+  double x = range * 1.5, y = 100., z = -range * 0.5;
+  atools::geo::Pos pos = projection.localToWorld(x, y, z);
+  QCOMPARE(projection.getNumFallback(), 1);
+
+  double latXp, lonXp, altXp;
+  XPLMLocalToWorld(x, y, z, &latXp, &lonXp, &altXp);
+  QCOMPARE(pos.getLatY(), static_cast<float>(latXp));
+  QCOMPARE(pos.getLonX(), static_cast<float>(lonXp));
+  QCOMPARE(pos.getAltitude(), static_cast<float>(altXp));
+}
+
+void LocalProjectionTest::noValidRange()
+{
+  // Implausible radius is replaced by the X-Plane default which exceeds the error bound even at the smallest range
+  xplmstub::setEarthRadius(MEAN_EARTH_RADIUS_METER * 0.9);
+  LocalProjection projection(false);
+  updateOrigin(projection, 50.0333, 8.5706, 111.);
+  QCOMPARE(projection.getValidRangeMeter(), 0.);
+
+  // All points including the origin are converted by X-Plane
+  const float X[] = {0.f, 100.f, -500.f}, Y[] = {0.f, 10.f, 1000.f}, Z[] = {0.f, -100.f, 700.f};
+  atools::geo::Pos positions[3];
+  projection.localToWorld(X, Y, Z, positions);
+  QCOMPARE(projection.getNumFallback(), 3);
+
+  for(int i = 0; i < 3; i++)
+  {
+    double latXp, lonXp, altXp;
+    XPLMLocalToWorld(X[i], Y[i], Z[i], &latXp, &lonXp, &altXp);
+    QCOMPARE(positions[i].getLatY(), static_cast<float>(latXp));
+    QCOMPARE(positions[i].getLonX(), static_cast<float>(lonXp));
+    QCOMPARE(positions[i].getAltitude(), static_cast<float>(altXp));
+  }
+}
+
+void LocalProjectionTest::originChange()
+{
+  LocalProjection projection(false);
+  updateOrigin(projection, 50.0333, 8.5706, 111.);
+
+  // Same reference does not recalculate and does not call X-Plane
+  quint64 numCalls = xplmstub::getLocalToWorldCount();
+  QVERIFY(numCalls > 0);
+  projection.update(50.0333f, 8.5706f);
+  QCOMPARE(xplmstub::getLocalToWorldCount(), numCalls);
+
+  // X-Plane moves the origin about 80 km north - same local point has to follow
+  atools::geo::Pos before = projection.localToWorld(0., 0., 0.);
+  updateOrigin(projection, 50.75, 8.5706, 111.);
+  QVERIFY(xplmstub::getLocalToWorldCount() > numCalls);
+
+  atools::geo::Pos after = projection.localToWorld(0., 0., 0.);
+  QVERIFY(std::abs(before.getLatY() - 50.0333f) < 1.e-4f);
+  QVERIFY(std::abs(after.getLatY() - 50.75f) < 1.e-4f);
+  QVERIFY(std::abs(after.getAltitude() - 111.f) < 0.01f);
+  QCOMPARE(projection.getValidRangeMeter(), LocalProjection::MAX_RANGE_METER);
+}
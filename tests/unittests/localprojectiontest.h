@@ -0,0 +1,40 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_LOCALPROJECTIONTEST_H
+#define LITTLEXPC_LOCALPROJECTIONTEST_H
+
+#include <QObject>
+
+/*
+ * Checks the tangent plane calculation of xpc::LocalProjection against XPLMLocalToWorld() of the stub for
+ * several origins and earth radii.
+ */
+class LocalProjectionTest :
+  public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void errorBound_data();
+  void errorBound();
+  void noValidRange();
+  void originChange();
+};
+
+#endif // LITTLEXPC_LOCALPROJECTIONTEST_H
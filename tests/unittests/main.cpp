@@ -0,0 +1,54 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "datarefcapturetest.h"
+#include "deadreckoningtest.h"
+#include "localprojectiontest.h"
+#include "sharedmemorylayouttest.h"
+#include "tcasconversiontest.h"
+
+#include <QCoreApplication>
+#include <QTest>
+
+/*
+ * Runs all unit test classes. Pass Qt Test options like "-o" or "-v2" on the command line.
+ */
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("Little Xpconnect Tests"));
+  QCoreApplication::setOrganizationName(QStringLiteral("ABarthel"));
+
+  int result = 0;
+
+  DataRefCaptureTest dataRefCaptureTest;
+  result |= QTest::qExec(&dataRefCaptureTest, argc, argv);
+
+  DeadReckoningTest deadReckoningTest;
+  result |= QTest::qExec(&deadReckoningTest, argc, argv);
+
+  LocalProjectionTest localProjectionTest;
+  result |= QTest::qExec(&localProjectionTest, argc, argv);
+
+  SharedMemoryLayoutTest sharedMemoryLayoutTest;
+  result |= QTest::qExec(&sharedMemoryLayoutTest, argc, argv);
+
+  TcasConversionTest tcasConversionTest;
+  result |= QTest::qExec(&tcasConversionTest, argc, argv);
+
+  return result;
+}
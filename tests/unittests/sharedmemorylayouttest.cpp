@@ -0,0 +1,120 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sharedmemorylayouttest.h"
+
+#include "sharedmemoryreader.h"
+#include "xpconnect/sharedmemorywriter.h"
+
+#include <QSharedMemory>
+#include <QTest>
+#include <QtEndian>
+
+using xpctest::SharedMemoryReader;
+
+namespace {
+
+/* Arbitrary payload - layout does not depend on the content */
+const QByteArray DATA("0123456789");
+
+xpc::LatencyTimestamps timestamps()
+{
+  xpc::LatencyTimestamps result;
+  result.captureNs = 1000L;
+  result.publishNs = 2000L;
+  result.serializedNs = 0x0102030405060708L;
+  return result;
+}
+
+} // namespace
+
+void SharedMemoryLayoutTest::layout()
+{
+  QByteArray segment;
+  SharedMemoryWriter::buildSegment(segment, DATA, true, timestamps());
+
+  // Magic and four timestamps
+  QCOMPARE(SharedMemoryWriter::LATENCY_TRAILER_SIZE, qsizetype(36));
+  QCOMPARE(segment.size(), 8 + DATA.size() + 36);
+
+  // Offset 0: quint32 size of header and data - offset 4: quint32 terminated flag - all big endian
+  QCOMPARE(qFromBigEndian<quint32>(segment.constData()), static_cast<quint32>(8 + DATA.size()));
+  QCOMPARE(qFromBigEndian<quint32>(segment.constData() + 4), 1U);
+
+  // Offset 8: serialized SimConnectData
+  QCOMPARE(segment.mid(8, DATA.size()), DATA);
+
+  // Trailer directly behind the data: "LXLT" followed by capture, publish, serialized and written
+  const char *trailer = segment.constData() + 8 + DATA.size();
+  QCOMPARE(QByteArray(trailer, 4), QByteArray("LXLT"));
+  QCOMPARE(qFromBigEndian<qint64>(trailer + 4), qint64(1000));
+  QCOMPARE(qFromBigEndian<qint64>(trailer + 12), qint64(2000));
+  QCOMPARE(QByteArray(trailer + 20, 8), QByteArray("\x01\x02\x03\x04\x05\x06\x07\x08", 8));
+
+  // Written time is set only when copying into shared memory
+  QCOMPARE(qFromBigEndian<qint64>(trailer + 28), qint64(0));
+
+  // Reader uses the size from the header to find the trailer
+  xpc::LatencyTimestamps read;
+  QVERIFY(SharedMemoryReader::readTrailer(segment, qFromBigEndian<quint32>(segment.constData()), read));
+  QCOMPARE(read.captureNs, qint64(1000));
+  QCOMPARE(read.publishNs, qint64(2000));
+  QCOMPARE(read.serializedNs, qint64(0x0102030405060708));
+  QCOMPARE(read.writtenNs, qint64(0));
+
+  SharedMemoryWriter::buildSegment(segment, DATA, false, timestamps());
+  QCOMPARE(qFromBigEndian<quint32>(segment.constData() + 4), 0U);
+}
+
+void SharedMemoryLayoutTest::missingTrailer()
+{
+  QByteArray segment;
+  SharedMemoryWriter::buildSegment(segment, DATA, false, timestamps());
+  quint32 dataSize = qFromBigEndian<quint32>(segment.constData());
+  xpc::LatencyTimestamps read;
+
+  // Older plugin versions copy only header and data
+  QVERIFY(!SharedMemoryReader::readTrailer(segment.first(dataSize), dataSize, read));
+
+  // Truncated trailer
+  QVERIFY(!SharedMemoryReader::readTrailer(segment.chopped(1), dataSize, read));
+
+  // Wrong magic
+  segment[dataSize] = 'X';
+  QVERIFY(!SharedMemoryReader::readTrailer(segment, dataSize, read));
+}
+
+void SharedMemoryLayoutTest::writeData()
+{
+  // Use own key to avoid disturbing a running simulator
+  QSharedMemory sharedMemory(QStringLiteral("LittleXpconnectLayoutTest"));
+  QVERIFY2(sharedMemory.create(4096) || sharedMemory.attach(), qPrintable(sharedMemory.errorString()));
+
+  xpc::LatencyTimestamps written = timestamps();
+  written.serializedNs = xpc::PerfCounters::monotonicNs();
+  qint64 bytes = SharedMemoryWriter::writeData(sharedMemory, DATA, false, written);
+  QCOMPARE(bytes, static_cast<qint64>(8 + DATA.size() + SharedMemoryWriter::LATENCY_TRAILER_SIZE));
+  QVERIFY(written.writtenNs >= written.serializedNs);
+
+  QByteArray segment(static_cast<const char *>(sharedMemory.constData()), bytes);
+  xpc::LatencyTimestamps read;
+  QVERIFY(SharedMemoryReader::readTrailer(segment, qFromBigEndian<quint32>(segment.constData()), read));
+  QCOMPARE(read.serializedNs, written.serializedNs);
+  QCOMPARE(read.writtenNs, written.writtenNs);
+
+  sharedMemory.detach();
+}
@@ -0,0 +1,43 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_SHAREDMEMORYLAYOUTTEST_H
+#define LITTLEXPC_SHAREDMEMORYLAYOUTTEST_H
+
+#include <QObject>
+
+/*
+ * Documents the layout of the main shared memory segment including the latency trailer and checks that
+ * SharedMemoryWriter and the reference reader agree on it.
+ */
+class SharedMemoryLayoutTest :
+  public QObject
+{
+  Q_OBJECT
+
+private slots:
+  /* Byte offsets of header, data and trailer */
+  void layout();
+
+  /* Segments of older plugin versions without trailer and corrupted trailers */
+  void missingTrailer();
+
+  /* Written timestamp is set when copying into shared memory */
+  void writeData();
+};
+
+#endif // LITTLEXPC_SHAREDMEMORYLAYOUTTEST_H
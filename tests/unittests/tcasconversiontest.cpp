@@ -0,0 +1,179 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "tcasconversiontest.h"
+
+#include "xpconnect/tcasconversion.h"
+
+#include <QTest>
+
+#include <bit>
+#include <cmath>
+
+using xpc::TcasArrays;
+using xpc::TcasKernel;
+using xpc::TCAS_ARRAY_SIZE;
+
+namespace {
+
+/* Bitwise equal to catch differences in rounding and sign of zero. NaN payloads are not compared. */
+bool sameValue(float value1, float value2)
+{
+  return std::bit_cast<quint32>(value1) == std::bit_cast<quint32>(value2) || (std::isnan(value1) && std::isnan(value2));
+}
+
+/* Compare outputs and return a description of the first difference or an empty string */
+QString compareOutputs(const TcasArrays& reference, const TcasArrays& arrays)
+{
+  for(int i = 0; i < TCAS_ARRAY_SIZE; i++)
+  {
+    if(!sameValue(reference.altitudeFt[i], arrays.altitudeFt[i]))
+      return QStringLiteral("altitudeFt for %1").arg(reference.elevationMeter[i], 0, 'g', 9);
+    if(!sameValue(reference.groundSpeedKts[i], arrays.groundSpeedKts[i]))
+      return QStringLiteral("groundSpeedKts for %1").arg(reference.speedMs[i], 0, 'g', 9);
+    if(!sameValue(reference.verticalSpeedMs[i], arrays.verticalSpeedMs[i]))
+      return QStringLiteral("verticalSpeedMs for %1").arg(reference.verticalSpeedFpm[i], 0, 'g', 9);
+    if(!sameValue(reference.horizontalSpeedMs[i], arrays.horizontalSpeedMs[i]))
+      return QStringLiteral("horizontalSpeedMs for %1 and %2").
+             arg(reference.speedMs[i], 0, 'g', 9).arg(reference.verticalSpeedFpm[i], 0, 'g', 9);
+    if(reference.hasPosition[i] != arrays.hasPosition[i])
+      return QStringLiteral("hasPosition for %1 and %2").arg(reference.lonX[i], 0, 'g', 9).arg(reference.latY[i], 0, 'g', 9);
+  }
+  return QString();
+}
+
+void addKernelRows()
+{
+  QTest::addColumn<int>("kernel");
+  QTest::newRow("SSE2") << static_cast<int>(xpc::TCAS_KERNEL_SSE2);
+  QTest::newRow("AVX2") << static_cast<int>(xpc::TCAS_KERNEL_AVX2);
+}
+
+} // namespace
+
+void TcasConversionTest::initTestCase()
+{
+  xpc::initTcasConversion();
+}
+
+void TcasConversionTest::fullDomain_data()
+{
+  addKernelRows();
+}
+
+void TcasConversionTest::fullDomain()
+{
+  QFETCH(int, kernel);
+  if(!xpc::isTcasKernelSupported(static_cast<TcasKernel>(kernel)))
+    QSKIP("Kernel not supported by CPU");
+
+  TcasArrays reference, arrays;
+  for(quint64 bits = 0L; bits <= 0xffffffffL; bits += TCAS_ARRAY_SIZE)
+  {
+    for(int i = 0; i < TCAS_ARRAY_SIZE; i++)
+    {
+      float value = std::bit_cast<float>(static_cast<quint32>(bits + static_cast<quint64>(i)));
+      reference.elevationMeter[i] = reference.speedMs[i] = reference.verticalSpeedFpm[i] = reference.lonX[i] = value;
+
+      // Both signs of zero for the other coordinate
+      reference.latY[i] = i % 2 == 0 ? 0.f : -0.f;
+    }
+    arrays = reference;
+
+    xpc::convertTcasArrays(reference, xpc::TCAS_KERNEL_SCALAR);
+    xpc::convertTcasArrays(arrays, static_cast<TcasKernel>(kernel));
+
+    QString difference = compareOutputs(reference, arrays);
+    if(!difference.isEmpty())
+      QFAIL(qPrintable(QStringLiteral("Kernel differs from scalar in ") + difference));
+  }
+}
+
+void TcasConversionTest::horizontalSpeed_data()
+{
+  addKernelRows();
+}
+
+void TcasConversionTest::horizontalSpeed()
+{
+  QFETCH(int, kernel);
+  if(!xpc::isTcasKernelSupported(static_cast<TcasKernel>(kernel)))
+    QSKIP("Kernel not supported by CPU");
+
+  // Linear congruential generator to get the same values on each run
+  quint32 seed = 0x4c5843;
+  auto random = [&seed]() -> quint32 {
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+  };
+
+  TcasArrays reference, arrays;
+  for(int run = 0; run < 1 << 18; run++)
+  {
+    for(int i = 0; i < TCAS_ARRAY_SIZE; i++)
+    {
+      // Every second value in the usual range to get more results which are not zero
+      if(i % 2 == 0)
+      {
+        reference.speedMs[i] = static_cast<float>(random() >> 8) / static_cast<float>(1 << 24) * 350.f;
+        reference.verticalSpeedFpm[i] = static_cast<float>(random() >> 8) / static_cast<float>(1 << 24) * 16000.f - 8000.f;
+      }
+      else
+      {
+        reference.speedMs[i] = std::bit_cast<float>(random());
+        reference.verticalSpeedFpm[i] = std::bit_cast<float>(random());
+      }
+    }
+    arrays = reference;
+
+    xpc::convertTcasArrays(reference, xpc::TCAS_KERNEL_SCALAR);
+    xpc::convertTcasArrays(arrays, static_cast<TcasKernel>(kernel));
+
+    QString difference = compareOutputs(reference, arrays);
+    if(!difference.isEmpty())
+      QFAIL(qPrintable(QStringLiteral("Kernel differs from scalar in ") + difference));
+  }
+}
+
+void TcasConversionTest::benchmark_data()
+{
+  QTest::addColumn<int>("kernel");
+  QTest::newRow("scalar") << static_cast<int>(xpc::TCAS_KERNEL_SCALAR);
+  QTest::newRow("SSE2") << static_cast<int>(xpc::TCAS_KERNEL_SSE2);
+  QTest::newRow("AVX2") << static_cast<int>(xpc::TCAS_KERNEL_AVX2);
+}
+
+void TcasConversionTest::benchmark()
+{
+  QFETCH(int, kernel);
+  if(!xpc::isTcasKernelSupported(static_cast<TcasKernel>(kernel)))
+    QSKIP("Kernel not supported by CPU");
+
+  TcasArrays arrays;
+  for(int i = 0; i < TCAS_ARRAY_SIZE; i++)
+  {
+    arrays.lonX[i] = 8.f + static_cast<float>(i) * 0.01f;
+    arrays.latY[i] = 50.f + static_cast<float>(i) * 0.01f;
+    arrays.elevationMeter[i] = static_cast<float>(i) * 150.f;
+    arrays.speedMs[i] = static_cast<float>(i) * 4.f;
+    arrays.verticalSpeedFpm[i] = static_cast<float>(i % 16) * 250.f - 2000.f;
+  }
+
+  QBENCHMARK {
+    xpc::convertTcasArrays(arrays, static_cast<TcasKernel>(kernel));
+  }
+}
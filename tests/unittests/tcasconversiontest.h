@@ -0,0 +1,47 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_TCASCONVERSIONTEST_H
+#define LITTLEXPC_TCASCONVERSIONTEST_H
+
+#include <QObject>
+
+/*
+ * Checks all TCAS conversion kernels supported by the CPU bitwise against the scalar atools implementation.
+ */
+class TcasConversionTest :
+  public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+
+  /* All float values as single input for altitude, speeds and position */
+  void fullDomain_data();
+  void fullDomain();
+
+  /* Random pairs of total and vertical speed for horizontal speed */
+  void horizontalSpeed_data();
+  void horizontalSpeed();
+
+  /* Time for one conversion of all arrays */
+  void benchmark_data();
+  void benchmark();
+};
+
+#endif // LITTLEXPC_TCASCONVERSIONTEST_H
@@ -0,0 +1,364 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xplmstub.h"
+#include "stubinternal.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <cstring>
+
+/*
+ * In-memory dataref store replacing XPLMDataAccess.
+ */
+namespace {
+
+/* A dataref defined by the tests or registered by the plugin. Pointer is used as XPLMDataRef. */
+struct StubDataRef
+{
+  QByteArray name;
+  XPLMDataTypeID types = xplmType_Unknown;
+
+  /* Set when removed - found refs stay valid pointers but return zero */
+  bool removed = false;
+
+  /* Values for refs defined by tests. Scalar is kept as double to avoid losing precision for lat/lon. */
+  double scalar = 0.;
+  QList<int> ints;
+  QList<float> floats;
+  QByteArray bytes;
+
+  /* Callbacks for refs registered by XPLMRegisterDataAccessor() */
+  bool accessor = false;
+  XPLMGetDatai_f geti = nullptr;
+  XPLMGetDataf_f getf = nullptr;
+  XPLMGetDatad_f getd = nullptr;
+  XPLMGetDatavi_f getvi = nullptr;
+  XPLMGetDatavf_f getvf = nullptr;
+  XPLMGetDatab_f getb = nullptr;
+  void *refcon = nullptr;
+};
+
+/* Active refs by name */
+QHash<QByteArray, StubDataRef *> refsByName;
+
+/* Owns all refs including removed ones until reset */
+QList<StubDataRef *> allRefs;
+
+quint64 readCount = 0L, readBytes = 0L;
+
+StubDataRef *toRef(XPLMDataRef dataRef)
+{
+  StubDataRef *ref = static_cast<StubDataRef *>(dataRef);
+  return ref != nullptr && !ref->removed ? ref : nullptr;
+}
+
+/* Get existing ref or create a new one with the given types */
+StubDataRef *getOrCreate(const char *name, XPLMDataTypeID types)
+{
+  StubDataRef *ref = refsByName.value(QByteArray(name), nullptr);
+  if(ref == nullptr)
+  {
+    ref = new StubDataRef;
+    ref->name = QByteArray(name);
+    ref->types = types;
+    allRefs.append(ref);
+    refsByName.insert(ref->name, ref);
+  }
+  return ref;
+}
+
+/* Copy part of an array like X-Plane does. Returns the size if out is null or the number of copied values otherwise. */
+template<typename TYPE>
+int copyArray(const QList<TYPE>& values, TYPE *out, int offset, int max)
+{
+  int size = static_cast<int>(values.size());
+  if(out == nullptr)
+    return size;
+
+  int num = std::max(0, std::min(max, size - offset));
+  if(num > 0)
+  {
+    std::copy_n(values.constData() + offset, num, out);
+    readBytes += static_cast<quint64>(num) * sizeof(TYPE);
+  }
+  return num;
+}
+
+double scalarValue(StubDataRef *ref)
+{
+  readCount++;
+  if(ref == nullptr)
+    return 0.;
+
+  if(ref->accessor)
+  {
+    if(ref->getd != nullptr)
+      return ref->getd(ref->refcon);
+    else if(ref->getf != nullptr)
+      return static_cast<double>(ref->getf(ref->refcon));
+    else if(ref->geti != nullptr)
+      return static_cast<double>(ref->geti(ref->refcon));
+    return 0.;
+  }
+  return ref->scalar;
+}
+
+} // namespace
+
+// ==========================================================================================
+// XPLMDataAccess API
+extern "C" {
+
+XPLM_API XPLMDataRef XPLMFindDataRef(const char *inDataRefName)
+{
+  return refsByName.value(QByteArray(inDataRefName), nullptr);
+}
+
+XPLM_API XPLMDataTypeID XPLMGetDataRefTypes(XPLMDataRef inDataRef)
+{
+  StubDataRef *ref = toRef(inDataRef);
+  return ref != nullptr ? ref->types : xplmType_Unknown;
+}
+
+XPLM_API int XPLMGetDatai(XPLMDataRef inDataRef)
+{
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref != nullptr && ref->accessor && ref->geti != nullptr)
+  {
+    readCount++;
+    return ref->geti(ref->refcon);
+  }
+  return static_cast<int>(scalarValue(ref));
+}
+
+XPLM_API float XPLMGetDataf(XPLMDataRef inDataRef)
+{
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref != nullptr && ref->accessor && ref->getf != nullptr)
+  {
+    readCount++;
+    return ref->getf(ref->refcon);
+  }
+  return static_cast<float>(scalarValue(ref));
+}
+
+XPLM_API double XPLMGetDatad(XPLMDataRef inDataRef)
+{
+  return scalarValue(toRef(inDataRef));
+}
+
+XPLM_API int XPLMGetDatavi(XPLMDataRef inDataRef, int *outValues, int inOffset, int inMax)
+{
+  readCount++;
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref == nullptr)
+    return 0;
+  else if(ref->accessor)
+    return ref->getvi != nullptr ? ref->getvi(ref->refcon, outValues, inOffset, inMax) : 0;
+  else
+    return copyArray(ref->ints, outValues, inOffset, inMax);
+}
+
+XPLM_API int XPLMGetDatavf(XPLMDataRef inDataRef, float *outValues, int inOffset, int inMax)
+{
+  readCount++;
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref == nullptr)
+    return 0;
+  else if(ref->accessor)
+    return ref->getvf != nullptr ? ref->getvf(ref->refcon, outValues, inOffset, inMax) : 0;
+  else
+    return copyArray(ref->floats, outValues, inOffset, inMax);
+}
+
+XPLM_API int XPLMGetDatab(XPLMDataRef inDataRef, void *outValue, int inOffset, int inMaxBytes)
+{
+  readCount++;
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref == nullptr)
+    return 0;
+  else if(ref->accessor)
+    return ref->getb != nullptr ? ref->getb(ref->refcon, outValue, inOffset, inMaxBytes) : 0;
+
+  int size = static_cast<int>(ref->bytes.size());
+  if(outValue == nullptr)
+    return size;
+
+  int num = std::max(0, std::min(inMaxBytes, size - inOffset));
+  if(num > 0)
+  {
+    std::memcpy(outValue, ref->bytes.constData() + inOffset, static_cast<size_t>(num));
+    readBytes += static_cast<quint64>(num);
+  }
+  return num;
+}
+
+XPLM_API XPLMDataRef XPLMRegisterDataAccessor(const char *inDataName, XPLMDataTypeID inDataType, int inIsWritable,
+                                              XPLMGetDatai_f inReadInt, XPLMSetDatai_f inWriteInt,
+                                              XPLMGetDataf_f inReadFloat, XPLMSetDataf_f inWriteFloat,
+                                              XPLMGetDatad_f inReadDouble, XPLMSetDatad_f inWriteDouble,
+                                              XPLMGetDatavi_f inReadIntArray, XPLMSetDatavi_f inWriteIntArray,
+                                              XPLMGetDatavf_f inReadFloatArray, XPLMSetDatavf_f inWriteFloatArray,
+                                              XPLMGetDatab_f inReadData, XPLMSetDatab_f inWriteData,
+                                              void *inReadRefcon, void *inWriteRefcon)
+{
+  Q_UNUSED(inIsWritable)
+  Q_UNUSED(inWriteInt)
+  Q_UNUSED(inWriteFloat)
+  Q_UNUSED(inWriteDouble)
+  Q_UNUSED(inWriteIntArray)
+  Q_UNUSED(inWriteFloatArray)
+  Q_UNUSED(inWriteData)
+  Q_UNUSED(inWriteRefcon)
+
+  // Replaces a ref with the same name
+  StubDataRef *old = refsByName.value(QByteArray(inDataName), nullptr);
+  if(old != nullptr)
+    old->removed = true;
+
+  StubDataRef *ref = new StubDataRef;
+  ref->name = QByteArray(inDataName);
+  ref->types = inDataType;
+  ref->accessor = true;
+  ref->geti = inReadInt;
+  ref->getf = inReadFloat;
+  ref->getd = inReadDouble;
+  ref->getvi = inReadIntArray;
+  ref->getvf = inReadFloatArray;
+  ref->getb = inReadData;
+  ref->refcon = inReadRefcon;
+
+  allRefs.append(ref);
+  refsByName.insert(ref->name, ref);
+  return ref;
+}
+
+XPLM_API void XPLMUnregisterDataAccessor(XPLMDataRef inDataRef)
+{
+  StubDataRef *ref = toRef(inDataRef);
+  if(ref != nullptr && ref->accessor)
+  {
+    ref->removed = true;
+    if(refsByName.value(ref->name) == ref)
+      refsByName.remove(ref->name);
+  }
+}
+
+} // extern "C"
+
+// ==========================================================================================
+// Control API
+namespace xplmstub {
+
+void internal::resetDataAccess()
+{
+  qDeleteAll(allRefs);
+  allRefs.clear();
+  refsByName.clear();
+  readCount = readBytes = 0L;
+}
+
+void setInt(const char *name, int value, XPLMDataTypeID types)
+{
+  getOrCreate(name, types)->scalar = value;
+}
+
+void setFloat(const char *name, float value, XPLMDataTypeID types)
+{
+  getOrCreate(name, types)->scalar = static_cast<double>(value);
+}
+
+void setDouble(const char *name, double value, XPLMDataTypeID types)
+{
+  getOrCreate(name, types)->scalar = value;
+}
+
+void setIntArray(const char *name, std::span<const int> values)
+{
+  getOrCreate(name, xplmType_IntArray)->ints = QList<int>(values.begin(), values.end());
+}
+
+void setFloatArray(const char *name, std::span<const float> values)
+{
+  getOrCreate(name, xplmType_FloatArray)->floats = QList<float>(values.begin(), values.end());
+}
+
+void setBytes(const char *name, QByteArrayView bytes)
+{
+  getOrCreate(name, xplmType_Data)->bytes = bytes.toByteArray();
+}
+
+void setIntArray(const char *name, int index, int value)
+{
+  StubDataRef *ref = refsByName.value(QByteArray(name), nullptr);
+  if(ref != nullptr && index >= 0 && index < ref->ints.size())
+    ref->ints[index] = value;
+}
+
+void setFloatArray(const char *name, int index, float value)
+{
+  StubDataRef *ref = refsByName.value(QByteArray(name), nullptr);
+  if(ref != nullptr && index >= 0 && index < ref->floats.size())
+    ref->floats[index] = value;
+}
+
+void define(const char *name, XPLMDataTypeID types, int arraySize)
+{
+  if(refsByName.contains(QByteArray(name)))
+    return;
+
+  StubDataRef *ref = getOrCreate(name, types);
+  if(types & xplmType_IntArray)
+    ref->ints.fill(0, arraySize);
+  if(types & xplmType_FloatArray)
+    ref->floats.fill(0.f, arraySize);
+  if(types & xplmType_Data)
+    ref->bytes.fill('\0', arraySize);
+}
+
+void undefine(const char *name)
+{
+  StubDataRef *ref = refsByName.take(QByteArray(name));
+  if(ref != nullptr)
+    ref->removed = true;
+}
+
+bool isDefined(const char *name)
+{
+  return refsByName.contains(QByteArray(name));
+}
+
+QList<QByteArray> getNames()
+{
+  QList<QByteArray> names = refsByName.keys();
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+quint64 getReadCount()
+{
+  return readCount;
+}
+
+quint64 getReadBytes()
+{
+  return readBytes;
+}
+
+} // namespace xplmstub
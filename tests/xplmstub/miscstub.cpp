@@ -0,0 +1,420 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xplmstub.h"
+#include "stubinternal.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+extern "C" {
+#include "XPLMGraphics.h"
+#include "XPLMPlanes.h"
+#include "XPLMPlugin.h"
+#include "XPLMUtilities.h"
+}
+
+/*
+ * Small XPLM APIs replaced by the stub: Graphics, Menus, Planes, Plugin and Utilities.
+ */
+namespace {
+
+/* Id returned by XPLMGetMyID() */
+const XPLMPluginID PLUGIN_ID = 1;
+
+// Graphics ======================================================================
+struct Vec
+{
+  double x, y, z;
+
+  Vec operator+(const Vec& other) const
+  {
+    return {x + other.x, y + other.y, z + other.z};
+  }
+
+  Vec operator-(const Vec& other) const
+  {
+    return {x - other.x, y - other.y, z - other.z};
+  }
+
+  Vec operator*(double factor) const
+  {
+    return {x * factor, y * factor, z * factor};
+  }
+
+  double dot(const Vec& other) const
+  {
+    return x * other.x + y * other.y + z * other.z;
+  }
+
+};
+
+double earthRadius = xplmstub::XPLANE_EARTH_RADIUS_METER;
+double originLat = 0., originLon = 0., originAlt = 0.;
+quint64 localToWorldCount = 0L;
+
+/* Earth centered coordinates on a sphere */
+Vec toCartesian(double latDeg, double lonDeg, double altMeter)
+{
+  double lat = latDeg * M_PI / 180., lon = lonDeg * M_PI / 180., r = earthRadius + altMeter;
+  return {r * std::cos(lat) * std::cos(lon), r * std::cos(lat) * std::sin(lon), r * std::sin(lat)};
+}
+
+/* Origin and unit vectors east, north and up of the local tangent plane */
+void localFrame(Vec& origin, Vec& east, Vec& north, Vec& up)
+{
+  double lat = originLat * M_PI / 180., lon = originLon * M_PI / 180.;
+  origin = toCartesian(originLat, originLon, originAlt);
+  east = {-std::sin(lon), std::cos(lon), 0.};
+  north = {-std::sin(lat) * std::cos(lon), -std::sin(lat) * std::sin(lon), std::cos(lat)};
+  up = {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+}
+
+// Menus ======================================================================
+struct StubMenuItem
+{
+  QString name;
+  void *itemRef = nullptr;
+  XPLMMenuCheck check = xplm_Menu_NoCheck;
+  bool enabled = true;
+};
+
+/* Pointer is used as XPLMMenuID */
+struct StubMenu
+{
+  QString name;
+  XPLMMenuHandler_f handler = nullptr;
+  void *menuRef = nullptr;
+  QList<StubMenuItem> items;
+  bool destroyed = false;
+};
+
+/* Index 0 is the plugins menu. Menus are kept until reset. */
+QList<StubMenu *> menus;
+
+StubMenu *toMenu(XPLMMenuID menuId)
+{
+  StubMenu *menu = static_cast<StubMenu *>(menuId);
+  return menu != nullptr && !menu->destroyed ? menu : nullptr;
+}
+
+StubMenuItem *toItem(XPLMMenuID menuId, int index)
+{
+  StubMenu *menu = toMenu(menuId);
+  return menu != nullptr && index >= 0 && index < menu->items.size() ? &menu->items[index] : nullptr;
+}
+
+/* Find first item with name in all menus */
+bool findItem(const char *name, StubMenu *& menuFound, StubMenuItem *& itemFound)
+{
+  QString itemName = QString::fromUtf8(name);
+  for(StubMenu *menu : std::as_const(menus))
+  {
+    if(menu->destroyed)
+      continue;
+
+    for(StubMenuItem& item : menu->items)
+    {
+      if(item.name == itemName)
+      {
+        menuFound = menu;
+        itemFound = &item;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Planes, plugin and utilities ======================================================
+QStringList aircraftModels;
+QString pluginPath = QDir::cleanPath(QDir::temp().filePath(QStringLiteral("X-Plane 12/Resources/plugins/Little Xpconnect/64/lin.xpl")));
+QStringList debugStrings;
+bool echoDebugStrings = false;
+
+/* Copy string into an SDK buffer if not null */
+void copyString(char *out, const QString& str, size_t size)
+{
+  if(out != nullptr)
+    std::snprintf(out, size, "%s", str.toUtf8().constData());
+}
+
+} // namespace
+
+// ==========================================================================================
+// XPLM APIs
+extern "C" {
+
+// Graphics ======================================================================
+XPLM_API void XPLMWorldToLocal(double inLatitude, double inLongitude, double inAltitude, double *outX, double *outY,
+                               double *outZ)
+{
+  localToWorldCount++;
+  Vec origin, east, north, up;
+  localFrame(origin, east, north, up);
+
+  Vec diff = toCartesian(inLatitude, inLongitude, inAltitude) - origin;
+  *outX = diff.dot(east);
+  *outY = diff.dot(up);
+  *outZ = -diff.dot(north);
+}
+
+XPLM_API void XPLMLocalToWorld(double inX, double inY, double inZ, double *outLatitude, double *outLongitude,
+                               double *outAltitude)
+{
+  localToWorldCount++;
+  Vec origin, east, north, up;
+  localFrame(origin, east, north, up);
+
+  Vec pos = origin + east * inX + up * inY - north * inZ;
+  double r = std::sqrt(pos.dot(pos));
+  *outLatitude = std::asin(pos.z / r) * 180. / M_PI;
+  *outLongitude = std::atan2(pos.y, pos.x) * 180. / M_PI;
+  *outAltitude = r - earthRadius;
+}
+
+// Menus ======================================================================
+XPLM_API XPLMMenuID XPLMFindPluginsMenu(void)
+{
+  if(menus.isEmpty())
+  {
+    menus.append(new StubMenu);
+    menus.first()->name = QStringLiteral("Plugins");
+  }
+  return menus.first();
+}
+
+XPLM_API XPLMMenuID XPLMCreateMenu(const char *inName, XPLMMenuID inParentMenu, int inParentItem,
+                                   XPLMMenuHandler_f inHandler, void *inMenuRef)
+{
+  Q_UNUSED(inParentMenu)
+  Q_UNUSED(inParentItem)
+
+  XPLMFindPluginsMenu();
+  StubMenu *menu = new StubMenu;
+  menu->name = QString::fromUtf8(inName);
+  menu->handler = inHandler;
+  menu->menuRef = inMenuRef;
+  menus.append(menu);
+  return menu;
+}
+
+XPLM_API void XPLMDestroyMenu(XPLMMenuID inMenuID)
+{
+  StubMenu *menu = toMenu(inMenuID);
+  if(menu != nullptr)
+    menu->destroyed = true;
+}
+
+XPLM_API int XPLMAppendMenuItem(XPLMMenuID inMenu, const char *inItemName, void *inItemRef, int inDeprecatedAndIgnored)
+{
+  Q_UNUSED(inDeprecatedAndIgnored)
+
+  StubMenu *menu = toMenu(inMenu);
+  if(menu == nullptr)
+    return -1;
+
+  StubMenuItem item;
+  item.name = QString::fromUtf8(inItemName);
+  item.itemRef = inItemRef;
+  menu->items.append(item);
+  return static_cast<int>(menu->items.size()) - 1;
+}
+
+XPLM_API void XPLMAppendMenuSeparator(XPLMMenuID inMenu)
+{
+  // Separator is an item without name to keep indexes in sync
+  XPLMAppendMenuItem(inMenu, "", nullptr, 0);
+}
+
+XPLM_API void XPLMSetMenuItemName(XPLMMenuID inMenu, int inIndex, const char *inItemName, int inDeprecatedAndIgnored)
+{
+  Q_UNUSED(inDeprecatedAndIgnored)
+
+  StubMenuItem *item = toItem(inMenu, inIndex);
+  if(item != nullptr)
+    item->name = QString::fromUtf8(inItemName);
+}
+
+XPLM_API void XPLMCheckMenuItem(XPLMMenuID inMenu, int index, XPLMMenuCheck inCheck)
+{
+  StubMenuItem *item = toItem(inMenu, index);
+  if(item != nullptr)
+    item->check = inCheck;
+}
+
+XPLM_API void XPLMCheckMenuItemState(XPLMMenuID inMenu, int index, XPLMMenuCheck *outCheck)
+{
+  StubMenuItem *item = toItem(inMenu, index);
+  *outCheck = item != nullptr ? item->check : xplm_Menu_NoCheck;
+}
+
+XPLM_API void XPLMEnableMenuItem(XPLMMenuID inMenu, int index, int enabled)
+{
+  StubMenuItem *item = toItem(inMenu, index);
+  if(item != nullptr)
+    item->enabled = enabled;
+}
+
+// Planes ======================================================================
+XPLM_API void XPLMCountAircraft(int *outTotalAircraft, int *outActiveAircraft, XPLMPluginID *outController)
+{
+  *outTotalAircraft = std::max(static_cast<int>(aircraftModels.size()), 1);
+  *outActiveAircraft = std::max(static_cast<int>(aircraftModels.size()), 1);
+  *outController = XPLM_NO_PLUGIN_ID;
+}
+
+XPLM_API void XPLMGetNthAircraftModel(int inIndex, char *outFileName, char *outPath)
+{
+  QString path = inIndex >= 0 && inIndex < aircraftModels.size() ? aircraftModels.at(inIndex) : QString();
+
+  // Buffer sizes as documented in the SDK
+  copyString(outFileName, path.isEmpty() ? QString() : QFileInfo(path).fileName(), 256);
+  copyString(outPath, path, 512);
+}
+
+// Plugin ======================================================================
+XPLM_API XPLMPluginID XPLMGetMyID(void)
+{
+  return PLUGIN_ID;
+}
+
+XPLM_API XPLMPluginID XPLMFindPluginBySignature(const char *inSignature)
+{
+  Q_UNUSED(inSignature)
+
+  // No other plugins like DataRefEditor are loaded
+  return XPLM_NO_PLUGIN_ID;
+}
+
+XPLM_API void XPLMGetPluginInfo(XPLMPluginID inPlugin, char *outName, char *outFilePath, char *outSignature,
+                                char *outDescription)
+{
+  bool own = inPlugin == PLUGIN_ID;
+  copyString(outName, own ? QStringLiteral("Little Xpconnect") : QString(), 256);
+  copyString(outFilePath, own ? pluginPath : QString(), 512);
+  copyString(outSignature, own ? QStringLiteral("ABarthel.LittleXpconnect.Connect") : QString(), 256);
+  copyString(outDescription, QString(), 256);
+}
+
+XPLM_API void XPLMSendMessageToPlugin(XPLMPluginID inPlugin, int inMessage, void *inParam)
+{
+  Q_UNUSED(inPlugin)
+  Q_UNUSED(inMessage)
+  Q_UNUSED(inParam)
+}
+
+// Utilities ======================================================================
+XPLM_API void XPLMDebugString(const char *inString)
+{
+  debugStrings.append(QString::fromUtf8(inString));
+  if(echoDebugStrings)
+    std::fputs(inString, stderr);
+}
+
+} // extern "C"
+
+// ==========================================================================================
+// Control API
+namespace xplmstub {
+
+void reset()
+{
+  internal::resetDataAccess();
+  internal::resetProcessing();
+
+  qDeleteAll(menus);
+  menus.clear();
+  aircraftModels.clear();
+  debugStrings.clear();
+  earthRadius = XPLANE_EARTH_RADIUS_METER;
+  originLat = originLon = originAlt = 0.;
+  localToWorldCount = 0L;
+}
+
+void setAircraftModels(const QStringList& paths)
+{
+  aircraftModels = paths;
+}
+
+void setAircraftModel(int index, const QString& path)
+{
+  while(aircraftModels.size() <= index)
+    aircraftModels.append(QString());
+  aircraftModels[index] = path;
+}
+
+void setPluginPath(const QString& path)
+{
+  pluginPath = path;
+}
+
+void setLocalOrigin(double latDeg, double lonDeg, double altMeter)
+{
+  originLat = latDeg;
+  originLon = lonDeg;
+  originAlt = altMeter;
+  setFloat("sim/flightmodel/position/lat_ref", static_cast<float>(latDeg));
+  setFloat("sim/flightmodel/position/lon_ref", static_cast<float>(lonDeg));
+}
+
+void setEarthRadius(double meter)
+{
+  earthRadius = meter;
+}
+
+quint64 getLocalToWorldCount()
+{
+  return localToWorldCount;
+}
+
+bool clickMenuItem(const char *name)
+{
+  StubMenu *menu = nullptr;
+  StubMenuItem *item = nullptr;
+  if(findItem(name, menu, item) && menu->handler != nullptr)
+  {
+    // Copy ref since handler might change the menu
+    void *itemRef = item->itemRef;
+    menu->handler(menu->menuRef, itemRef);
+    return true;
+  }
+  return false;
+}
+
+XPLMMenuCheck getMenuItemCheck(const char *name)
+{
+  StubMenu *menu = nullptr;
+  StubMenuItem *item = nullptr;
+  return findItem(name, menu, item) ? item->check : xplm_Menu_NoCheck;
+}
+
+void setEchoDebugStrings(bool echo)
+{
+  echoDebugStrings = echo;
+}
+
+const QStringList& getDebugStrings()
+{
+  return debugStrings;
+}
+
+} // namespace xplmstub
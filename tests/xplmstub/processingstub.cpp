@@ -0,0 +1,276 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "xplmstub.h"
+#include "stubinternal.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <ctime>
+
+/*
+ * Flight loop scheduling replacing XPLMProcessing. Loops are only called from xplmstub::runFrames().
+ */
+namespace {
+
+/* Registered or created flight loop. Pointer is used as XPLMFlightLoopID. */
+struct StubFlightLoop
+{
+  XPLMFlightLoop_f callback = nullptr;
+  void *refcon = nullptr;
+
+  /* Registered with the old XPLMRegisterFlightLoopCallback() API */
+  bool legacy = false;
+
+  /* Destroyed while running - deleted after the frame */
+  bool destroyed = false;
+
+  /* Next call either at simulator time or at frame number. Not scheduled if both are negative. */
+  double nextTime = -1.;
+  int nextFrame = -1;
+
+  /* Simulator time of last call or of scheduling if not called yet */
+  double lastTime = 0.;
+};
+
+QList<StubFlightLoop *> loops;
+QList<xplmstub::FlightLoopStats> stats;
+QList<qint64> frameCpuNs;
+std::function<void(double simTimeSec, int frame)> frameHook;
+
+double elapsedTime = 0.;
+int frameCount = 0;
+
+/* Set next call time from an interval as used by the API. Positive is seconds, negative is frames and zero stops. */
+void schedule(StubFlightLoop *loop, float interval, bool relativeToNow)
+{
+  loop->nextTime = -1.;
+  loop->nextFrame = -1;
+
+  if(interval > 0.f)
+    loop->nextTime = (relativeToNow ? elapsedTime : loop->lastTime) + static_cast<double>(interval);
+  else if(interval < 0.f)
+    loop->nextFrame = frameCount + static_cast<int>(-interval);
+}
+
+StubFlightLoop *findLegacy(XPLMFlightLoop_f callback, void *refcon)
+{
+  for(StubFlightLoop *loop : std::as_const(loops))
+  {
+    if(loop->legacy && !loop->destroyed && loop->callback == callback && loop->refcon == refcon)
+      return loop;
+  }
+  return nullptr;
+}
+
+xplmstub::FlightLoopStats& statsFor(XPLMFlightLoop_f callback)
+{
+  for(xplmstub::FlightLoopStats& s : stats)
+  {
+    if(s.callback == callback)
+      return s;
+  }
+  stats.append(xplmstub::FlightLoopStats());
+  stats.last().callback = callback;
+  return stats.last();
+}
+
+/* CPU time used by the calling thread */
+qint64 threadCpuNs()
+{
+#if defined(Q_OS_UNIX)
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<qint64>(time.tv_sec) * 1000000000L + time.tv_nsec;
+#else
+  return 0L;
+#endif
+}
+
+/* Call loop if due and reschedule it from the return value. Returns thread CPU time used. */
+qint64 callIfDue(StubFlightLoop *loop, double frameSeconds)
+{
+  bool due = (loop->nextTime >= 0. && elapsedTime >= loop->nextTime - 1.e-9) ||
+             (loop->nextFrame >= 0 && frameCount >= loop->nextFrame);
+  if(!due || loop->destroyed)
+    return 0L;
+
+  float sinceLastCall = static_cast<float>(elapsedTime - loop->lastTime);
+  loop->lastTime = elapsedTime;
+
+  QElapsedTimer timer;
+  timer.start();
+  qint64 cpuStart = threadCpuNs();
+
+  float interval = loop->callback(sinceLastCall, static_cast<float>(frameSeconds), frameCount, loop->refcon);
+
+  qint64 cpuNs = threadCpuNs() - cpuStart;
+  qint64 wallNs = timer.nsecsElapsed();
+
+  xplmstub::FlightLoopStats& s = statsFor(loop->callback);
+  s.calls++;
+  s.totalNs += wallNs;
+  s.maxNs = std::max(s.maxNs, wallNs);
+  s.totalCpuNs += cpuNs;
+  s.durationsNs.append(wallNs);
+
+  // Return value replaces any scheduling done in the callback
+  if(!loop->destroyed)
+    schedule(loop, interval, true /* relativeToNow */);
+  return cpuNs;
+}
+
+} // namespace
+
+// ==========================================================================================
+// XPLMProcessing API
+extern "C" {
+
+XPLM_API void XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, float inInterval, void *inRefcon)
+{
+  StubFlightLoop *loop = new StubFlightLoop;
+  loop->callback = inFlightLoop;
+  loop->refcon = inRefcon;
+  loop->legacy = true;
+  loop->lastTime = elapsedTime;
+  schedule(loop, inInterval, true);
+  loops.append(loop);
+}
+
+XPLM_API void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, void *inRefcon)
+{
+  StubFlightLoop *loop = findLegacy(inFlightLoop, inRefcon);
+  if(loop != nullptr)
+    loop->destroyed = true;
+}
+
+XPLM_API void XPLMSetFlightLoopCallbackInterval(XPLMFlightLoop_f inFlightLoop, float inInterval, int inRelativeToNow,
+                                                void *inRefcon)
+{
+  StubFlightLoop *loop = findLegacy(inFlightLoop, inRefcon);
+  if(loop != nullptr)
+    schedule(loop, inInterval, inRelativeToNow);
+}
+
+XPLM_API XPLMFlightLoopID XPLMCreateFlightLoop(XPLMCreateFlightLoop_t *inParams)
+{
+  // Created loops are not scheduled until XPLMScheduleFlightLoop() is called
+  StubFlightLoop *loop = new StubFlightLoop;
+  loop->callback = inParams->callbackFunc;
+  loop->refcon = inParams->refcon;
+  loop->lastTime = elapsedTime;
+  loops.append(loop);
+  return loop;
+}
+
+XPLM_API void XPLMDestroyFlightLoop(XPLMFlightLoopID inFlightLoopID)
+{
+  if(inFlightLoopID != nullptr)
+    static_cast<StubFlightLoop *>(inFlightLoopID)->destroyed = true;
+}
+
+XPLM_API void XPLMScheduleFlightLoop(XPLMFlightLoopID inFlightLoopID, float inInterval, int inRelativeToNow)
+{
+  if(inFlightLoopID != nullptr)
+    schedule(static_cast<StubFlightLoop *>(inFlightLoopID), inInterval, inRelativeToNow);
+}
+
+} // extern "C"
+
+// ==========================================================================================
+// Control API
+namespace xplmstub {
+
+void internal::resetProcessing()
+{
+  qDeleteAll(loops);
+  loops.clear();
+  stats.clear();
+  frameCpuNs.clear();
+  frameHook = nullptr;
+  elapsedTime = 0.;
+  frameCount = 0;
+}
+
+void setFrameHook(const std::function<void(double simTimeSec, int frame)>& hook)
+{
+  frameHook = hook;
+}
+
+void runFrames(int numFrames, double frameSeconds, bool realtime)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  for(int i = 0; i < numFrames; i++)
+  {
+    frameCount++;
+    elapsedTime += frameSeconds;
+
+    if(frameHook)
+      frameHook(elapsedTime, frameCount);
+
+    // Loops created in a callback are called in the next frame
+    qint64 cpuNs = 0L;
+    qsizetype numLoops = loops.size();
+    for(qsizetype j = 0; j < numLoops; j++)
+      cpuNs += callIfDue(loops.at(j), frameSeconds);
+    frameCpuNs.append(cpuNs);
+
+    // Delete loops which were destroyed during the frame
+    for(auto it = loops.begin(); it != loops.end();)
+    {
+      if((*it)->destroyed)
+      {
+        delete *it;
+        it = loops.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    if(realtime)
+    {
+      qint64 sleepNs = static_cast<qint64>((i + 1) * frameSeconds * 1.e9) - timer.nsecsElapsed();
+      if(sleepNs > 0)
+        QThread::usleep(static_cast<unsigned long>(sleepNs / 1000L));
+    }
+  }
+}
+
+double getElapsedTime()
+{
+  return elapsedTime;
+}
+
+int getFrameCount()
+{
+  return frameCount;
+}
+
+QList<FlightLoopStats> getFlightLoopStats()
+{
+  return stats;
+}
+
+const QList<qint64>& getFrameCpuNs()
+{
+  return frameCpuNs;
+}
+
+} // namespace xplmstub
@@ -0,0 +1,36 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_STUBINTERNAL_H
+#define LITTLEXPC_STUBINTERNAL_H
+
+/*
+ * Functions shared between the translation units of the XPLM stub. Not to be used by tests.
+ */
+namespace xplmstub {
+namespace internal {
+
+/* Remove all datarefs and accessors */
+void resetDataAccess();
+
+/* Remove all flight loops and reset time and statistics */
+void resetProcessing();
+
+} // namespace internal
+} // namespace xplmstub
+
+#endif // LITTLEXPC_STUBINTERNAL_H
@@ -0,0 +1,146 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLEXPC_XPLMSTUB_H
+#define LITTLEXPC_XPLMSTUB_H
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+
+#include <functional>
+#include <span>
+
+extern "C" {
+#include "XPLMDataAccess.h"
+#include "XPLMMenus.h"
+#include "XPLMProcessing.h"
+}
+
+/*
+ * Replaces the XPLM library of the X-Plane SDK for tests, benchmarks and the plugin harness.
+ *
+ * Implements all XPLM functions used by the plugin. Datarefs are kept in an in-memory store and can be
+ * changed at any time with the functions below. Reading a dataref with another type than it was defined with
+ * converts the value like X-Plane does for datarefs having more than one type.
+ *
+ * Flight loops are only called from runFrames(). Simulator time is advanced by a fixed interval per frame
+ * and the frame hook is called before the flight loops of each frame to update the dataref values.
+ *
+ * Local OpenGL coordinates use a tangent plane on a spherical earth with radius setEarthRadius() at the
+ * origin given by setLocalOrigin().
+ *
+ * Not thread safe. Call all functions in the thread calling the plugin.
+ */
+namespace xplmstub {
+
+/* Radius of the earth for local coordinates as used by X-Plane */
+static const double XPLANE_EARTH_RADIUS_METER = 6378145.;
+
+/* Remove all datarefs, flight loops, menus and aircraft and reset time and statistics.
+ * Pointers returned by XPLM functions before are invalid afterwards. */
+void reset();
+
+/* Datarefs ================================================================================ */
+/* Create a dataref with the given type flags if not existing and set its value. Types of existing refs are kept. */
+void setInt(const char *name, int value, XPLMDataTypeID types = xplmType_Int);
+void setFloat(const char *name, float value, XPLMDataTypeID types = xplmType_Float);
+void setDouble(const char *name, double value, XPLMDataTypeID types = xplmType_Double | xplmType_Float);
+void setIntArray(const char *name, std::span<const int> values);
+void setFloatArray(const char *name, std::span<const float> values);
+void setBytes(const char *name, QByteArrayView bytes);
+
+/* Change a single element of an existing array. Ignored if index is out of range. */
+void setIntArray(const char *name, int index, int value);
+void setFloatArray(const char *name, int index, float value);
+
+/* Create a dataref with default value zero or empty array. Does nothing if already defined. */
+void define(const char *name, XPLMDataTypeID types, int arraySize = 0);
+
+/* Remove a dataref from the store. Found refs become invalid and return zero. */
+void undefine(const char *name);
+
+bool isDefined(const char *name);
+
+/* Names of all defined datarefs including registered accessors */
+QList<QByteArray> getNames();
+
+/* Number of XPLMGetData* calls and bytes copied by array calls since reset */
+quint64 getReadCount();
+quint64 getReadBytes();
+
+/* Flight loops ============================================================================= */
+/* Statistics of one flight loop callback */
+struct FlightLoopStats
+{
+  XPLMFlightLoop_f callback = nullptr;
+  quint64 calls = 0L;
+  qint64 totalNs = 0L, maxNs = 0L, totalCpuNs = 0L;
+
+  /* Wall time of each call */
+  QList<qint64> durationsNs;
+};
+
+/* Called at the start of each frame with simulator time and frame number before the flight loops */
+void setFrameHook(const std::function<void(double simTimeSec, int frame)>& hook);
+
+/* Run the given number of frames. Each frame advances simulator time by frameSeconds.
+ * Sleeps to keep the frame rate in real time if realtime is true. */
+void runFrames(int numFrames, double frameSeconds, bool realtime = false);
+
+/* Elapsed simulator time and frame counter as passed to the flight loops */
+double getElapsedTime();
+int getFrameCount();
+
+/* Statistics for all flight loops which were called at least once */
+QList<FlightLoopStats> getFlightLoopStats();
+
+/* Sum of thread CPU time of all callbacks per frame */
+const QList<qint64>& getFrameCpuNs();
+
+/* Aircraft, plugins and graphics ========================================================== */
+/* Full path of .acf files. Index 0 is the user aircraft. Number of active aircraft is the size of the list. */
+void setAircraftModels(const QStringList& paths);
+void setAircraftModel(int index, const QString& path);
+
+/* Path returned by XPLMGetPluginInfo() for the plugin itself */
+void setPluginPath(const QString& path);
+
+/* Local coordinate origin at the given position. Also updates the lat_ref and lon_ref datarefs. */
+void setLocalOrigin(double latDeg, double lonDeg, double altMeter = 0.);
+void setEarthRadius(double meter);
+
+/* Number of calls of XPLMLocalToWorld() and XPLMWorldToLocal() since reset */
+quint64 getLocalToWorldCount();
+
+/* Menus ===================================================================================== */
+/* Calls the menu handler for the first item with the given name. Returns false if not found. */
+bool clickMenuItem(const char *name);
+
+/* Check state of the first item with the given name or xplm_Menu_NoCheck if not found */
+XPLMMenuCheck getMenuItemCheck(const char *name);
+
+/* Utilities ================================================================================== */
+/* Print strings passed to XPLMDebugString() to stderr. Default is false. */
+void setEchoDebugStrings(bool echo);
+
+/* All strings passed to XPLMDebugString() since reset */
+const QStringList& getDebugStrings();
+
+} // namespace xplmstub
+
+#endif // LITTLEXPC_XPLMSTUB_H